@@ -0,0 +1,321 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "alloc.h"
+#include "io.h"
+#include "section.h"
+#include "taco.h"
+#include "tja.tab.h"
+#include "tja/parser.h"
+#include "tja/postproc.h"
+
+#include "gen.h"
+#include "getopt.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+extern int tja_yylex_init(yyscan_t *scanner);
+extern int tja_yylex_destroy(yyscan_t scanner);
+extern void tja_yyset_extra(void *data, yyscan_t scanner);
+
+#define CHART_PATH "bench.tja"
+
+static const struct option options[] = {
+    {"help", no_argument, NULL, 'h'},
+    {"iterations", required_argument, NULL, 'n'},
+    {"measures", required_argument, NULL, 'm'},
+    {"density", required_argument, NULL, 'd'},
+    {"branches", required_argument, NULL, 'b'},
+    {"bpm-changes", required_argument, NULL, 't'},
+    {"shift-jis", no_argument, NULL, 's'},
+    {NULL, 0, NULL, 0},
+};
+
+static taco_alloc_stats *stats;
+static taco_allocator *counting_allocator;
+
+typedef struct result_ result;
+
+// Accumulated cost of a benchmarked operation.
+struct result_ {
+  const char *name;
+  uint64_t ns;
+  uint64_t events;
+  uint64_t allocations;
+};
+
+#define MAX_RESULTS 16
+static result results[MAX_RESULTS];
+static size_t result_count = 0;
+
+static result *get_result(const char *name) {
+  for (size_t i = 0; i < result_count; ++i) {
+    if (strcmp(results[i].name, name) == 0)
+      return &results[i];
+  }
+  if (result_count == MAX_RESULTS)
+    abort();
+  results[result_count].name = name;
+  return &results[result_count++];
+}
+
+static uint64_t now(void) {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Times passes as the parser runs them.
+static int time_pass(void *data, const tja_pass *pass, tja_parser *parser,
+                     void *target) {
+  size_t events = 0;
+  if (pass->branch) {
+    events = taco_section_size(target);
+  } else {
+    for (int b = TACO_BRANCH_NORMAL; b <= TACO_BRANCH_MASTER; ++b)
+      events +=
+          taco_section_size(taco_course_get_branch(target, TACO_SIDE_LEFT, b));
+  }
+
+  result *r = get_result(pass->name);
+  size_t a = taco_alloc_stats_count(stats);
+  uint64_t start = now();
+  int err = tja_pass_run_(pass, parser, target);
+  r->ns += now() - start;
+  r->allocations += taco_alloc_stats_count(stats) - a;
+  r->events += events;
+  return err;
+}
+
+static size_t count_events(const taco_courseset *set) {
+  size_t events = 0;
+  for (int c = 0; c <= TACO_CLASS_EX; ++c) {
+    const taco_course *course = taco_courseset_get_course(set, c);
+    if (!course)
+      continue;
+    for (int b = TACO_BRANCH_NORMAL; b <= TACO_BRANCH_MASTER; ++b)
+      events += taco_section_size(
+          taco_course_get_branch(course, TACO_SIDE_LEFT, b));
+  }
+  return events;
+}
+
+static int bench_lex(tja_parser *parser, int iterations) {
+  result *r = get_result("lex");
+
+  for (int n = 0; n < iterations; ++n) {
+    taco_file *file = taco_file_open_path_(CHART_PATH, "rb");
+    yyscan_t lexer = NULL;
+    if (!file || tja_yylex_init(&lexer) != 0) {
+      taco_file_close_(file);
+      return -1;
+    }
+    tja_yyset_extra(parser, lexer);
+    parser->input = file;
+
+    size_t a = taco_alloc_stats_count(stats);
+    uint64_t start = now();
+    TJA_YYSTYPE value;
+    TJA_YYLTYPE location;
+    int token;
+    while ((token = tja_yylex(&value, &location, lexer)) > 0) {
+      if (token == TEXT || token == IDENTIFIER || token == HEADER ||
+          token == COMMAND)
+        taco_free_(counting_allocator, value.text);
+      ++r->events;
+    }
+    r->ns += now() - start;
+    r->allocations += taco_alloc_stats_count(stats) - a;
+
+    parser->input = NULL;
+    tja_yylex_destroy(lexer);
+    taco_file_close_(file);
+  }
+
+  return 0;
+}
+
+static int bench_parse(int iterations) {
+  taco_parser *parser = taco_parser_tja_create2(counting_allocator);
+  if (!parser)
+    return -1;
+  result *r = get_result("parse");
+
+  for (int n = 0; n < iterations; ++n) {
+    size_t a = taco_alloc_stats_count(stats);
+    uint64_t start = now();
+    taco_courseset *set = taco_parser_parse_file(parser, CHART_PATH);
+    r->ns += now() - start;
+    r->allocations += taco_alloc_stats_count(stats) - a;
+    if (!set) {
+      taco_parser_free(parser);
+      return -1;
+    }
+    r->events += count_events(set);
+    taco_courseset_free(set);
+  }
+
+  taco_parser_free(parser);
+  return 0;
+}
+
+static int bench_passes(tja_parser *parser, int iterations) {
+  tja_parser_set_pass_hook_(parser, time_pass, NULL);
+
+  for (int n = 0; n < iterations; ++n) {
+    taco_file *file = taco_file_open_path_(CHART_PATH, "rb");
+    taco_courseset *set = tja_parser_parse_(parser, file);
+    taco_file_close_(file);
+    if (!set)
+      return -1;
+    taco_courseset_free(set);
+  }
+
+  tja_parser_set_pass_hook_(parser, NULL, NULL);
+  return 0;
+}
+
+// Times timing queries on a parsed course.
+static int bench_seconds(int iterations) {
+  taco_parser *parser = taco_parser_tja_create2(counting_allocator);
+  taco_courseset *set = taco_parser_parse_file(parser, CHART_PATH);
+  taco_parser_free(parser);
+  if (!set)
+    return -1;
+
+  const taco_course *course = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  taco_section *branch = taco_section_clone_(
+      taco_course_get_branch(course, TACO_SIDE_LEFT, TACO_BRANCH_MASTER));
+  taco_courseset_free(set);
+  if (!branch)
+    return -1;
+
+  result *cache = get_result("cache_seconds");
+  result *query = get_result("event_seconds");
+  volatile double sink = 0;
+
+  for (int n = 0; n < iterations; ++n) {
+    size_t a = taco_alloc_stats_count(stats);
+    uint64_t start = now();
+    int err = taco_section_cache_seconds_(branch);
+    cache->ns += now() - start;
+    cache->allocations += taco_alloc_stats_count(stats) - a;
+    cache->events += taco_section_size(branch);
+    if (err) {
+      taco_section_free_(branch);
+      return -1;
+    }
+
+    a = taco_alloc_stats_count(stats);
+    start = now();
+    taco_section_foreach(i, branch) {
+      sink += taco_event_seconds(i, branch);
+    }
+    query->ns += now() - start;
+    query->allocations += taco_alloc_stats_count(stats) - a;
+    query->events += taco_section_size(branch);
+  }
+
+  taco_section_free_(branch);
+  return 0;
+}
+
+static void report(void) {
+  printf("%-20s %14s %12s %14s\n", "benchmark", "events", "ns/event",
+         "allocs/event");
+  for (size_t i = 0; i < result_count; ++i) {
+    const result *r = &results[i];
+    double events = r->events ? (double)r->events : 1.0;
+    printf("%-20s %14llu %12.2f %14.4f\n", r->name,
+           (unsigned long long)r->events, r->ns / events,
+           r->allocations / events);
+  }
+  printf("peak memory: %zu bytes\n", taco_alloc_stats_peak_bytes(stats));
+}
+
+static void help(const char *arg0);
+
+int main(int argc, char **argv) {
+  int opt;
+  int iterations = 20;
+  gen_options gen;
+  gen_default_options(&gen);
+
+  while ((opt = getopt_long(argc, argv, "hn:m:d:b:t:s", options, NULL)) !=
+         -1) {
+    switch (opt) {
+    case 'h':
+      help(argv[0]);
+      exit(0);
+    case 'n':
+      iterations = atoi(optarg);
+      break;
+    case 'm':
+      gen.measures = atoi(optarg);
+      break;
+    case 'd':
+      gen.density = atoi(optarg);
+      break;
+    case 'b':
+      gen.branches = atoi(optarg);
+      break;
+    case 't':
+      gen.bpm_changes = atoi(optarg);
+      break;
+    case 's':
+      gen.shiftjis = true;
+      break;
+    case '?':
+    default:
+      exit(1);
+    }
+  }
+
+  FILE *chart = fopen(CHART_PATH, "wb");
+  if (!chart || gen_tja(chart, &gen) < 0) {
+    fprintf(stderr, "%s: cannot write %s\n", argv[0], CHART_PATH);
+    exit(1);
+  }
+  fclose(chart);
+
+  stats = taco_alloc_stats_create(NULL);
+  if (!stats)
+    exit(1);
+  counting_allocator = taco_alloc_stats_allocator(stats);
+
+  tja_parser *parser = tja_parser_create2_(counting_allocator);
+  if (!parser)
+    exit(1);
+
+  int err = bench_lex(parser, iterations);
+  err = err || bench_passes(parser, iterations);
+  err = err || bench_seconds(iterations);
+  err = err || bench_parse(iterations);
+  tja_parser_free_(parser);
+  remove(CHART_PATH);
+
+  if (err) {
+    fprintf(stderr, "%s: benchmark failed\n", argv[0]);
+    exit(1);
+  }
+
+  report();
+  taco_alloc_stats_free(stats);
+  exit(0);
+}
+
+static void help(const char *arg0) {
+  printf("Usage: %s [options]\n"
+         "Time the TJA parser on a synthetic chart.\n"
+         "\n"
+         "Options:\n"
+         "  -n, --iterations=N   repeat each benchmark N times\n"
+         "  -m, --measures=N     measures in the chart\n"
+         "  -d, --density=N      notes per measure\n"
+         "  -b, --branches=N     number of branch points\n"
+         "  -t, --bpm-changes=N  number of tempo changes\n"
+         "  -s, --shift-jis      write text in Shift JIS\n"
+         "  -h, --help           print this help\n",
+         arg0);
+}
@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "gen.h"
+
+#include <stdint.h>
+
+// "テスト曲" and "作譜者"
+static const char title_utf8[] =
+    "\xe3\x83\x86\xe3\x82\xb9\xe3\x83\x88\xe6\x9b\xb2";
+static const char title_sjis[] = "\x83\x65\x83\x58\x83\x67\x8b\xc8";
+static const char maker_utf8[] = "\xe4\xbd\x9c\xe8\xad\x9c\xe8\x80\x85";
+static const char maker_sjis[] = "\x8d\xec\x95\x88\x8e\xd2";
+
+void gen_default_options(gen_options *opts) {
+  opts->measures = 512;
+  opts->density = 16;
+  opts->branches = 4;
+  opts->bpm_changes = 8;
+  opts->shiftjis = false;
+  opts->seed = 1;
+}
+
+// xorshift; stable across platforms unlike rand()
+static uint32_t next(uint32_t *state) {
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return *state = x;
+}
+
+// Writes a measure of notes; returns the number of notes.
+static long measure(FILE *out, uint32_t *rng, int density) {
+  static const char notes[] = "1212121234";
+  long count = 0;
+
+  for (int i = 0; i < density; ++i) {
+    char note = '0';
+    if (next(rng) % 4 != 0) {
+      note = notes[next(rng) % (sizeof(notes) - 1)];
+      ++count;
+    }
+    fputc(note, out);
+  }
+  fputs(",\n", out);
+  return count;
+}
+
+long gen_tja(FILE *out, const gen_options *opts) {
+  uint32_t rng = opts->seed ? opts->seed : 1;
+  long count = 0;
+  int density = opts->density > 0 ? opts->density : 1;
+
+  fprintf(out, "TITLE:%s\n", opts->shiftjis ? title_sjis : title_utf8);
+  fprintf(out, "MAKER:%s\n", opts->shiftjis ? maker_sjis : maker_utf8);
+  fputs("BPM:150\nWAVE:bench.ogg\nOFFSET:-1.5\n\n"
+        "COURSE:Oni\nLEVEL:10\n\n#START\n",
+        out);
+
+  // spread branch points and tempo changes evenly
+  int branch_every = opts->branches > 0 ? opts->measures / opts->branches : 0;
+  int bpm_every =
+      opts->bpm_changes > 0 ? opts->measures / opts->bpm_changes : 0;
+
+  for (int m = 0; m < opts->measures; ++m) {
+    if (bpm_every && m % bpm_every == bpm_every / 2)
+      fprintf(out, "#BPMCHANGE %d\n", 120 + (int)(next(&rng) % 120));
+
+    if (branch_every && m % branch_every == 0 && m > 0) {
+      // branch for a single measure
+      fputs("#BRANCHSTART p,50,80\n", out);
+      for (int b = 0; b < 3; ++b) {
+        fprintf(out, "#%c\n", "NEM"[b]);
+        count += measure(out, &rng, density);
+      }
+      fputs("#BRANCHEND\n", out);
+      continue;
+    }
+
+    count += measure(out, &rng, density);
+  }
+
+  fputs("#END\n", out);
+  return ferror(out) ? -1 : count;
+}
@@ -0,0 +1,24 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+#ifndef BENCH_GEN_H_
+#define BENCH_GEN_H_
+
+#include <stdbool.h>
+#include <stdio.h>
+
+typedef struct gen_options_ gen_options;
+
+// Shape of a synthetic chart.
+struct gen_options_ {
+  int measures;   // measures per branch
+  int density;    // notes per measure
+  int branches;   // number of branch points
+  int bpm_changes;
+  bool shiftjis;  // write text in Shift JIS instead of UTF-8
+  unsigned seed;
+};
+
+extern void gen_default_options(gen_options *opts);
+// Writes a chart; returns the number of notes written, or -1 on error.
+extern long gen_tja(FILE *out, const gen_options *opts);
+
+#endif /* !BENCH_GEN_H_ */
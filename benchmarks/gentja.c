@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "gen.h"
+#include "getopt.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static const struct option options[] = {
+    {"help", no_argument, NULL, 'h'},
+    {"output", required_argument, NULL, 'o'},
+    {"measures", required_argument, NULL, 'm'},
+    {"density", required_argument, NULL, 'd'},
+    {"branches", required_argument, NULL, 'b'},
+    {"bpm-changes", required_argument, NULL, 't'},
+    {"shift-jis", no_argument, NULL, 's'},
+    {"seed", required_argument, NULL, 'S'},
+    {NULL, 0, NULL, 0},
+};
+
+static void help(const char *arg0);
+
+int main(int argc, char **argv) {
+  int opt;
+  FILE *output = stdout;
+  gen_options gen;
+  gen_default_options(&gen);
+
+  while ((opt = getopt_long(argc, argv, "ho:m:d:b:t:sS:", options, NULL)) !=
+         -1) {
+    switch (opt) {
+    case 'h':
+      help(argv[0]);
+      exit(0);
+    case 'o':
+      output = fopen(optarg, "wb");
+      if (!output) {
+        fprintf(stderr, "%s: cannot open %s\n", argv[0], optarg);
+        exit(1);
+      }
+      break;
+    case 'm':
+      gen.measures = atoi(optarg);
+      break;
+    case 'd':
+      gen.density = atoi(optarg);
+      break;
+    case 'b':
+      gen.branches = atoi(optarg);
+      break;
+    case 't':
+      gen.bpm_changes = atoi(optarg);
+      break;
+    case 's':
+      gen.shiftjis = true;
+      break;
+    case 'S':
+      gen.seed = strtoul(optarg, NULL, 10);
+      break;
+    case '?':
+    default:
+      exit(1);
+    }
+  }
+
+  long notes = gen_tja(output, &gen);
+  if (output != stdout)
+    fclose(output);
+  exit(notes < 0);
+}
+
+static void help(const char *arg0) {
+  printf("Usage: %s [options]\n"
+         "Write a synthetic TJA chart.\n"
+         "\n"
+         "Options:\n"
+         "  -o, --output=FILE    write to FILE instead of standard output\n"
+         "  -m, --measures=N     measures in the chart\n"
+         "  -d, --density=N      notes per measure\n"
+         "  -b, --branches=N     number of branch points\n"
+         "  -t, --bpm-changes=N  number of tempo changes\n"
+         "  -s, --shift-jis      write text in Shift JIS\n"
+         "  -S, --seed=N         seed for note placement\n"
+         "  -h, --help           print this help\n",
+         arg0);
+}
@@ -16,6 +16,14 @@ extern void *taco_default_realloc_(void *ptr, size_t size, void *null);
 #define taco_free_(a, ptr) ((a)->free((ptr), (a)->heap))
 #define taco_realloc_(a, ptr, size) ((a)->realloc((ptr), (size), (a)->heap))
 
+// Attributes the next allocation to a site, if the allocator counts them.
+extern void taco_alloc_tag_(taco_allocator *a, int site);
+
+#define taco_malloc_at_(a, size, site)                                         \
+  (taco_alloc_tag_((a), (site)), taco_malloc_((a), (size)))
+#define taco_realloc_at_(a, ptr, size, site)                                   \
+  (taco_alloc_tag_((a), (site)), taco_realloc_((a), (ptr), (size)))
+
 extern char *taco_strdup_(taco_allocator *a, const char *str);
 extern char *taco_strndup_(taco_allocator *a, const char *str, size_t maxlen);
 
@@ -0,0 +1,15 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+#ifndef TACO_ARCHIVE_H_
+#define TACO_ARCHIVE_H_
+
+#include "io.h"
+#include "taco.h"
+
+// Opens an entry for reading, decompressing it as it is read. Entries share
+// the archive file, so only one may be open at a time, and an archive is
+// not to be read from several threads. Entries failing to decompress or to
+// match the directory report an error through taco_file_error_.
+extern taco_file *taco_archive_open_entry_(taco_archive *archive,
+                                           size_t index);
+
+#endif /* !TACO_ARCHIVE_H_ */
@@ -0,0 +1,10 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+#ifndef TACO_CLOCK_H_
+#define TACO_CLOCK_H_
+
+#include <stdint.h>
+
+// Gets a monotonic time in nanoseconds, from an arbitrary start.
+extern uint64_t taco_clock_ns_(void);
+
+#endif /* !TACO_CLOCK_H_ */
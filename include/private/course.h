@@ -7,6 +7,9 @@
 TACO_MALLOC extern taco_course *taco_course_create_();
 TACO_MALLOC extern taco_course *taco_course_create2_(taco_allocator *alloc);
 extern void taco_course_free_(taco_course *restrict course);
+// Gets the allocator a course was created with.
+extern taco_allocator *
+taco_course_allocator_(const taco_course *restrict course);
 
 extern int taco_course_set_maker_(taco_course *restrict course,
                                   const char *maker);
@@ -15,6 +18,11 @@ extern void taco_course_set_level_(taco_course *restrict course, double level);
 extern void taco_course_set_style_(taco_course *restrict course, int style);
 extern void taco_course_set_papamama_(taco_course *restrict course,
                                       int papamama);
+extern void taco_course_set_scrollmode_(taco_course *restrict course,
+                                        int scrollmode);
+// Builds the caches of every branch, scroll curves being under the scroll
+// mode. Done once events are final, as changing them makes caches stale.
+extern int taco_course_cache_(taco_course *restrict course);
 extern void taco_course_set_bpm_(taco_course *restrict course, double bpm);
 extern void taco_course_set_offset_(taco_course *restrict course,
                                     double offset);
@@ -22,6 +22,8 @@ extern int taco_courseset_set_filename_(taco_courseset *restrict set,
 extern int taco_courseset_set_audio_(taco_courseset *restrict set,
                                      const char *restrict path);
 
+extern void taco_courseset_set_encoding_(taco_courseset *restrict set,
+                                         int encoding);
 extern void taco_courseset_set_demo_time_(taco_courseset *restrict set,
                                           double time);
 
@@ -0,0 +1,36 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+#ifndef TACO_DIAGNOSTIC_H_
+#define TACO_DIAGNOSTIC_H_
+
+#include "taco.h"
+#include <stdarg.h>
+#include <stdint.h>
+
+#define TACO_DIAG_ARGS_MAX 2
+
+typedef union taco_diagnostic_arg_ taco_diagnostic_arg;
+
+union taco_diagnostic_arg_ {
+  int i;
+  const char *s;
+};
+
+struct taco_diagnostic_ {
+  int code;
+  int severity;
+  const char *file;
+  int line;
+  int column;      // 0 if unknown
+  uint64_t offset; // valid with the column
+  int arg_count;
+  taco_diagnostic_arg args[TACO_DIAG_ARGS_MAX];
+};
+
+// Gets the severity of diagnostics with a code.
+extern int taco_diagnostic_severity_of_(int code);
+// Fills in a diagnostic, taking the arguments its message has. Strings are
+// borrowed, and must outlive the diagnostic.
+extern void taco_diagnostic_init_(taco_diagnostic *restrict diag, int code,
+                                  const char *file, int line, va_list ap);
+
+#endif /* !TACO_DIAGNOSTIC_H_ */
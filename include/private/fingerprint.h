@@ -0,0 +1,14 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+#ifndef TACO_FINGERPRINT_H_
+#define TACO_FINGERPRINT_H_
+
+#include "taco.h"
+#include <stdint.h>
+
+// Hashes the notes of a section and sketches its rhythms. Needs the timing
+// cache.
+extern void taco_fingerprint_compute_(const taco_section *restrict s,
+                                      uint64_t *restrict fingerprint,
+                                      taco_sketch *restrict sketch);
+
+#endif /* !TACO_FINGERPRINT_H_ */
@@ -0,0 +1,57 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+#ifndef TACO_INFLATE_H_
+#define TACO_INFLATE_H_
+
+#include "io.h"
+#include "taco.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct taco_huffman_ taco_huffman;
+typedef struct taco_inflate_ taco_inflate;
+
+// Canonical Huffman code, as counts of codes per length and symbols in
+// code order. Codes of up to 9 bits are also looked up by their next 9 bits
+// of input, with the length and symbol packed as length << 9 | symbol.
+struct taco_huffman_ {
+  short count[16];
+  short symbol[288];
+  uint16_t fast[512];
+};
+
+// Raw DEFLATE (RFC 1951) decompressor, reading a bounded amount of input
+// from a file and producing output as asked for.
+struct taco_inflate_ {
+  taco_file *file;
+  uint64_t remaining; // compressed bytes not yet read from the file
+  unsigned char input[4096];
+  size_t input_head;
+  size_t input_size;
+
+  uint32_t bits;
+  int bit_count;
+  int state;
+  bool last;  // in the last block
+  bool error; // corrupt or truncated input
+
+  uint32_t stored; // bytes left in a stored block
+  int length;      // bytes left of a match
+  int distance;
+  taco_huffman lengths;
+  taco_huffman distances;
+
+  uint64_t total; // bytes produced
+  unsigned char window[32768];
+};
+
+extern void taco_inflate_init_(taco_inflate *restrict s, taco_file *file,
+                               uint64_t size);
+// Produces up to count bytes. Returns fewer only at the end of the stream
+// or on an error, which sets s->error; bytes decoded before an error are
+// still returned.
+extern size_t taco_inflate_read_(taco_inflate *restrict s, char *dst,
+                                 size_t count);
+// Checks if all output of the stream has been produced.
+extern bool taco_inflate_done_(const taco_inflate *restrict s);
+
+#endif /* !TACO_INFLATE_H_ */
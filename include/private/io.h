@@ -5,6 +5,7 @@
 #include "taco.h"
 
 #include <stdarg.h>
+#include <stdbool.h>
 #include <stdio.h>
 
 typedef struct taco_file_ taco_file;
@@ -20,12 +21,25 @@ extern void taco_file_close_(taco_file *file);
 extern const char *taco_file_name_(const taco_file *file);
 extern void taco_file_set_name_(taco_file *file, const char *filename);
 
+// Reads are buffered; the stream is read a block at a time, 64 KiB unless
+// set otherwise.
+extern void taco_file_set_block_size_(taco_file *file, size_t size);
+// Returns buffered input, reading at least want bytes unless the stream
+// ends first. The buffer stays valid until the next operation on the file.
+extern const char *taco_file_peek_(taco_file *file, size_t want,
+                                   size_t *size);
+// Marks input returned by taco_file_peek_ as read.
+extern void taco_file_consume_(taco_file *file, size_t size);
+// Clears the end of file, for streams that have since grown.
+extern void taco_file_resume_(taco_file *file);
 extern size_t taco_file_read_(taco_file *file, void *dst, size_t size);
 extern size_t taco_file_write_(taco_file *file, const void *src, size_t size);
 TACO_PRINTF(2, 3)
 extern int taco_file_printf_(taco_file *file, const char *format, ...);
 TACO_PRINTF(2, 0)
 extern int taco_file_vprintf_(taco_file *file, const char *format, va_list arg);
+// Tells whether reading failed, rather than reached the end.
+extern bool taco_file_error_(const taco_file *file);
 extern int taco_file_seek_(taco_file *file, uint64_t offset, int whence);
 
 extern taco_file *taco_get_stderr_();
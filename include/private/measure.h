@@ -0,0 +1,21 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+#ifndef TACO_MEASURE_H_
+#define TACO_MEASURE_H_
+
+#include "taco.h"
+#include <stddef.h>
+
+struct taco_measure_ {
+  int ticks;
+  int length;
+  float bpm;
+  float scroll_x;
+  float scroll_y;
+  size_t first;
+  double seconds;
+  // start and length in whole notes; exact if positions are tracked
+  double whole;
+  double whole_length;
+};
+
+#endif /* !TACO_MEASURE_H_ */
@@ -0,0 +1,60 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+#ifndef TACO_MOTION_H_
+#define TACO_MOTION_H_
+
+#include "note.h"
+#include "taco.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct taco_motion_entry_ taco_motion_entry;
+typedef struct taco_motion_state_ taco_motion_state;
+typedef struct taco_scroll_cache_ taco_scroll_cache;
+
+// Motion of an event as cached by its section; see taco_motion.
+struct taco_motion_entry_ {
+  float x;
+  float y;
+  float appear;
+  float move;
+};
+
+// Scrolling state in effect as events are visited in order.
+struct taco_motion_state_ {
+  double bpm;
+  double scroll_x;
+  double scroll_y;
+  int direction;
+  float appear;
+  float move;
+};
+
+// Scroll curves of the drawn events of a section; see taco_scroll. The
+// arrays follow the cache in the same allocation.
+struct taco_scroll_cache_ {
+  int mode;
+  size_t count;
+  double *anchor;
+  float *x;
+  float *y;
+  float *appear;
+  float *move;
+  uint32_t *events;
+};
+
+extern void taco_motion_state_init_(taco_motion_state *restrict state);
+extern void taco_motion_state_update_(taco_motion_state *restrict state,
+                                      const taco_event *restrict event);
+// Gets where notes come from as a vector, turning the scroll speed if
+// scrolled, or a unit vector if not.
+extern void taco_motion_state_vector_(const taco_motion_state *restrict state,
+                                      bool scrolled, double *restrict x,
+                                      double *restrict y);
+
+// Computes the motion of each of count events, which are sorted.
+extern void taco_motion_compute_(const taco_event *restrict events,
+                                 size_t count,
+                                 taco_motion_entry *restrict motions);
+
+#endif /* !TACO_MOTION_H_ */
@@ -36,7 +36,10 @@ struct branch_condition_event_ {
 struct measure_event_ {
   bool real : 1;
   bool hidden : 1;
-  int32_t tja_units;
+  union {
+    int32_t tja_units; // units in measure, before time conversion
+    int32_t ticks;     // length of measure, after time conversion
+  };
 };
 
 struct measure_length_event_ {
@@ -49,6 +52,16 @@ struct complex_scroll_event_ {
   float y;
 };
 
+struct sudden_event_ {
+  float appear; // seconds before the note; 0 if always shown
+  float move;
+};
+
+struct jposscroll_event_ {
+  float seconds;
+  float distance; // to the right
+};
+
 struct taco_event_ {
   uint32_t time;
   int16_t type;
@@ -62,6 +75,8 @@ struct taco_event_ {
     struct measure_event_ measure;
     struct measure_length_event_ tja_measure_length;
     struct complex_scroll_event_ scroll_complex;
+    struct sudden_event_ sudden;
+    struct jposscroll_event_ jposscroll;
   };
 };
 
@@ -11,11 +11,29 @@ typedef taco_courseset *(*taco_parser_parse_fn)(void *restrict parser,
                                                 taco_file *restrict file);
 typedef int (*taco_parser_seterror_fn)(void *restrict parser,
                                        taco_file *restrict file);
+typedef int (*taco_parser_settiming_fn)(void *restrict parser, int timing);
+typedef int (*taco_parser_setdiagnostics_fn)(void *restrict parser,
+                                             taco_diagnostic_fn *callback,
+                                             void *data);
+typedef int (*taco_parser_setseverity_fn)(void *restrict parser,
+                                          int severity);
+typedef int (*taco_parser_setsources_fn)(void *restrict parser, int track);
+typedef int (*taco_parser_feed_fn)(void *restrict parser,
+                                   const void *restrict bytes, size_t size);
+typedef int (*taco_parser_step_fn)(void *restrict parser, uint64_t budget);
+typedef taco_courseset *(*taco_parser_finish_fn)(void *restrict parser);
 
 struct taco_parser_vfuncs_ {
   taco_parser_free_fn free;
   taco_parser_parse_fn parse;
   taco_parser_seterror_fn set_error;
+  taco_parser_settiming_fn set_timing;
+  taco_parser_setdiagnostics_fn set_diagnostics;
+  taco_parser_setseverity_fn set_severity;
+  taco_parser_setsources_fn set_sources;
+  taco_parser_feed_fn feed;
+  taco_parser_step_fn step;
+  taco_parser_finish_fn finish;
 };
 
 extern taco_parser *taco_parser_wrap_(taco_allocator *alloc, void *parser,
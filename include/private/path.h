@@ -0,0 +1,39 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+#ifndef TACO_PATH_H_
+#define TACO_PATH_H_
+
+#include "section.h"
+#include "taco.h"
+#include <stddef.h>
+
+// Events along a branch path. Each branch keeps its own position, which
+// only moves forward; jumping skips the new branch past its copy of the
+// jump, since branches share timing.
+struct taco_path_ {
+  taco_allocator *alloc; // NULL if not owning branches
+  const taco_course *course;
+  const taco_section *sections[3];
+  const taco_event *next[3];
+  int branch;
+  int last; // branch of the last event returned
+  int target; // branch taken at jumps past the decisions given
+  const unsigned char *branches;
+  size_t count;
+  size_t jumps;
+};
+
+// Starts a path over three sections, without copying decisions.
+extern void taco_path_init_(taco_path *restrict p,
+                            const taco_section *const sections[3],
+                            const unsigned char *branches, size_t count);
+// Gets the next event without consuming it. NULL at the end.
+extern const taco_event *taco_path_peek_(const taco_path *restrict p);
+// Sets the branch taken at jumps past the given decisions.
+extern void taco_path_choose_(taco_path *restrict p, int branch);
+// Gets branches a player can reach at the first jump in a range of events,
+// as a bit set. The range of conditions a player can reach before the check
+// is compared to its thresholds.
+extern int taco_path_reachable_(const taco_event *begin,
+                                const taco_event *end, int previous);
+
+#endif /* !TACO_PATH_H_ */
@@ -0,0 +1,15 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+#ifndef TACO_SCORE_H_
+#define TACO_SCORE_H_
+
+// Points given for drum rolls under ac15 style rules.
+#define TACO_SCORE_ROLL_ 100
+#define TACO_SCORE_ROLL_BIG_ 200
+#define TACO_SCORE_BALLOON_ 300
+#define TACO_SCORE_POP_ 5000
+#define TACO_SCORE_POP_LATE_ 1000
+
+// Gets the score of a small note hit at a combo, including the note itself.
+extern int taco_score_note_(int combo, int gogotime, int base, int bonus);
+
+#endif /* !TACO_SCORE_H_ */
@@ -4,6 +4,32 @@
 
 #include "note.h" /* IWYU pragma: keep; required by macros */
 #include "taco.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// BPM of a section until its first BPM event.
+#define TACO_DEFAULT_BPM_ 120
+
+typedef struct taco_position_ taco_position;
+typedef struct taco_source_ taco_source;
+
+// Exact position of an event, as a fraction of the measure it is in.
+struct taco_position_ {
+  uint32_t measure;
+  uint32_t num;
+  uint32_t den; // 0 if unknown; derived from the time in ticks when sorting
+  // exact length of the measure in whole notes, on real barlines; 0/0 if
+  // unknown
+  uint32_t length_num;
+  uint32_t length_den;
+};
+
+// Where an event is in the input.
+struct taco_source_ {
+  uint64_t offset; // in bytes
+  uint32_t line;   // 0 if unknown
+  uint32_t column; // in bytes, from 1
+};
 
 TACO_MALLOC extern taco_section *taco_section_create_();
 TACO_MALLOC extern taco_section *taco_section_create2_(taco_allocator *alloc);
@@ -11,12 +37,17 @@ TACO_MALLOC extern taco_section *
 taco_section_clone_(const taco_section *restrict other);
 extern void taco_section_free_(taco_section *section);
 
+// Mutable access keeps cached data; only adding or removing events drops it.
+// Recache after changing event times.
 extern taco_event *taco_section_begin_mut_(taco_section *restrict section);
 extern taco_event *taco_section_end_mut_(taco_section *restrict section);
 extern taco_event *taco_section_locate_mut_(taco_section *restrict s, size_t i);
 
 extern void taco_section_set_tickrate_(taco_section *restrict section,
                                        int tickrate);
+// Gets the allocator a section was created with.
+extern taco_allocator *
+taco_section_allocator_(const taco_section *restrict section);
 
 extern int taco_section_push_(taco_section *restrict section,
                               const taco_event *restrict event);
@@ -30,12 +61,54 @@ extern int taco_section_pop_(taco_section *restrict section, size_t count);
 extern void taco_section_clear_(taco_section *restrict section);
 extern int taco_section_trim_(taco_section *restrict section);
 
+// Tracks exact positions of events alongside their time in ticks.
+extern int taco_section_track_positions_(taco_section *restrict section);
+// Gets tracked positions, parallel to events. NULL if not tracked.
+extern taco_position *
+taco_section_positions_mut_(taco_section *restrict section);
+
+// Tracks where events are in the input, or stops tracking it.
+extern int taco_section_track_sources_(taco_section *restrict section,
+                                       bool track);
+// Gets tracked sources, parallel to events. NULL if not tracked.
+extern taco_source *taco_section_sources_mut_(taco_section *restrict section);
+// Sets the source of the last event, if tracked.
+extern void taco_section_set_last_source_(taco_section *restrict section,
+                                          const taco_source *restrict source);
+
+// Sorts events, moving none events to the back.
+extern int taco_section_sort_(taco_section *restrict section);
+
 extern int taco_section_set_balloons_(taco_section *restrict section,
                                       const int *restrict balloons,
                                       size_t count);
 
 // generate a sorted tick-to-time array for binary search
 extern int taco_section_cache_seconds_(taco_section *restrict s);
+// generate the measure table
+extern int taco_section_cache_measures_(taco_section *restrict s);
+// precompute how each event moves on screen
+extern int taco_section_cache_motions_(taco_section *restrict s);
+// precompute scroll curves of drawn events under a scroll mode; needs the
+// timing cache
+extern int taco_section_cache_scroll_(taco_section *restrict s, int mode);
+// hash gameplay for finding duplicates; needs the timing cache
+extern void taco_section_cache_fingerprint_(taco_section *restrict s);
+
+typedef struct taco_time_cursor_ taco_time_cursor;
+
+// Gets times of events visited in order, without searching the timing
+// cache for each.
+struct taco_time_cursor_ {
+  const taco_section *section;
+  size_t entry;
+};
+
+extern void taco_time_cursor_init_(taco_time_cursor *restrict c,
+                                   const taco_section *restrict s);
+// Gets the time of an event in seconds. Events must not go backwards.
+extern double taco_time_cursor_seconds_(taco_time_cursor *restrict c,
+                                        const taco_event *restrict e);
 
 #define taco_section_foreach_mut_(i, s)                                        \
   for (taco_event *i = taco_section_begin_mut_(s); i != taco_section_end(s);   \
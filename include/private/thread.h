@@ -0,0 +1,20 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+#ifndef TACO_THREAD_H_
+#define TACO_THREAD_H_
+
+#include "taco.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+typedef void taco_worker_fn_(void *data);
+
+// Gets the number of online processors.
+extern int taco_cpu_count_(void);
+// Runs fn on count threads and waits for all of them. Runs fn on the
+// calling thread if no thread can be created.
+extern int taco_run_workers_(taco_allocator *alloc, int count,
+                             taco_worker_fn_ *fn, void *data);
+// Atomically increments a counter, returning its previous value.
+extern size_t taco_claim_job_(atomic_size_t *next);
+
+#endif /* !TACO_THREAD_H_ */
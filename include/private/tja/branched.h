@@ -12,7 +12,7 @@ struct tja_branched_ {
   int threshold_advanced;
   int threshold_master;
   int measures;
-  int line;
+  tja_location location; // of #BRANCHSTART
   unsigned char levelhold;
 };
 
@@ -0,0 +1,50 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+#ifndef TJA_CHARSETS_H_
+#define TJA_CHARSETS_H_
+
+#include "taco.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Code points of two-byte GB 18030 characters, indexed by lead byte
+ * (0x81-0xfe) and trail byte (0x40-0xfe). Unmapped pairs are 0.
+ */
+extern const uint16_t tja_gbk_table_[126][191];
+
+/*
+ * Four-byte GB 18030 characters in the BMP, as pairs of the first linear
+ * index of a run of consecutive code points and the code point it maps to.
+ */
+extern const uint16_t tja_gb18030_ranges_[206][2];
+
+/*
+ * Code points of two-byte CP949 characters, indexed by lead byte
+ * (0x81-0xfe) and trail byte (0x41-0xfe). Unmapped pairs are 0.
+ */
+extern const uint16_t tja_cp949_table_[126][190];
+
+/* Converts a buffer to UTF-8, like tja_cp932_decode_. */
+typedef size_t tja_decode_fn_(const char *restrict src, size_t size,
+                              char *restrict dst, size_t *restrict consumed,
+                              bool eof);
+
+extern tja_decode_fn_ tja_gb18030_decode_;
+extern tja_decode_fn_ tja_cp949_decode_;
+extern tja_decode_fn_ tja_utf16le_decode_;
+extern tja_decode_fn_ tja_utf16be_decode_;
+
+/*
+ * Detects UTF-16 from a byte order mark, or from the NUL bytes of ASCII
+ * text. Returns TACO_ENCODING_UTF8 if the buffer is neither.
+ */
+extern int tja_detect_unicode_(const char *buf, size_t size);
+
+/*
+ * Picks the likeliest of Shift_JIS, GB 18030 and EUC-KR for text that is
+ * not UTF-8, by scoring the byte pairs in the first few KiB of a buffer.
+ */
+extern int tja_detect_legacy_(const char *buf, size_t size);
+
+#endif /* !TJA_CHARSETS_H_ */
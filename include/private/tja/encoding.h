@@ -0,0 +1,24 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+#ifndef TJA_ENCODING_H_
+#define TJA_ENCODING_H_
+
+#include "io.h"
+#include "taco.h"
+
+/*
+ * Creates a filter presenting a file as UTF-8.
+ *
+ * The encoding is detected on the first buffer of input and checked again
+ * on every later buffer as it is read, so the file is read once and need
+ * not be seekable. UTF-16 is recognized from the first buffer. Otherwise,
+ * input is passed through while it is valid UTF-8; from the first invalid
+ * byte onward it is converted from Shift_JIS, GB 18030 or EUC-KR, whichever
+ * the text there looks most like.
+ *
+ * The encoding in use is stored to *encoding, which must outlive the
+ * filter.
+ */
+extern taco_file *tja_decoder_open_(taco_allocator *alloc, taco_file *file,
+                                    int *encoding);
+
+#endif /* !TJA_ENCODING_H_ */
@@ -11,10 +11,11 @@ typedef struct tja_events_ tja_events;
 
 extern int tja_events_push_note_(tja_parser *restrict parser,
                                  tja_events *restrict events, int note,
-                                 int line);
+                                 const tja_location *restrict loc);
 extern int tja_events_push_event_(tja_parser *restrict parser,
                                   tja_events *restrict events,
-                                  const taco_event *restrict event);
+                                  const taco_event *restrict event,
+                                  const tja_location *restrict loc);
 
 struct tja_events_ {
   int units;
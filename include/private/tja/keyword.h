@@ -0,0 +1,64 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+#ifndef TJA_KEYWORD_H_
+#define TJA_KEYWORD_H_
+
+#include <stddef.h>
+
+typedef struct tja_keyword_ tja_keyword;
+
+// Keywords are found by a perfect hash of their length and their first and
+// last characters, case folded. The hash is a constant expression, so
+// keyword tables are laid out at compile time with TJA_KEYWORD_; a lookup
+// is then a hash and a memcmp. Keywords added to a table must not collide
+// with those already in it: the later initializer silently replaces the
+// earlier one. The tests look up every keyword by name to catch this, so
+// add new keywords to them too.
+#define TJA_KEYWORD_SLOTS 128
+#define TJA_KEYWORD_MAX 16
+
+#define TJA_KEYWORD_FOLD_(c) ((c) >= 'a' && (c) <= 'z' ? (c) - 'a' + 'A' : (c))
+#define TJA_KEYWORD_HASH_(size, first, last)                                   \
+  (((size) + 24 * TJA_KEYWORD_FOLD_(first) + 10 * TJA_KEYWORD_FOLD_(last)) &   \
+   (TJA_KEYWORD_SLOTS - 1))
+
+// Table entry for an upper case keyword; its first and last characters
+// are given separately to compute its slot.
+#define TJA_KEYWORD_(name, first, last, ...)                                   \
+  [TJA_KEYWORD_HASH_(sizeof(name) - 1, first, last)] = {                      \
+      name, sizeof(name) - 1, __VA_ARGS__}
+
+// where a command is recognized
+enum tja_keyword_scope_ {
+  TJA_SCOPE_HEADER = 1, // between courses
+  TJA_SCOPE_BODY = 2,   // between #START and #END
+};
+
+// what the lexer expects after a keyword
+enum tja_keyword_mode_ {
+  TJA_MODE_TEXT,          // text to the end of the line
+  TJA_MODE_NUMERIC,       // numbers separated by commas
+  TJA_MODE_COMMAND,       // arguments of a command outside a course body
+  TJA_MODE_BODY_PRETEXT,  // text after a space, or arguments
+  TJA_MODE_BODY_COMMAND,  // arguments of a command in a course body
+};
+
+struct tja_keyword_ {
+  const char *name;
+  unsigned char size;
+  int value;
+  unsigned char mode;
+  unsigned char scope;
+};
+
+// Finds a keyword in a table of TJA_KEYWORD_SLOTS entries, ignoring case.
+extern const tja_keyword *tja_keyword_find_(const tja_keyword *table,
+                                            const char *name, size_t size);
+
+// Header keywords, naming the header without the colon; their values are
+// tokens.
+extern const tja_keyword tja_header_keywords_[TJA_KEYWORD_SLOTS];
+// Command keywords, naming the command without the '#'; their values are
+// tokens.
+extern const tja_keyword tja_command_keywords_[TJA_KEYWORD_SLOTS];
+
+#endif /* !TJA_KEYWORD_H_ */
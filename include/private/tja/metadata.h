@@ -30,6 +30,7 @@ enum tja_metadata_enum_ {
   TJA_METADATA_BALLOONEXP,
   TJA_METADATA_BALLOONMAS,
   TJA_METADATA_PAPAMAMA,
+  TJA_METADATA_SCROLLMODE,
   TJA_METADATA_SCOREINIT,
   TJA_METADATA_SCOREDIFF,
   TJA_METADATA_MAX,
@@ -61,6 +62,7 @@ struct tja_metadata_ {
   int scoreinit;
   int scorediff;
   int scoreinit_s;
+  int scrollmode;
   bool papamama;
 };
 
@@ -72,6 +74,9 @@ extern int tja_metadata_update_(tja_metadata *old, tja_metadata *updates);
 extern int tja_courseset_apply_metadata_(taco_courseset *set,
                                          tja_metadata *meta);
 extern int tja_course_apply_metadata_(taco_course *course, tja_metadata *meta);
+// Copies the fields applied to a course, to apply later. Balloon hit counts
+// are moved, as applying them would.
+extern tja_metadata *tja_metadata_take_course_(tja_metadata *meta);
 
 extern int tja_interpret_side_(const char *str);
 extern int tja_interpret_course_(const char *str);
@@ -4,24 +4,54 @@
 
 #include "io.h"
 #include "taco.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 typedef struct tja_parser_ tja_parser;
+typedef struct tja_push_ tja_push;
+typedef struct tja_location_ tja_location;
 
-#define TJA_DIAG_FATAL 0
-#define TJA_DIAG_ERROR 1
-#define TJA_DIAG_WARN 2
-#define TJA_DIAG_NOTE 3
+// Location of a token or rule. Columns count bytes from 1; tokens ending a
+// line are on the line after, in column 1.
+struct tja_location_ {
+  int first_line;
+  int first_column;
+  int last_line;
+  int last_column;
+  uint64_t offset; // of the first byte, in the input as decoded
+};
 
 extern tja_parser *tja_parser_create_();
 extern tja_parser *tja_parser_create2_(taco_allocator *alloc);
 extern void tja_parser_free_(tja_parser *parser);
 
 extern taco_courseset *tja_parser_parse_(tja_parser *parser, taco_file *file);
+extern int tja_parser_feed_(tja_parser *parser, const void *bytes,
+                            size_t size);
+extern int tja_parser_step_(tja_parser *parser, uint64_t budget);
+extern taco_courseset *tja_parser_finish_(tja_parser *parser);
 
 extern int tja_parser_set_error_(tja_parser *parser, taco_file *file);
-TACO_PRINTF(4, 5)
-extern void tja_parser_diagnose_(tja_parser *parser, int line, int level,
-                                 const char *format, ...);
+extern int tja_parser_set_timing_(tja_parser *parser, int timing);
+extern int tja_parser_timing_(tja_parser *parser);
+extern int tja_parser_set_diagnostics_(tja_parser *parser,
+                                       taco_diagnostic_fn *callback,
+                                       void *data);
+extern int tja_parser_set_severity_(tja_parser *parser, int severity);
+extern int tja_parser_set_sources_(tja_parser *parser, int track);
+// Reports a diagnostic, given the arguments its message has.
+extern void tja_parser_diagnose_(tja_parser *parser, int line, int code, ...);
+// Reports a diagnostic at a location in the input.
+extern void tja_parser_diagnose_at_(tja_parser *parser,
+                                    const tja_location *loc, int code, ...);
+
+// Locates a token just read by the lexer, at the line it ends on.
+extern void tja_parser_locate_(tja_parser *parser, tja_location *loc,
+                               const char *text, size_t size, int line);
+// Records the location of the last event added to a section, if the section
+// tracks sources.
+extern void tja_set_source_(taco_section *section, const tja_location *loc);
 
 extern taco_allocator *tja_parser_allocator_(tja_parser *parser);
 
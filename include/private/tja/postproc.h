@@ -5,6 +5,7 @@
 #include "parser.h"
 #include "taco.h"
 #include "tja/parser.h"
+#include <stddef.h>
 
 extern int tja_pass_annotate_(tja_parser *parser, taco_section *branch);
 extern int tja_pass_barlines_(tja_parser *parser, taco_section *branch);
@@ -17,4 +18,35 @@ extern int tja_pass_prepend_bgm_(tja_parser *parser, taco_section *branch);
 
 extern int tja_pass_check_branches_(tja_parser *parser, taco_course *course);
 
+typedef struct tja_pass_ tja_pass;
+
+// A post processing pass, run on either each branch or a whole course.
+struct tja_pass_ {
+  const char *name;
+  int (*branch)(tja_parser *parser, taco_section *branch);
+  int (*course)(tja_parser *parser, taco_course *course);
+};
+
+// passes in order of execution
+extern const tja_pass tja_branch_passes_[];
+extern const size_t tja_branch_pass_count_;
+extern const tja_pass tja_course_passes_[];
+extern const size_t tja_course_pass_count_;
+
+// Runs a pass on a branch or course, depending on the pass.
+extern int tja_pass_run_(const tja_pass *pass, tja_parser *parser,
+                         void *target);
+
+// Called in place of running a pass directly, e.g. for profiling. Must
+// run the pass with tja_pass_run_.
+typedef int tja_pass_hook_fn(void *data, const tja_pass *pass,
+                             tja_parser *parser, void *target);
+extern void tja_parser_set_pass_hook_(tja_parser *parser,
+                                      tja_pass_hook_fn *hook, void *data);
+
+// Post processes a course just parsed, and adds it to the courseset if no
+// errors are found. When parsing pushed input, this is left for
+// tja_parser_step_.
+extern void tja_parser_add_course_(tja_parser *parser, taco_course *course);
+
 #endif /* !TJA_POSTPROC_H_ */
@@ -6,22 +6,38 @@
 extern "C" {
 #endif
 
-#include "io.h"
 #include "taco.h"
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 /*
- * Creates a filter on a file that converts it to UTF-8.
+ * Code points of double-byte CP932 characters, indexed by lead byte
+ * (0x81-0x9f, then 0xe0-0xfc) and trail byte (0x40-0xfc). Unmapped pairs
+ * are 0.
+ */
+extern const uint16_t tja_cp932_table_[60][189];
+
+/*
+ * Converts a buffer of CP932 (Microsoft's Shift_JIS) to UTF-8 in one call.
+ * Invalid bytes become U+FFFD REPLACEMENT CHARACTER. dst must hold 3 bytes
+ * per byte of input.
  *
- * If the source character set is not specified (i.e. NULL), it is assumed
- * to be in Shift_JIS per TJA scene convention.
+ * A lead byte at the end of the buffer is left unconsumed unless eof is
+ * set. The number of bytes consumed is stored to *consumed; the number of
+ * bytes written is returned.
  */
-extern taco_file *tja_iconv_open_(taco_allocator *alloc, taco_file *file,
-                                  const char *src_charset);
+extern size_t tja_cp932_decode_(const char *restrict src, size_t size,
+                                char *restrict dst, size_t *restrict consumed,
+                                bool eof);
 
-/* Check if the stream is valid UTF-8. */
-extern bool tja_is_file_utf8_(taco_file *file, taco_allocator *alloc);
+/*
+ * Returns the length of the valid UTF-8 prefix of a buffer. If what
+ * follows it may be a character cut off by the end of the buffer,
+ * *truncated is set.
+ */
+extern size_t tja_utf8_prefix_(const char *buf, size_t size,
+                               bool *restrict truncated);
 
 #ifdef __cplusplus
 }
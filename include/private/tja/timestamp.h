@@ -3,6 +3,10 @@
 #define TJA_TIMESTAMP_H_
 
 #include "taco.h"
+#include <stdint.h>
+
+// Largest measure index or unit representable in a packed timestamp.
+#define TJA_TIMESTAMP_MAX UINT16_MAX
 
 extern void tja_event_get_timestamp_(const taco_event *restrict event,
                                      int *restrict measure, int *restrict unit);
@@ -119,7 +119,22 @@
 
 /* Scroll style. */
 #define TACO_SCROLLMODE_TAIKO 0
-#define TACO_SCROLLMODE_BM 1
+#define TACO_SCROLLMODE_BM 1 /* by beats, ignoring scroll speed changes */
+#define TACO_SCROLLMODE_HB 2 /* by beats, with scroll speed changes */
+
+/* Timing representation of parsed events. Rational timing keeps the exact
+   position of each event within its measure, and rounds times in ticks to
+   a bounded tickrate. */
+#define TACO_TIMING_TICKS 0
+#define TACO_TIMING_RATIONAL 1
+
+/* Character encodings of parsed input. */
+#define TACO_ENCODING_UTF8 0
+#define TACO_ENCODING_UTF16LE 1
+#define TACO_ENCODING_UTF16BE 2
+#define TACO_ENCODING_SHIFT_JIS 3 /* Microsoft's CP932 */
+#define TACO_ENCODING_GB18030 4
+#define TACO_ENCODING_EUC_KR 5 /* Microsoft's CP949, a superset */
 
 /* Branch. */
 #define TACO_BRANCH_NORMAL 0
@@ -155,12 +170,25 @@
 #define TACO_EVENT_GOGOEND (-32)
 #define TACO_EVENT_SCROLL (-33)
 #define TACO_EVENT_SCROLL_COMPLEX (-34)
+#define TACO_EVENT_SUDDEN (-35)
+#define TACO_EVENT_DIRECTION (-36)
+#define TACO_EVENT_JPOSSCROLL (-37)
 #define TACO_EVENT_BPM (-49)
 #define TACO_EVENT_DELAY (-50)
 #define TACO_EVENT_BRANCH_START (-65)
 #define TACO_EVENT_BRANCH_JUMP (-66)
 #define TACO_EVENT_BRANCH_CHECK (-67)
 
+/* Directions notes come from, as set by TACO_EVENT_DIRECTION. */
+#define TACO_DIRECTION_RIGHT 0
+#define TACO_DIRECTION_TOP 1
+#define TACO_DIRECTION_BOTTOM 2
+#define TACO_DIRECTION_TOP_RIGHT 3
+#define TACO_DIRECTION_BOTTOM_RIGHT 4
+#define TACO_DIRECTION_LEFT 5
+#define TACO_DIRECTION_BOTTOM_LEFT 6
+#define TACO_DIRECTION_TOP_LEFT 7
+
 /* Branch conditions. */
 #define TACO_BRANCHTYPE_NONE 0
 #define TACO_BRANCHTYPE_ACCURACY 1
@@ -168,6 +196,42 @@
 #define TACO_BRANCHTYPE_ACCURACY_BIG 3
 #define TACO_BRANCHTYPE_MAX 4
 
+/* Scoring rules. */
+#define TACO_RULES_AC15 0     /* score targets by level, with combo bonus */
+#define TACO_RULES_AC15S 1    /* shin-uchi; a million points, no bonus */
+#define TACO_RULES_AC16 2     /* a million points; 100 points per roll hit */
+#define TACO_RULES_DEFAULT 3  /* course scores; ac15 if not specified */
+#define TACO_RULES_SHINUCHI 4 /* course tournament score; ac15s if not set */
+#define TACO_RULES_MAX 5
+
+/* Shape of gameplay sketches, compared for near duplicate charts. */
+#define TACO_SKETCH_SIZE 32
+#define TACO_SKETCH_BANDS 8 /* of TACO_SKETCH_SIZE / TACO_SKETCH_BANDS rows */
+
+/* Allocation sites, as counted by instrumented allocators. */
+#define TACO_ALLOC_SITE_OTHER 0
+#define TACO_ALLOC_SITE_SECTION 1    /* event storage */
+#define TACO_ALLOC_SITE_CACHE 2      /* timing and measure caches */
+#define TACO_ALLOC_SITE_STRING 3     /* copied strings */
+#define TACO_ALLOC_SITE_BALLOON 4    /* balloon hit counts */
+#define TACO_ALLOC_SITE_ICONV 5      /* character set conversion buffers */
+#define TACO_ALLOC_SITE_DIAGNOSTIC 6 /* formatted messages */
+#define TACO_ALLOC_SITE_IO 7         /* read-ahead buffers */
+#define TACO_ALLOC_SITE_MAX 8
+
+/* Drum inputs given to a judgement engine. */
+#define TACO_INPUT_DON 1
+#define TACO_INPUT_KAT 2
+
+/* Judgements. */
+#define TACO_JUDGE_NONE 0 /* the input hit nothing */
+#define TACO_JUDGE_GOOD 1
+#define TACO_JUDGE_OK 2
+#define TACO_JUDGE_BAD 3  /* also given to missed notes */
+#define TACO_JUDGE_ROLL 4 /* a drum roll or balloon hit */
+#define TACO_JUDGE_POP 5  /* the hit popping a balloon */
+#define TACO_JUDGE_MAX 6
+
 /* Note annotations. */
 #define TACO_TEXT(detail) ((detail) & (INT_MIN | 0xf))
 #define TACO_TEXT_DO 0
@@ -178,6 +242,30 @@
 
 #define TACO_DETAIL_HAND 16
 
+/* Severities of diagnostics, from the most severe. */
+#define TACO_SEVERITY_FATAL 0
+#define TACO_SEVERITY_ERROR 1
+#define TACO_SEVERITY_WARN 2
+#define TACO_SEVERITY_NOTE 3
+
+/* Diagnostics, and the arguments they have. */
+#define TACO_DIAG_SYNTAX 0          /* message */
+#define TACO_DIAG_UNKNOWN_HEADER 1  /* header name */
+#define TACO_DIAG_UNKNOWN_COMMAND 2 /* command name */
+#define TACO_DIAG_UNKNOWN_NOTE 3    /* note character, as an int */
+#define TACO_DIAG_TOO_MANY_MEASURES 4
+#define TACO_DIAG_TOO_MANY_NOTES 5
+#define TACO_DIAG_TOO_LONG 6
+#define TACO_DIAG_ROUNDED 7          /* ticks per measure */
+#define TACO_DIAG_DIVISION_BY_ZERO 8 /* in #MEASURE */
+#define TACO_DIAG_BRANCH_DIVERGES 9  /* branch, branch diverged from */
+#define TACO_DIAG_LAST_TIMING 10     /* note following the above */
+#define TACO_DIAG_BRANCH_TOO_EARLY 11
+#define TACO_DIAG_UNTERMINATED_ROLL 12
+#define TACO_DIAG_NO_DECODER 13
+#define TACO_DIAG_READ_FAILED 14
+#define TACO_DIAG_MAX 15
+
 /* Allow trivial calling of libtaco functions from C++. */
 #ifdef __cplusplus
 extern "C" {
@@ -193,6 +281,24 @@ typedef struct taco_allocator_ taco_allocator;
 typedef struct taco_io_ taco_io;
 /* The scoring mode of a branched section. */
 typedef struct taco_branch_scoring_ taco_branch_scoring;
+/* Scoring parameters of a section. */
+typedef struct taco_score_ taco_score;
+/* Score ceilings among every branch path of a course. */
+typedef struct taco_ceilings_ taco_ceilings;
+/* Difficulty metrics of the notes of a section. */
+typedef struct taco_difficulty_ taco_difficulty;
+/* A sketch of the rhythms of a chart, for finding near duplicates. */
+typedef struct taco_sketch_ taco_sketch;
+/* How an event moves across the screen. */
+typedef struct taco_motion_ taco_motion;
+/* Where the notes of a section are on screen over time. */
+typedef struct taco_scroll_ taco_scroll;
+/* An allocator wrapper counting allocations. */
+typedef struct taco_alloc_stats_ taco_alloc_stats;
+/* A recorded input. */
+typedef struct taco_hit_ taco_hit;
+/* A recorded play, and the results of replaying it. */
+typedef struct taco_replay_ taco_replay;
 
 /* Types for libtaco managed stuff. Everything here are opaque. */
 
@@ -210,6 +316,16 @@ typedef struct taco_course_ taco_course;
 typedef struct taco_section_ taco_section;
 /* An event in a level. */
 typedef struct taco_event_ taco_event;
+/* A measure of a section, with timing state at its start. */
+typedef struct taco_measure_ taco_measure;
+/* Judges inputs against a course as they are played. */
+typedef struct taco_judge_ taco_judge;
+/* Events along a sequence of branches taken. */
+typedef struct taco_path_ taco_path;
+/* A zip archive, such as a song pack. */
+typedef struct taco_archive_ taco_archive;
+/* A problem found in input being parsed. Only valid during a callback. */
+typedef struct taco_diagnostic_ taco_diagnostic;
 
 /* ## Callbacks */
 
@@ -235,6 +351,16 @@ typedef int taco_printf_fn(void *restrict stream, const char *restrict format,
                            va_list ap);
 /* Change the position of a stream. (cf. fseek) */
 typedef int taco_seek_fn(void *restrict stream, uint64_t offset, int whence);
+/* Check whether reading failed, rather than ended. (cf. ferror) */
+typedef int taco_error_fn(void *stream);
+/* Visit a branch path. Return nonzero to stop. */
+typedef int taco_path_fn(const unsigned char *restrict branches, size_t count,
+                         const taco_score *restrict score, void *data);
+/* Receive a diagnostic from a parser. The diagnostic, its file name and its
+   string arguments are borrowed, and only valid until the callback returns;
+   copy them to keep them. */
+typedef void taco_diagnostic_fn(const taco_diagnostic *restrict diag,
+                                void *data);
 
 /* ## Struct definitions */
 
@@ -247,6 +373,86 @@ struct taco_branch_scoring_ {
   int bad;
 };
 
+struct taco_score_ {
+  int base;
+  int bonus;
+  int ceiling;
+  int combo;
+};
+
+struct taco_ceilings_ {
+  int min;
+  int max;
+  double paths; /* number of paths a player can take */
+};
+
+/* Densities are in notes per second, over windows of a length chosen by
+   the caller. Drum rolls and balloons are not counted. */
+struct taco_difficulty_ {
+  int notes;
+  double duration;     /* seconds from the first note to the last */
+  double density;      /* over the duration */
+  double peak_density; /* in the busiest window */
+  double stamina;      /* kept up in every window of a span of 8 windows */
+  double complexity;   /* entropy of the gaps between notes, in bits */
+  double alternation;  /* share of consecutive notes changing color */
+};
+
+/* MinHash of the runs of 4 notes in a chart, each run given by the note
+   types and the gaps between them in 1/192 of a 4/4 measure. The share of
+   equal values estimates how much two charts have in common. */
+struct taco_sketch_ {
+  uint32_t min[TACO_SKETCH_SIZE];
+};
+
+/* Under Taiko scrolling, an event is at (x * t, y * t) from the judgement
+   mark t seconds before its time, where t is capped at `move`. Distances
+   are in 4/4 measures at scroll speed 1, with y pointing up. */
+struct taco_motion_ {
+  double x;
+  double y;
+  double appear; /* seconds before its time it is shown; INFINITY if always */
+  double move;   /* seconds before its time it moves; INFINITY if always */
+};
+
+/* Notes and barlines of a section, drawn event i being events[i]. Under
+   the scroll mode of the course, it is at (x[i] * d, y[i] * d) from the
+   judgement mark when d = anchor[i] - p, p being the scroll progress;
+   d is capped at move[i], and the event is hidden while d > appear[i].
+   Progress is seconds under Taiko scrolling, and 4/4 measures passed
+   under BM and HB scrolling, stopping at delays. */
+struct taco_scroll_ {
+  int mode; /* TACO_SCROLLMODE_* */
+  size_t count;
+  const double *anchor;
+  const float *x;
+  const float *y;
+  const float *appear; /* INFINITY if always shown */
+  const float *move;   /* INFINITY if always moving */
+  const uint32_t *events;
+};
+
+struct taco_hit_ {
+  double seconds;
+  int input;
+};
+
+struct taco_replay_ {
+  /* Inputs, in order. */
+  const taco_hit *hits;
+  size_t count;
+  /* Optional; receives the branch taken at each jump. */
+  unsigned char *path;
+  size_t path_size;
+
+  /* Results. */
+  int valid; /* whether all inputs are known and in order */
+  int score;
+  int max_combo;
+  int counts[TACO_JUDGE_MAX];
+  size_t jumps; /* including ones not fitting in path */
+};
+
 struct taco_allocator_ {
   taco_malloc_fn *malloc;
   taco_free_fn *free;
@@ -266,10 +472,45 @@ struct taco_io_ {
   taco_printf_fn *printf;
   taco_seek_fn *seek;
   /* Do not modify any fields above. Add new fields below. */
+  taco_error_fn *error;
 };
 
 /* Functions */
 
+/*
+ * Creates an instrumented allocator forwarding to another, or the default
+ * allocator if NULL. Not thread safe; use one per thread.
+ */
+TACO_PUBLIC taco_alloc_stats *taco_alloc_stats_create(taco_allocator *backing);
+/* Destroys an instrumented allocator. Memory still allocated is leaked. */
+TACO_PUBLIC void taco_alloc_stats_free(taco_alloc_stats *stats);
+/* Gets the allocator to pass to other functions. */
+TACO_PURE TACO_PUBLIC taco_allocator *
+taco_alloc_stats_allocator(taco_alloc_stats *stats);
+/* Clears counters, except for memory currently in use. */
+TACO_PUBLIC void taco_alloc_stats_reset(taco_alloc_stats *stats);
+/* Gets the number of allocations, including reallocations. */
+TACO_PURE TACO_PUBLIC size_t
+taco_alloc_stats_count(const taco_alloc_stats *stats);
+/* Gets the number of frees. */
+TACO_PURE TACO_PUBLIC size_t
+taco_alloc_stats_frees(const taco_alloc_stats *stats);
+/* Gets the total bytes requested. */
+TACO_PURE TACO_PUBLIC size_t
+taco_alloc_stats_bytes(const taco_alloc_stats *stats);
+/* Gets the bytes currently in use. */
+TACO_PURE TACO_PUBLIC size_t
+taco_alloc_stats_live_bytes(const taco_alloc_stats *stats);
+/* Gets the most bytes in use at once since the last reset. */
+TACO_PURE TACO_PUBLIC size_t
+taco_alloc_stats_peak_bytes(const taco_alloc_stats *stats);
+/* Gets the number of allocations from a site. */
+TACO_PURE TACO_PUBLIC size_t
+taco_alloc_stats_site_count(const taco_alloc_stats *stats, int site);
+/* Gets the bytes requested from a site. */
+TACO_PURE TACO_PUBLIC size_t
+taco_alloc_stats_site_bytes(const taco_alloc_stats *stats, int site);
+
 /* Creates a TJA parser. */
 TACO_PUBLIC taco_parser *taco_parser_tja_create();
 /* Creates a TJA parser, with the specified allocator. */
@@ -282,9 +523,120 @@ TACO_PUBLIC taco_courseset *taco_parser_parse_file(taco_parser *restrict parser,
 /* Parse a courseset from an open <stdio.h> stream. */
 TACO_PUBLIC taco_courseset *
 taco_parser_parse_stdio(taco_parser *restrict parser, FILE *file);
+/*
+ * Parse a courseset from an entry of an archive, decompressing it as it is
+ * read. The courseset is named after the entry. Entries that fail to
+ * decompress, or do not match the size and CRC-32 in the archive, are
+ * reported as TACO_DIAG_READ_FAILED. Entries are read through the file of
+ * the archive, so an archive must not be parsed from several threads.
+ */
+TACO_PUBLIC taco_courseset *
+taco_parser_parse_archive(taco_parser *restrict parser,
+                          taco_archive *restrict archive, size_t index);
+
+/*
+ * Feeds part of a file to a parser, as it arrives. Input is queued, and
+ * parsed by taco_parser_step and taco_parser_finish. Returns 0 on success,
+ * or -1 if the input cannot be parsed; the rest of the file is then ignored
+ * until taco_parser_finish. Until then, other files cannot be parsed with
+ * the parser.
+ */
+TACO_PUBLIC int taco_parser_feed(taco_parser *restrict parser,
+                                 const void *restrict bytes, size_t size);
+
+#define TACO_STEP_MORE 1
+/*
+ * Parses input fed to a parser for about budget nanoseconds, or until there
+ * is nothing to do. Returns TACO_STEP_MORE if work remains, 0 if waiting for
+ * more input, or -1 if the input cannot be parsed.
+ */
+TACO_PUBLIC int taco_parser_step(taco_parser *restrict parser,
+                                 uint64_t budget);
+/*
+ * Ends a file fed to a parser, and returns the courseset parsed from it, or
+ * NULL on error. The parser is then ready for another file.
+ */
+TACO_PUBLIC taco_courseset *taco_parser_finish(taco_parser *restrict parser);
 
 TACO_PUBLIC int taco_parser_set_error_stdio(taco_parser *restrict parser,
                                             FILE *file);
+/* Sets the timing representation used for parsed courses. */
+TACO_PUBLIC int taco_parser_set_timing(taco_parser *restrict parser,
+                                       int timing);
+/*
+ * Sends diagnostics to a callback instead of the error stream, or back to
+ * the error stream if NULL. Messages are only formatted when asked for.
+ */
+TACO_PUBLIC int taco_parser_set_diagnostics(taco_parser *restrict parser,
+                                            taco_diagnostic_fn *callback,
+                                            void *data);
+/*
+ * Drops diagnostics less severe than a severity, before any work is done
+ * on them. All are reported by default.
+ */
+TACO_PUBLIC int taco_parser_set_severity(taco_parser *restrict parser,
+                                         int severity);
+/*
+ * Records where each event is in the input, for taco_event_source. Off by
+ * default, as it takes 16 more bytes per event.
+ */
+TACO_PUBLIC int taco_parser_set_sources(taco_parser *restrict parser,
+                                        int track);
+
+/* Gets the kind of a diagnostic, as one of TACO_DIAG_*. */
+TACO_PURE TACO_PUBLIC int
+taco_diagnostic_code(const taco_diagnostic *restrict diag);
+TACO_PURE TACO_PUBLIC int
+taco_diagnostic_severity(const taco_diagnostic *restrict diag);
+/* Gets the name of the file the diagnostic is in. Valid only during the
+   callback receiving the diagnostic. */
+TACO_PURE TACO_PUBLIC const char *
+taco_diagnostic_file(const taco_diagnostic *restrict diag);
+TACO_PURE TACO_PUBLIC int
+taco_diagnostic_line(const taco_diagnostic *restrict diag);
+/* Gets the column in bytes from 1, or 0 if unknown. */
+TACO_PURE TACO_PUBLIC int
+taco_diagnostic_column(const taco_diagnostic *restrict diag);
+/* Gets the byte offset in the input as converted to UTF-8, if the column is
+   known. */
+TACO_PURE TACO_PUBLIC uint64_t
+taco_diagnostic_offset(const taco_diagnostic *restrict diag);
+TACO_PURE TACO_PUBLIC int
+taco_diagnostic_arg_count(const taco_diagnostic *restrict diag);
+/* Gets a string argument, or NULL if the argument is not a string. Valid
+   only during the callback receiving the diagnostic. */
+TACO_PURE TACO_PUBLIC const char *
+taco_diagnostic_string(const taco_diagnostic *restrict diag, int index);
+/* Gets an integer argument. */
+TACO_PURE TACO_PUBLIC int
+taco_diagnostic_int(const taco_diagnostic *restrict diag, int index);
+/*
+ * Formats the message of a diagnostic, without the file name, line and
+ * severity. Returns the length of the message, writing up to size bytes
+ * including the terminating null. (cf. snprintf)
+ */
+TACO_PUBLIC size_t taco_diagnostic_format(const taco_diagnostic *restrict diag,
+                                          char *restrict buf, size_t size);
+
+/*
+ * Opens a zip archive. Only the directory is read; entries are read when
+ * parsed. Entries stored as is or compressed with deflate can be read.
+ */
+TACO_PUBLIC taco_archive *taco_archive_open(const char *path);
+/* Opens a zip archive, with the specified allocator. */
+TACO_PUBLIC taco_archive *taco_archive_open2(const char *path,
+                                             taco_allocator *allocator);
+/* Closes an archive. */
+TACO_PUBLIC void taco_archive_close(taco_archive *archive);
+/* Gets the number of entries, including directories. */
+TACO_PURE TACO_PUBLIC size_t
+taco_archive_count(const taco_archive *restrict archive);
+/* Gets the path of an entry within the archive, or NULL if out of range. */
+TACO_PURE TACO_PUBLIC const char *
+taco_archive_name(const taco_archive *restrict archive, size_t index);
+/* Gets the uncompressed size of an entry. */
+TACO_PURE TACO_PUBLIC uint64_t
+taco_archive_size(const taco_archive *restrict archive, size_t index);
 
 /* Destroys a courseset. */
 TACO_PUBLIC void taco_courseset_free(taco_courseset *set);
@@ -307,6 +659,12 @@ taco_courseset_filename(const taco_courseset *restrict set);
 /* Gets the path to the audio, relative to the set's directory. */
 TACO_PURE TACO_PUBLIC const char *
 taco_courseset_audio(const taco_courseset *restrict set);
+/*
+ * Gets the character encoding the set was read in. Input starting out as
+ * UTF-8 reports the encoding of what follows its first invalid byte.
+ */
+TACO_PURE TACO_PUBLIC int
+taco_courseset_encoding(const taco_courseset *restrict set);
 /* Gets the start time of the song's preview, in seconds.. */
 TACO_PURE TACO_PUBLIC double
 taco_courseset_demo_time(const taco_courseset *restrict set);
@@ -334,6 +692,9 @@ taco_course_offset(const taco_course *restrict course);
 /* Gets whether multiple players can play the same side of a course. */
 TACO_PURE TACO_PUBLIC int
 taco_course_papamama(const taco_course *restrict course);
+/* Gets how notes scroll. */
+TACO_PURE TACO_PUBLIC int
+taco_course_scrollmode(const taco_course *restrict course);
 /* Gets whether the course branch into different variants. */
 TACO_PURE TACO_PUBLIC int
 taco_course_branched(const taco_course *restrict course);
@@ -355,6 +716,111 @@ TACO_PURE TACO_PUBLIC const taco_section *
 taco_course_get_branch(const taco_course *restrict course, int side,
                        int branch);
 
+/* Creates a path through one side of a course, taking a branch at each
+   jump in order. Jumps past the last branch given stay on the same branch.
+   The path is allocated with the allocator of the course. */
+TACO_PUBLIC taco_path *taco_path_create(const taco_course *restrict course,
+                                        int side,
+                                        const unsigned char *restrict branches,
+                                        size_t count);
+/* Creates a path, with the specified allocator. */
+TACO_PUBLIC taco_path *taco_path_create2(const taco_course *restrict course,
+                                         int side,
+                                         const unsigned char *restrict branches,
+                                         size_t count, taco_allocator *alloc);
+/* Destroys a path. */
+TACO_PUBLIC void taco_path_free(taco_path *path);
+/* Restarts a path from its first event. */
+TACO_PUBLIC void taco_path_rewind(taco_path *restrict path);
+/* Gets the next event along a path, or NULL after the last one. Events are
+   not copied, and stay valid as long as the course. */
+TACO_PUBLIC const taco_event *taco_path_next(taco_path *restrict path);
+/* Gets the section the last event came from, e.g. for its time. */
+TACO_PURE TACO_PUBLIC const taco_section *
+taco_path_section(const taco_path *restrict path);
+/* Gets the branch the last event came from. */
+TACO_PURE TACO_PUBLIC int taco_path_branch(const taco_path *restrict path);
+/* Gets the number of branch jumps passed. */
+TACO_PURE TACO_PUBLIC size_t taco_path_jumps(const taco_path *restrict path);
+/* Computes scoring parameters along a path. Rewinds the path. */
+TACO_PUBLIC int taco_path_score(taco_path *restrict path, int rules,
+                                taco_score *restrict result);
+/* Computes the lowest and highest score ceilings among every branch path a
+   player can take through one side of a course, in time linear to the
+   course length. Per-note scores are those of the master branch. */
+TACO_PUBLIC int taco_course_ceilings(const taco_course *restrict course,
+                                     int side, int rules,
+                                     taco_ceilings *restrict result);
+/* Gets a hash of the gameplay of a course, over every side and branch it
+   has. Headers such as the title, offset or balloon counts do not change
+   it. Returns -1 if a section has no hash. */
+TACO_PUBLIC int taco_course_fingerprint(const taco_course *restrict course,
+                                        uint64_t *restrict fingerprint);
+/* Gets a sketch of the gameplay of a course, over every side and branch
+   it has. Returns -1 if a section has no sketch. */
+TACO_PUBLIC int taco_course_sketch(const taco_course *restrict course,
+                                   taco_sketch *restrict sketch);
+/* Visits every branch path a player can take through one side of a
+   course, with its scoring parameters. Returns the first nonzero value
+   returned by fn. */
+TACO_PUBLIC int taco_course_foreach_path(const taco_course *restrict course,
+                                         int side, int rules, taco_path_fn *fn,
+                                         void *data);
+
+/* Creates a judgement engine playing one side of a course. */
+TACO_PUBLIC taco_judge *taco_judge_create(const taco_course *restrict course,
+                                          int side);
+/* Creates a judgement engine, with the specified allocator. */
+TACO_PUBLIC taco_judge *taco_judge_create2(const taco_course *restrict course,
+                                           int side, taco_allocator *alloc);
+/* Destroys a judgement engine. */
+TACO_PUBLIC void taco_judge_free(taco_judge *judge);
+/* Restarts play from the beginning of the course. */
+TACO_PUBLIC void taco_judge_reset(taco_judge *judge);
+/* Sets the hit windows of each judgement, in seconds. Defaults to ones
+   used by the difficulty class. */
+TACO_PUBLIC int taco_judge_set_windows(taco_judge *restrict judge, double good,
+                                       double ok, double bad);
+/* Records the branch taken at each jump into an array. Jumps past its end
+   are counted but not recorded. */
+TACO_PUBLIC void taco_judge_set_path(taco_judge *restrict judge,
+                                     unsigned char *restrict path,
+                                     size_t size);
+/* Sets the per-note score. Defaults to the course scores, or ac15 ones
+   if not specified. */
+TACO_PUBLIC int taco_judge_set_score(taco_judge *restrict judge, int base,
+                                     int bonus);
+/* Judges an input at a time in seconds. Inputs must be given in order. */
+TACO_PUBLIC int taco_judge_hit(taco_judge *restrict judge, double seconds,
+                               int input);
+/* Advances play to a time in seconds, missing notes no longer hittable. */
+TACO_PUBLIC void taco_judge_advance(taco_judge *restrict judge,
+                                    double seconds);
+/* Ends play, missing all remaining notes. */
+TACO_PUBLIC void taco_judge_finish(taco_judge *restrict judge);
+/* Gets the score so far. */
+TACO_PURE TACO_PUBLIC int taco_judge_score(const taco_judge *restrict judge);
+/* Gets the current combo. */
+TACO_PURE TACO_PUBLIC int taco_judge_combo(const taco_judge *restrict judge);
+/* Gets the highest combo so far. */
+TACO_PURE TACO_PUBLIC int
+taco_judge_max_combo(const taco_judge *restrict judge);
+/* Gets the number of judgements of a kind given so far. */
+TACO_PURE TACO_PUBLIC int taco_judge_count(const taco_judge *restrict judge,
+                                           int judgement);
+/* Gets the branch being played. */
+TACO_PURE TACO_PUBLIC int taco_judge_branch(const taco_judge *restrict judge);
+/* Gets the number of branch jumps passed. */
+TACO_PURE TACO_PUBLIC size_t
+taco_judge_jumps(const taco_judge *restrict judge);
+
+/* Replays recorded plays of one side of a course on up to `threads`
+   threads, or one per processor if 0. Course data is shared between all
+   threads, and must not change meanwhile. */
+TACO_PUBLIC int taco_replay_validate(const taco_course *restrict course,
+                                     int side, taco_replay *restrict replays,
+                                     size_t count, int threads);
+
 /* Gets the count of events. */
 TACO_PURE TACO_PUBLIC size_t
 taco_section_size(const taco_section *restrict section);
@@ -372,6 +838,77 @@ taco_section_end(const taco_section *restrict section);
 TACO_PURE TACO_PUBLIC const taco_event *
 taco_section_locate(const taco_section *restrict section, size_t index);
 
+/* Gets the count of real measures. */
+TACO_PURE TACO_PUBLIC size_t
+taco_section_measure_count(const taco_section *restrict section);
+/* Gets a measure by index. Returns NULL if out of bounds. */
+TACO_PURE TACO_PUBLIC const taco_measure *
+taco_section_measure(const taco_section *restrict section, size_t index);
+/* Gets the measure containing a time in ticks. Returns NULL if the time
+   is before the first measure. */
+TACO_PURE TACO_PUBLIC const taco_measure *
+taco_section_measure_at_tick(const taco_section *restrict section, int ticks);
+/* Gets the measure containing a time in seconds. Returns NULL if the time
+   is before the first measure. */
+TACO_PURE TACO_PUBLIC const taco_measure *
+taco_section_measure_at_time(const taco_section *restrict section,
+                             double seconds);
+
+/* Gets where notes of a section are over time, precomputed for the scroll
+   mode of its course. Returns -1 if not computed. */
+TACO_PUBLIC int taco_section_scroll(const taco_section *restrict section,
+                                    taco_scroll *restrict scroll);
+/* Gets the scroll progress at a time in seconds, under a scroll mode. */
+TACO_PURE TACO_PUBLIC double
+taco_section_scroll_progress(const taco_section *restrict section, int mode,
+                             double seconds);
+/* Gets where drawn event i is relative to the judgement mark at a scroll
+   progress. Returns -1 if it is not shown then. */
+TACO_PUBLIC int taco_scroll_position(const taco_scroll *restrict scroll,
+                                     size_t index, double progress,
+                                     double *restrict x, double *restrict y);
+
+/* Computes scoring parameters of a section under a set of rules. */
+TACO_PUBLIC int taco_section_score(const taco_section *restrict section,
+                                   const taco_course *restrict course,
+                                   int rules, taco_score *restrict result);
+/* Computes scoring parameters under every set of rules at once, into an
+   array of TACO_RULES_MAX results indexed by rules. */
+TACO_PUBLIC int taco_section_score_all(const taco_section *restrict section,
+                                       const taco_course *restrict course,
+                                       taco_score *restrict results);
+
+/* Gets a hash of the notes of a section, with their times in milliseconds
+   from the first note. Returns -1 if not computed. */
+TACO_PUBLIC int taco_section_fingerprint(const taco_section *restrict section,
+                                         uint64_t *restrict fingerprint);
+/* Gets a sketch of the rhythms of a section. Returns -1 if not computed.
+   Sections of fewer than 4 notes have an empty sketch. */
+TACO_PUBLIC int taco_section_sketch(const taco_section *restrict section,
+                                    taco_sketch *restrict sketch);
+/* Estimates the share of rhythms two sketches have in common; 0 if either
+   is empty. */
+TACO_PURE TACO_PUBLIC double taco_sketch_similarity(const taco_sketch *a,
+                                                    const taco_sketch *b);
+/* Gets a hash of one of TACO_SKETCH_BANDS bands of a sketch. Charts sharing
+   any band hash are candidate near duplicates. Empty sketches have no bands
+   and get 0, which is never a candidate. */
+TACO_PURE TACO_PUBLIC uint64_t
+taco_sketch_band(const taco_sketch *restrict sketch, int band);
+
+/* Computes difficulty metrics of a section, with densities taken over
+   windows of `window` seconds. */
+TACO_PUBLIC int taco_section_difficulty(const taco_section *restrict section,
+                                        double window,
+                                        taco_difficulty *restrict result);
+/* Computes difficulty metrics of many sections at once, sharing working
+   memory among them. Working memory is allocated with the allocator of the
+   first section. */
+TACO_PUBLIC int
+taco_section_difficulty_many(const taco_section *const *restrict sections,
+                             size_t count, double window,
+                             taco_difficulty *restrict results);
+
 /* Print a section in an unstable, human-readable format. */
 TACO_PUBLIC void taco_section_print(const taco_section *restrict section,
                                     FILE *restrict file);
@@ -389,6 +926,16 @@ taco_event_detail_float(const taco_event *restrict event);
 /* Get the scrolling multiplier of a scroll event. */
 TACO_PUBLIC int taco_event_scroll(const taco_event *restrict event,
                                   double *restrict x, double *restrict y);
+/* Gets when notes appear and start moving, in seconds before their time,
+   after a TACO_EVENT_SUDDEN. Both are INFINITY if notes are always shown. */
+TACO_PUBLIC int taco_event_sudden(const taco_event *restrict event,
+                                  double *restrict appear,
+                                  double *restrict move);
+/* Gets how a TACO_EVENT_JPOSSCROLL moves the judgement mark: over how many
+   seconds, and how far to the right, in pixels of a 1280x720 screen. */
+TACO_PUBLIC int taco_event_jposscroll(const taco_event *restrict event,
+                                      double *restrict seconds,
+                                      double *restrict distance);
 /* Gets the scoring parameters of a branching section. */
 TACO_PUBLIC int
 taco_event_branch_scoring(const taco_event *restrict event,
@@ -415,6 +962,37 @@ TACO_PURE TACO_PUBLIC double
 taco_event_seconds(const taco_event *restrict event,
                    const taco_section *restrict section);
 
+/* Gets the position of an event as a fraction of a measure. The fraction
+   is exact for courses parsed with rational timing. */
+TACO_PUBLIC int taco_event_position(const taco_event *restrict event,
+                                    const taco_section *restrict section,
+                                    size_t *restrict measure, int *restrict num,
+                                    int *restrict den);
+/* Gets the time of an event in ticks of another tickrate, rounded to the
+   nearest tick. */
+TACO_PURE TACO_PUBLIC int64_t
+taco_event_time_at(const taco_event *restrict event,
+                   const taco_section *restrict section, int tickrate);
+/* Gets where an event is in the input, as a byte offset, a line and a byte
+   column from 1. Returns -1 unless parsed with taco_parser_set_sources, or
+   if the event was not written in the input. Offsets are in the input as
+   converted to UTF-8. */
+TACO_PUBLIC int taco_event_source(const taco_event *restrict event,
+                                  const taco_section *restrict section,
+                                  uint64_t *restrict offset,
+                                  int *restrict line, int *restrict column);
+
+/* Gets how an event moves under Taiko scrolling, precomputed from the
+   tempo, scroll speed, direction and #SUDDEN in effect at the event. */
+TACO_PUBLIC int taco_event_motion(const taco_event *restrict event,
+                                  const taco_section *restrict section,
+                                  taco_motion *restrict motion);
+/* Gets where an event is relative to the judgement mark, `seconds` before
+   its time. Returns -1 if it is not shown then. */
+TACO_PUBLIC int taco_motion_offset(const taco_motion *restrict motion,
+                                   double seconds, double *restrict x,
+                                   double *restrict y);
+
 /* Gets the next event. */
 TACO_PURE TACO_PUBLIC const taco_event *
 taco_event_next(const taco_event *restrict event);
@@ -422,12 +1000,37 @@ taco_event_next(const taco_event *restrict event);
 TACO_PURE TACO_PUBLIC const taco_event *
 taco_event_prev(const taco_event *restrict event);
 
+/* Gets the index of a measure in its section. */
+TACO_PURE TACO_PUBLIC size_t
+taco_measure_index(const taco_measure *restrict measure,
+                   const taco_section *restrict section);
+/* Gets the start time of a measure in ticks. */
+TACO_PURE TACO_PUBLIC int
+taco_measure_time(const taco_measure *restrict measure);
+/* Gets the start time of a measure in seconds. */
+TACO_PURE TACO_PUBLIC double
+taco_measure_seconds(const taco_measure *restrict measure);
+/* Gets the length of a measure in ticks. */
+TACO_PURE TACO_PUBLIC int
+taco_measure_length(const taco_measure *restrict measure);
+/* Gets the index of the first event at or after the start of a measure. */
+TACO_PURE TACO_PUBLIC size_t
+taco_measure_first_event(const taco_measure *restrict measure);
+/* Gets the tempo at the start of a measure. */
+TACO_PURE TACO_PUBLIC double
+taco_measure_bpm(const taco_measure *restrict measure);
+/* Gets the scrolling multiplier at the start of a measure. */
+TACO_PUBLIC int taco_measure_scroll(const taco_measure *restrict measure,
+                                    double *restrict x, double *restrict y);
+
 /* ## Aliases */
 
 /* Gets the number of hits required for a balloon. */
 #define taco_event_hits taco_event_detail_int
 /* Gets the new tempo. */
 #define taco_event_bpm taco_event_detail_float
+/* Gets the direction notes come from. */
+#define taco_event_direction taco_event_detail_int
 
 /* ## Shorthands */
 
@@ -22,7 +22,7 @@ void *taco_default_realloc_(void *ptr, size_t size, void *heap) {
 
 char *taco_strdup_(taco_allocator *a, const char *src) {
   size_t len = strlen(src) + 1;
-  char *dst = taco_malloc_(a, len);
+  char *dst = taco_malloc_at_(a, len, TACO_ALLOC_SITE_STRING);
   if (!dst)
     return NULL;
   memcpy(dst, src, len);
@@ -33,7 +33,7 @@ char *taco_strndup_(taco_allocator *a, const char *src, size_t maxlen) {
   char *nul = memchr(src, 0, maxlen);
   size_t len = nul ? nul - src : maxlen;
 
-  char *dst = taco_malloc_(a, len + 1);
+  char *dst = taco_malloc_at_(a, len + 1, TACO_ALLOC_SITE_STRING);
   if (!dst)
     return NULL;
   memcpy(dst, src, len);
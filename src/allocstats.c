@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "alloc.h"
+
+#include "taco.h"
+#include <stddef.h>
+
+typedef struct site_ site;
+
+struct site_ {
+  size_t count;
+  size_t bytes;
+};
+
+struct taco_alloc_stats_ {
+  taco_allocator iface;
+  taco_allocator *backing;
+  int site; // site of the next allocation
+
+  size_t count;
+  size_t frees;
+  size_t bytes;
+  size_t live;
+  size_t peak;
+  site sites[TACO_ALLOC_SITE_MAX];
+};
+
+// Prepended to each block to track the size of frees.
+typedef union header_ {
+  size_t size;
+  max_align_t align;
+} header;
+
+static void *stats_malloc(size_t size, void *heap);
+static void stats_free(void *ptr, void *heap);
+static void *stats_realloc(void *ptr, size_t size, void *heap);
+
+taco_alloc_stats *taco_alloc_stats_create(taco_allocator *backing) {
+  if (!backing)
+    backing = &taco_default_allocator_;
+
+  taco_alloc_stats *stats = taco_malloc_(backing, sizeof(taco_alloc_stats));
+  if (!stats)
+    return NULL;
+
+  *stats = (taco_alloc_stats){
+      .iface =
+          {
+              .malloc = stats_malloc,
+              .free = stats_free,
+              .realloc = stats_realloc,
+              .heap = stats,
+          },
+      .backing = backing,
+  };
+  return stats;
+}
+
+void taco_alloc_stats_free(taco_alloc_stats *stats) {
+  if (stats)
+    taco_free_(stats->backing, stats);
+}
+
+taco_allocator *taco_alloc_stats_allocator(taco_alloc_stats *stats) {
+  return &stats->iface;
+}
+
+void taco_alloc_stats_reset(taco_alloc_stats *stats) {
+  size_t live = stats->live;
+  *stats = (taco_alloc_stats){
+      .iface = stats->iface,
+      .backing = stats->backing,
+      .live = live,
+      .peak = live,
+  };
+}
+
+void taco_alloc_tag_(taco_allocator *a, int site) {
+  if (a->malloc == stats_malloc)
+    ((taco_alloc_stats *)a->heap)->site = site;
+}
+
+static void record(taco_alloc_stats *stats, size_t size) {
+  int s = stats->site;
+  stats->site = TACO_ALLOC_SITE_OTHER;
+
+  ++stats->count;
+  stats->bytes += size;
+  ++stats->sites[s].count;
+  stats->sites[s].bytes += size;
+}
+
+static void *stats_malloc(size_t size, void *heap) {
+  taco_alloc_stats *stats = heap;
+  record(stats, size);
+
+  header *h = taco_malloc_(stats->backing, sizeof(header) + size);
+  if (!h)
+    return NULL;
+
+  h->size = size;
+  stats->live += size;
+  if (stats->live > stats->peak)
+    stats->peak = stats->live;
+  return h + 1;
+}
+
+static void stats_free(void *ptr, void *heap) {
+  taco_alloc_stats *stats = heap;
+  if (!ptr)
+    return;
+
+  header *h = (header *)ptr - 1;
+  ++stats->frees;
+  stats->live -= h->size;
+  taco_free_(stats->backing, h);
+}
+
+static void *stats_realloc(void *ptr, size_t size, void *heap) {
+  taco_alloc_stats *stats = heap;
+  if (!ptr)
+    return stats_malloc(size, heap);
+
+  record(stats, size);
+
+  header *h = (header *)ptr - 1;
+  size_t old = h->size;
+  h = taco_realloc_(stats->backing, h, sizeof(header) + size);
+  if (!h)
+    return NULL;
+
+  h->size = size;
+  stats->live = stats->live - old + size;
+  if (stats->live > stats->peak)
+    stats->peak = stats->live;
+  return h + 1;
+}
+
+size_t taco_alloc_stats_count(const taco_alloc_stats *stats) {
+  return stats->count;
+}
+
+size_t taco_alloc_stats_frees(const taco_alloc_stats *stats) {
+  return stats->frees;
+}
+
+size_t taco_alloc_stats_bytes(const taco_alloc_stats *stats) {
+  return stats->bytes;
+}
+
+size_t taco_alloc_stats_live_bytes(const taco_alloc_stats *stats) {
+  return stats->live;
+}
+
+size_t taco_alloc_stats_peak_bytes(const taco_alloc_stats *stats) {
+  return stats->peak;
+}
+
+size_t taco_alloc_stats_site_count(const taco_alloc_stats *stats, int site) {
+  if (site < 0 || site >= TACO_ALLOC_SITE_MAX)
+    return 0;
+  return stats->sites[site].count;
+}
+
+size_t taco_alloc_stats_site_bytes(const taco_alloc_stats *stats, int site) {
+  if (site < 0 || site >= TACO_ALLOC_SITE_MAX)
+    return 0;
+  return stats->sites[site].bytes;
+}
@@ -0,0 +1,378 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "archive.h"
+
+#include "alloc.h"
+#include "inflate.h"
+#include "io.h"
+#include "taco.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+// the end of central directory record, with the longest comment allowed
+#define TAIL_SIZE (22 + 65535)
+
+#define SIG_LOCAL 0x04034b50
+#define SIG_CENTRAL 0x02014b50
+#define SIG_END 0x06054b50
+#define SIG_END64 0x06064b50
+#define SIG_LOCATOR64 0x07064b50
+
+#define METHOD_STORED 0
+#define METHOD_DEFLATED 8
+
+typedef struct taco_zip_entry_ taco_zip_entry;
+typedef struct taco_zip_stream_ taco_zip_stream;
+
+static int taco_zip_stream_destroy_(taco_zip_stream *self);
+static size_t taco_zip_stream_read_(char *restrict buf, size_t reserved,
+                                    size_t count, taco_zip_stream *self);
+static int taco_zip_stream_error_(taco_zip_stream *self);
+
+struct taco_zip_entry_ {
+  const char *name;
+  uint64_t offset; // of the local header
+  uint64_t compressed_size;
+  uint64_t size;
+  uint32_t crc;
+  int method; // -1 if encrypted
+};
+
+struct taco_archive_ {
+  taco_allocator *alloc;
+  taco_file *file;
+  taco_zip_entry *entries;
+  size_t count;
+  char *names;
+};
+
+struct taco_zip_stream_ {
+  taco_allocator *alloc;
+  taco_file *file;
+  uint64_t left; // stored data not yet read
+  bool deflated;
+  bool error; // corrupt, truncated, or not matching the directory
+
+  // checked against the directory at the end of the entry
+  uint64_t size;
+  uint64_t produced;
+  uint32_t crc;
+  uint32_t expected_crc;
+
+  taco_inflate inflate;
+};
+
+static const taco_io taco_zip_stream_funcs_ = {
+    .version = sizeof(taco_io),
+    .close = (taco_close_fn *)taco_zip_stream_destroy_,
+    .read = (taco_read_fn *)taco_zip_stream_read_,
+    .error = (taco_error_fn *)taco_zip_stream_error_,
+};
+
+static uint32_t get16(const unsigned char *p) { return p[0] | p[1] << 8; }
+
+static uint32_t get32(const unsigned char *p) {
+  return get16(p) | get16(p + 2) << 16;
+}
+
+static uint64_t get64(const unsigned char *p) {
+  return get32(p) | (uint64_t)get32(p + 4) << 32;
+}
+
+// Reads until size bytes are read or the file ends; returns bytes read.
+static size_t read_full(taco_file *file, void *dst, size_t size) {
+  size_t total = 0, count;
+  while (total < size &&
+         (count = taco_file_read_(file, (char *)dst + total, size - total)))
+    total += count;
+  return total;
+}
+
+// Locates the central directory from the records at the end of the file.
+static bool find_directory(taco_file *file, unsigned char *tail,
+                           uint64_t *offset, uint64_t *size,
+                           uint64_t *count) {
+  // files shorter than the longest tail are read whole
+  if (taco_file_seek_(file, -(uint64_t)TAIL_SIZE, SEEK_END) != 0 &&
+      taco_file_seek_(file, 0, SEEK_SET) != 0)
+    return false;
+  size_t tail_size = read_full(file, tail, TAIL_SIZE);
+  if (tail_size < 22)
+    return false;
+
+  const unsigned char *end = NULL;
+  for (size_t i = tail_size - 22 + 1; i-- > 0;) {
+    if (get32(tail + i) == SIG_END &&
+        i + 22 + get16(tail + i + 20) <= tail_size) {
+      end = tail + i;
+      break;
+    }
+  }
+  if (!end)
+    return false;
+
+  *count = get16(end + 10);
+  *size = get32(end + 12);
+  *offset = get32(end + 16);
+  if (*count != 0xffff && *size != 0xffffffff && *offset != 0xffffffff)
+    return true;
+
+  // saturated fields are found in the Zip64 record instead
+  unsigned char record[56];
+  if (end - tail < 20 || get32(end - 20) != SIG_LOCATOR64)
+    return false;
+  if (taco_file_seek_(file, get64(end - 20 + 8), SEEK_SET) != 0 ||
+      read_full(file, record, 56) != 56 || get32(record) != SIG_END64)
+    return false;
+
+  *count = get64(record + 32);
+  *size = get64(record + 40);
+  *offset = get64(record + 48);
+  return true;
+}
+
+// Replaces saturated fields of an entry with those in its Zip64 extra field.
+static void read_zip64(taco_zip_entry *e, const unsigned char *extra,
+                       size_t size) {
+  while (size >= 4) {
+    size_t id = get16(extra);
+    size_t len = get16(extra + 2);
+    if (len > size - 4)
+      return;
+
+    if (id == 1) {
+      // only saturated fields are present, in this order
+      uint64_t *fields[] = {&e->size, &e->compressed_size, &e->offset};
+      const unsigned char *p = extra + 4;
+      for (int i = 0; i < 3; ++i) {
+        if (*fields[i] == 0xffffffff && p + 8 <= extra + 4 + len) {
+          *fields[i] = get64(p);
+          p += 8;
+        }
+      }
+      return;
+    }
+
+    extra += 4 + len;
+    size -= 4 + len;
+  }
+}
+
+static int load_directory(taco_archive *a, const unsigned char *dir,
+                          size_t size, uint64_t count) {
+  if (count > size / 46)
+    return -1;
+  if (count == 0)
+    return 0;
+
+  // names are stored in the directory, so fit in its size
+  a->entries = taco_malloc_(a->alloc, count * sizeof(taco_zip_entry));
+  a->names = taco_malloc_at_(a->alloc, size, TACO_ALLOC_SITE_STRING);
+  if (!a->entries || !a->names)
+    return -1;
+
+  const unsigned char *p = dir, *end = dir + size;
+  char *name = a->names;
+  for (size_t i = 0; i < count; ++i) {
+    if (end - p < 46 || get32(p) != SIG_CENTRAL)
+      return -1;
+    size_t name_size = get16(p + 28);
+    size_t extra_size = get16(p + 30);
+    size_t record_size = 46 + name_size + extra_size + get16(p + 32);
+    if ((size_t)(end - p) < record_size)
+      return -1;
+
+    taco_zip_entry *e = &a->entries[i];
+    e->method = get16(p + 8) & 1 ? -1 : (int)get16(p + 10);
+    e->crc = get32(p + 16);
+    e->compressed_size = get32(p + 20);
+    e->size = get32(p + 24);
+    e->offset = get32(p + 42);
+    read_zip64(e, p + 46 + name_size, extra_size);
+
+    memcpy(name, p + 46, name_size);
+    name[name_size] = '\0';
+    e->name = name;
+    name += name_size + 1;
+
+    p += record_size;
+    a->count += 1;
+  }
+
+  return 0;
+}
+
+static int load(taco_archive *a) {
+  unsigned char *tail =
+      taco_malloc_at_(a->alloc, TAIL_SIZE, TACO_ALLOC_SITE_IO);
+  if (!tail)
+    return -1;
+
+  uint64_t offset, size, count;
+  bool found = find_directory(a->file, tail, &offset, &size, &count);
+  taco_free_(a->alloc, tail);
+  if (!found || size > SIZE_MAX)
+    return -1;
+
+  unsigned char *dir = taco_malloc_at_(a->alloc, size, TACO_ALLOC_SITE_IO);
+  if (!dir)
+    return -1;
+
+  int result = -1;
+  if (taco_file_seek_(a->file, offset, SEEK_SET) == 0 &&
+      read_full(a->file, dir, size) == size)
+    result = load_directory(a, dir, size, count);
+
+  taco_free_(a->alloc, dir);
+  return result;
+}
+
+taco_archive *taco_archive_open2(const char *path, taco_allocator *alloc) {
+  if (!alloc)
+    alloc = &taco_default_allocator_;
+
+  taco_archive *a = taco_malloc_(alloc, sizeof(taco_archive));
+  if (!a)
+    return NULL;
+
+  memset(a, 0, sizeof(taco_archive));
+  a->alloc = alloc;
+  a->file = taco_file_open_path_(path, "rb");
+  if (!a->file || load(a) != 0) {
+    taco_archive_close(a);
+    return NULL;
+  }
+
+  return a;
+}
+
+taco_archive *taco_archive_open(const char *path) {
+  return taco_archive_open2(path, NULL);
+}
+
+void taco_archive_close(taco_archive *archive) {
+  if (!archive)
+    return;
+
+  taco_file_close_(archive->file);
+  taco_free_(archive->alloc, archive->names);
+  taco_free_(archive->alloc, archive->entries);
+  taco_free_(archive->alloc, archive);
+}
+
+size_t taco_archive_count(const taco_archive *restrict archive) {
+  return archive->count;
+}
+
+const char *taco_archive_name(const taco_archive *restrict archive,
+                              size_t index) {
+  if (index >= archive->count)
+    return NULL;
+  return archive->entries[index].name;
+}
+
+uint64_t taco_archive_size(const taco_archive *restrict archive,
+                           size_t index) {
+  if (index >= archive->count)
+    return 0;
+  return archive->entries[index].size;
+}
+
+static int taco_zip_stream_destroy_(taco_zip_stream *self) {
+  taco_free_(self->alloc, self);
+
+  // make the occasional user of fclose return value happy here
+  return 0;
+}
+
+// Updates a CRC-32, as in zip and gzip, half a byte at a time.
+static uint32_t crc32_(uint32_t crc, const unsigned char *p, size_t size) {
+  static const uint32_t table[16] = {
+      0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4,
+      0x4db26158, 0x5005713c, 0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+      0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+  };
+
+  crc = ~crc;
+  for (size_t i = 0; i < size; ++i) {
+    crc ^= p[i];
+    crc = crc >> 4 ^ table[crc & 15];
+    crc = crc >> 4 ^ table[crc & 15];
+  }
+  return ~crc;
+}
+
+static size_t taco_zip_stream_read_(char *restrict buf, size_t reserved,
+                                    size_t count, taco_zip_stream *self) {
+  if (self->error)
+    return 0;
+
+  size_t n;
+  bool end;
+  if (self->deflated) {
+    n = taco_inflate_read_(&self->inflate, buf, count);
+    self->error = self->inflate.error;
+    end = n < count || taco_inflate_done_(&self->inflate);
+  } else {
+    size_t want = count < self->left ? count : self->left;
+    n = want ? taco_file_read_(self->file, buf, want) : 0;
+    self->left -= n;
+    end = self->left == 0 || n < want;
+  }
+
+  self->produced += n;
+  self->crc = crc32_(self->crc, (const unsigned char *)buf, n);
+  if (self->produced > self->size)
+    self->error = true;
+  // checked as soon as the entry ends, not at a later short read
+  if (end && (self->produced != self->size || self->crc != self->expected_crc))
+    self->error = true;
+  return n;
+}
+
+static int taco_zip_stream_error_(taco_zip_stream *self) {
+  return self->error;
+}
+
+taco_file *taco_archive_open_entry_(taco_archive *archive, size_t index) {
+  if (index >= archive->count)
+    return NULL;
+  const taco_zip_entry *e = &archive->entries[index];
+  if (e->method != METHOD_STORED && e->method != METHOD_DEFLATED)
+    return NULL;
+
+  // the local header may have names and extra fields differing from the
+  // directory; only their sizes matter
+  unsigned char header[30];
+  if (taco_file_seek_(archive->file, e->offset, SEEK_SET) != 0 ||
+      read_full(archive->file, header, 30) != 30 ||
+      get32(header) != SIG_LOCAL)
+    return NULL;
+  uint64_t data = e->offset + 30 + get16(header + 26) + get16(header + 28);
+  if (taco_file_seek_(archive->file, data, SEEK_SET) != 0)
+    return NULL;
+
+  taco_zip_stream *stream = taco_malloc_at_(
+      archive->alloc, sizeof(taco_zip_stream), TACO_ALLOC_SITE_IO);
+  if (!stream)
+    return NULL;
+
+  stream->alloc = archive->alloc;
+  stream->file = archive->file;
+  stream->left = e->compressed_size;
+  stream->deflated = e->method == METHOD_DEFLATED;
+  stream->error = false;
+  stream->size = e->size;
+  stream->produced = 0;
+  stream->crc = 0;
+  stream->expected_crc = e->crc;
+  if (stream->deflated)
+    taco_inflate_init_(&stream->inflate, archive->file, e->compressed_size);
+
+  taco_file *f = taco_file_open_(archive->alloc, stream, e->name,
+                                 &taco_zip_stream_funcs_);
+  if (!f)
+    taco_zip_stream_destroy_(stream);
+  return f;
+}
@@ -70,6 +70,10 @@ void taco_course_free_(taco_course *restrict c) {
   taco_free_(c->alloc, c);
 }
 
+taco_allocator *taco_course_allocator_(const taco_course *restrict course) {
+  return course->alloc;
+}
+
 const char *taco_course_maker(const taco_course *restrict course) {
   return course->maker;
 }
@@ -98,6 +102,10 @@ int taco_course_papamama(const taco_course *restrict course) {
   return course->papamama;
 }
 
+int taco_course_scrollmode(const taco_course *restrict course) {
+  return course->scrollmode;
+}
+
 int taco_course_branched(const taco_course *restrict course) {
   return course->branched;
 }
@@ -149,6 +157,31 @@ void taco_course_set_papamama_(taco_course *restrict course, int papamama) {
   course->papamama = papamama;
 }
 
+void taco_course_set_scrollmode_(taco_course *restrict course,
+                                 int scrollmode) {
+  course->scrollmode = scrollmode;
+}
+
+int taco_course_cache_(taco_course *restrict course) {
+  int result = 0;
+  for (int side = 0; side < 2; ++side) {
+    for (int branch = 0; branch < 3; ++branch) {
+      taco_section *s = course->branches[side][branch];
+      if (!s)
+        continue;
+
+      // seconds of measures need the measure table
+      if (taco_section_cache_measures_(s) != 0 ||
+          taco_section_cache_seconds_(s) != 0 ||
+          taco_section_cache_motions_(s) != 0 ||
+          taco_section_cache_scroll_(s, course->scrollmode) != 0)
+        result = -1;
+      taco_section_cache_fingerprint_(s);
+    }
+  }
+  return result;
+}
+
 void taco_course_set_bpm_(taco_course *restrict course, double bpm) {
   course->basebpm = bpm;
 }
@@ -18,6 +18,7 @@ struct taco_courseset_ {
   char *filename;
   char *audio;
   double demo_time;
+  int encoding;
 
   taco_course *courses[8];
 };
@@ -91,6 +92,14 @@ STRING_PROPERTY(filename, "<unknown>")
 
 STRING_PROPERTY(audio, "")
 
+int taco_courseset_encoding(const taco_courseset *restrict set) {
+  return set->encoding;
+}
+
+void taco_courseset_set_encoding_(taco_courseset *restrict set, int encoding) {
+  set->encoding = encoding;
+}
+
 double taco_courseset_demo_time(const taco_courseset *restrict set) {
   return set->demo_time;
 }
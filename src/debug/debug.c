@@ -89,6 +89,22 @@ static void print_event_(const taco_event *restrict event,
     fprintf(file, "%d scroll mult=%lg\n", event->time,
             event->detail_float.value);
     break;
+  case TACO_EVENT_SCROLL_COMPLEX:
+    fprintf(file, "%d scroll mult=%lg%+lgi\n", event->time,
+            (double)event->scroll_complex.x, (double)event->scroll_complex.y);
+    break;
+  case TACO_EVENT_SUDDEN:
+    fprintf(file, "%d sudden appear=%lg move=%lg\n", event->time,
+            (double)event->sudden.appear, (double)event->sudden.move);
+    break;
+  case TACO_EVENT_DIRECTION:
+    fprintf(file, "%d direction %d\n", event->time, event->detail_int.value);
+    break;
+  case TACO_EVENT_JPOSSCROLL:
+    fprintf(file, "%d jposscroll time=%lg distance=%lg\n", event->time,
+            (double)event->jposscroll.seconds,
+            (double)event->jposscroll.distance);
+    break;
   case TACO_EVENT_BPM:
     fprintf(file, "%d bpm tempo=%lg\n", event->time, event->detail_float.value);
     break;
@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "diagnostic.h"
+
+#include "taco.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct message_ message;
+
+// Messages take arguments as %s for strings, and %d or %c for integers.
+struct message_ {
+  int severity;
+  const char *format;
+};
+
+static const message messages_[TACO_DIAG_MAX] = {
+    [TACO_DIAG_SYNTAX] = {TACO_SEVERITY_ERROR, "%s"},
+    [TACO_DIAG_UNKNOWN_HEADER] = {TACO_SEVERITY_WARN,
+                                  "unrecognized header: %s"},
+    [TACO_DIAG_UNKNOWN_COMMAND] = {TACO_SEVERITY_WARN,
+                                   "unrecognized command: %s"},
+    [TACO_DIAG_UNKNOWN_NOTE] = {TACO_SEVERITY_WARN,
+                                "unrecognized note type '%c'"},
+    [TACO_DIAG_TOO_MANY_MEASURES] = {TACO_SEVERITY_ERROR,
+                                     "too many measures in course"},
+    [TACO_DIAG_TOO_MANY_NOTES] = {TACO_SEVERITY_ERROR,
+                                  "too many notes in measure"},
+    [TACO_DIAG_TOO_LONG] = {TACO_SEVERITY_ERROR, "course is too long"},
+    [TACO_DIAG_ROUNDED] = {TACO_SEVERITY_WARN,
+                           "timing too fine for exact representation; "
+                           "rounding to %d ticks per measure"},
+    [TACO_DIAG_DIVISION_BY_ZERO] = {TACO_SEVERITY_ERROR,
+                                    "division by zero in #MEASURE"},
+    [TACO_DIAG_BRANCH_DIVERGES] = {TACO_SEVERITY_ERROR,
+                                   "timing of branch %s diverges from %s"},
+    [TACO_DIAG_LAST_TIMING] = {TACO_SEVERITY_NOTE,
+                               "last timing event in master here"},
+    [TACO_DIAG_BRANCH_TOO_EARLY] = {TACO_SEVERITY_WARN,
+                                    "not enough time before #BRANCHSTART"},
+    [TACO_DIAG_UNTERMINATED_ROLL] = {TACO_SEVERITY_WARN,
+                                     "drum roll does not terminate"},
+    [TACO_DIAG_NO_DECODER] = {TACO_SEVERITY_FATAL,
+                              "failed to create character set conversion "
+                              "filter"},
+    [TACO_DIAG_READ_FAILED] = {TACO_SEVERITY_FATAL,
+                               "failed to read input; it may be corrupt"},
+};
+
+int taco_diagnostic_severity_of_(int code) {
+  return messages_[code].severity;
+}
+
+void taco_diagnostic_init_(taco_diagnostic *restrict diag, int code,
+                           const char *file, int line, va_list ap) {
+  diag->code = code;
+  diag->severity = messages_[code].severity;
+  diag->file = file;
+  diag->line = line;
+  diag->column = 0;
+  diag->offset = 0;
+  diag->arg_count = 0;
+
+  for (const char *p = strchr(messages_[code].format, '%'); p;
+       p = strchr(p + 2, '%')) {
+    taco_diagnostic_arg *arg = &diag->args[diag->arg_count++];
+    if (p[1] == 's')
+      arg->s = va_arg(ap, const char *);
+    else
+      arg->i = va_arg(ap, int);
+  }
+}
+
+int taco_diagnostic_code(const taco_diagnostic *restrict diag) {
+  return diag->code;
+}
+
+int taco_diagnostic_severity(const taco_diagnostic *restrict diag) {
+  return diag->severity;
+}
+
+const char *taco_diagnostic_file(const taco_diagnostic *restrict diag) {
+  return diag->file;
+}
+
+int taco_diagnostic_line(const taco_diagnostic *restrict diag) {
+  return diag->line;
+}
+
+int taco_diagnostic_column(const taco_diagnostic *restrict diag) {
+  return diag->column;
+}
+
+uint64_t taco_diagnostic_offset(const taco_diagnostic *restrict diag) {
+  return diag->offset;
+}
+
+int taco_diagnostic_arg_count(const taco_diagnostic *restrict diag) {
+  return diag->arg_count;
+}
+
+const char *taco_diagnostic_string(const taco_diagnostic *restrict diag,
+                                   int index) {
+  if (index < 0 || index >= diag->arg_count)
+    return NULL;
+
+  const char *p = messages_[diag->code].format;
+  for (int i = 0; i <= index; ++i)
+    p = strchr(p, '%') + 1;
+  return *p == 's' ? diag->args[index].s : NULL;
+}
+
+int taco_diagnostic_int(const taco_diagnostic *restrict diag, int index) {
+  if (index < 0 || index >= diag->arg_count)
+    return 0;
+  return diag->args[index].i;
+}
+
+size_t taco_diagnostic_format(const taco_diagnostic *restrict diag,
+                              char *restrict buf, size_t size) {
+  size_t length = 0;
+  int arg = 0;
+
+  for (const char *p = messages_[diag->code].format; *p; ++p) {
+    char piece[16];
+    const char *text = piece;
+    size_t n = 1;
+
+    if (*p != '%') {
+      piece[0] = *p;
+    } else if (*++p == 's') {
+      text = diag->args[arg++].s;
+      n = strlen(text);
+    } else if (*p == 'c') {
+      piece[0] = (char)diag->args[arg++].i;
+    } else {
+      n = snprintf(piece, sizeof(piece), "%d", diag->args[arg++].i);
+    }
+
+    // the message is cut short to fit, like snprintf
+    if (length < size) {
+      size_t room = size - length - 1;
+      memcpy(buf + length, text, n < room ? n : room);
+    }
+    length += n;
+  }
+
+  if (size)
+    buf[length < size ? length : size - 1] = '\0';
+  return length;
+}
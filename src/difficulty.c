@@ -0,0 +1,195 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "alloc.h"
+#include "section.h"
+#include "taco.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Notes of a section are gathered into parallel arrays in one sweep, using
+// a time cursor instead of searching the timing cache per note. Windowed
+// metrics then slide over the arrays with two cursors, and the weakest
+// window of each stamina span is kept in a monotonic deque.
+
+// length of a stamina span, in windows
+#define STAMINA_SPAN 8
+// rhythms are compared in 1/192 of a 4/4 measure; longer gaps share a bucket
+#define RHYTHM_UNITS 192
+
+typedef struct scratch_ scratch;
+
+// Arrays shared by the sections measured, each holding a value per note.
+struct scratch_ {
+  taco_allocator *alloc;
+  double *seconds;
+  int64_t *ticks;
+  size_t *counts; // notes in the window ending at each note
+  size_t *deque;
+  unsigned char *colors;
+};
+
+static bool hit_note_(int type) {
+  switch (type) {
+  case TACO_EVENT_DON:
+  case TACO_EVENT_KAT:
+  case TACO_EVENT_DON_BIG:
+  case TACO_EVENT_KAT_BIG:
+  case TACO_EVENT_KADON:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static unsigned char color_(int type) {
+  switch (type) {
+  case TACO_EVENT_DON:
+  case TACO_EVENT_DON_BIG:
+    return 0;
+  case TACO_EVENT_KAT:
+  case TACO_EVENT_KAT_BIG:
+    return 1;
+  default:
+    return 2;
+  }
+}
+
+static void release_(scratch *restrict w) {
+  taco_allocator *a = w->alloc;
+  taco_free_(a, w->seconds);
+  taco_free_(a, w->ticks);
+  taco_free_(a, w->counts);
+  taco_free_(a, w->deque);
+  taco_free_(a, w->colors);
+  memset(w, 0, sizeof(*w));
+}
+
+static int reserve_(scratch *restrict w, taco_allocator *a, size_t capacity) {
+  w->alloc = a;
+  w->seconds = taco_malloc_(a, capacity * sizeof(double));
+  w->ticks = taco_malloc_(a, capacity * sizeof(int64_t));
+  w->counts = taco_malloc_(a, capacity * sizeof(size_t));
+  w->deque = taco_malloc_(a, capacity * sizeof(size_t));
+  w->colors = taco_malloc_(a, capacity);
+  if (!w->seconds || !w->ticks || !w->counts || !w->deque || !w->colors) {
+    release_(w);
+    return -1;
+  }
+  return 0;
+}
+
+static void measure_(scratch *restrict w, const taco_section *restrict s,
+                     double window, taco_difficulty *restrict r) {
+  double *seconds = w->seconds;
+  int64_t *ticks = w->ticks;
+  size_t *counts = w->counts;
+  size_t *deque = w->deque;
+  unsigned char *colors = w->colors;
+
+  size_t n = 0;
+  taco_time_cursor cursor;
+  taco_time_cursor_init_(&cursor, s);
+  taco_section_foreach(i, s) {
+    int type = taco_event_type(i);
+    if (!hit_note_(type))
+      continue;
+    seconds[n] = taco_time_cursor_seconds_(&cursor, i);
+    ticks[n] = taco_event_time_at(i, s, RHYTHM_UNITS);
+    colors[n] = color_(type);
+    n += 1;
+  }
+
+  memset(r, 0, sizeof(*r));
+  r->notes = (int)n;
+  if (n == 0)
+    return;
+
+  r->duration = seconds[n - 1] - seconds[0];
+  if (r->duration > 0)
+    r->density = n / r->duration;
+
+  if (n > 1) {
+    size_t changes = 0;
+    for (size_t k = 1; k < n; ++k)
+      changes += colors[k] != colors[k - 1];
+    r->alternation = (double)changes / (n - 1);
+
+    size_t rhythms[RHYTHM_UNITS + 2] = {0};
+    for (size_t k = 1; k < n; ++k) {
+      int64_t gap = ticks[k] - ticks[k - 1];
+      if (gap < 0)
+        gap = 0;
+      if (gap > RHYTHM_UNITS)
+        gap = RHYTHM_UNITS + 1;
+      rhythms[gap] += 1;
+    }
+    for (size_t b = 0; b < RHYTHM_UNITS + 2; ++b) {
+      if (rhythms[b] == 0)
+        continue;
+      double p = (double)rhythms[b] / (n - 1);
+      r->complexity -= p * log2(p);
+    }
+  }
+
+  // windows are half open, ending at each note
+  double span = STAMINA_SPAN * window;
+  size_t lo = 0;
+  size_t head = 0;
+  size_t tail = 0;
+  size_t peak = 0;
+  size_t stamina = 0;
+  for (size_t k = 0; k < n; ++k) {
+    while (seconds[lo] <= seconds[k] - window)
+      lo += 1;
+    counts[k] = k - lo + 1;
+    if (counts[k] > peak)
+      peak = counts[k];
+
+    // the front of the deque is the weakest window of the span
+    while (tail > head && counts[deque[tail - 1]] >= counts[k])
+      tail -= 1;
+    deque[tail++] = k;
+    while (seconds[deque[head]] <= seconds[k] - (span - window))
+      head += 1;
+    if (counts[deque[head]] > stamina)
+      stamina = counts[deque[head]];
+  }
+
+  r->peak_density = peak / window;
+  r->stamina = stamina / window;
+}
+
+int taco_section_difficulty(const taco_section *restrict s, double window,
+                            taco_difficulty *restrict result) {
+  const taco_section *sections[] = {s};
+  return taco_section_difficulty_many(sections, 1, window, result);
+}
+
+int taco_section_difficulty_many(const taco_section *const *restrict sections,
+                                 size_t count, double window,
+                                 taco_difficulty *restrict results) {
+  if (!(window > 0))
+    return -1;
+  if (count == 0)
+    return 0;
+
+  // notes are at most as many as events
+  size_t capacity = 1;
+  for (size_t n = 0; n < count; ++n) {
+    size_t size = taco_section_size(sections[n]);
+    if (size > capacity)
+      capacity = size;
+  }
+
+  scratch w = {0};
+  if (reserve_(&w, taco_section_allocator_(sections[0]), capacity) != 0)
+    return -1;
+
+  for (size_t n = 0; n < count; ++n)
+    measure_(&w, sections[n], window, &results[n]);
+
+  release_(&w);
+  return 0;
+}
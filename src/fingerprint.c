@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "fingerprint.h"
+
+#include "section.h"
+#include "taco.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// Fingerprints and sketches are meant to be stored and compared across
+// versions, so the hashes below are fixed; changing them invalidates every
+// stored hash.
+
+// notes in a run sketched
+#define RUN_LENGTH 4
+// rhythms are compared in 1/192 of a 4/4 measure
+#define RHYTHM_UNITS 192
+#define GOLDEN 0x9e3779b97f4a7c15u
+
+// finalizer of splitmix64
+static uint64_t mix_(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9u;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebu;
+  x ^= x >> 31;
+  return x;
+}
+
+void taco_fingerprint_compute_(const taco_section *restrict s,
+                               uint64_t *restrict fingerprint,
+                               taco_sketch *restrict sketch) {
+  for (int j = 0; j < TACO_SKETCH_SIZE; ++j)
+    sketch->min[j] = UINT32_MAX;
+
+  uint64_t hash = 0;
+  uint64_t run[RUN_LENGTH] = {0};
+  size_t n = 0;
+  double first = 0;
+  int64_t last = 0;
+
+  taco_time_cursor cursor;
+  taco_time_cursor_init_(&cursor, s);
+  taco_section_foreach(i, s) {
+    int type = taco_event_type(i);
+    if (type <= 0)
+      continue;
+
+    double seconds = taco_time_cursor_seconds_(&cursor, i);
+    int64_t ticks = taco_event_time_at(i, s, RHYTHM_UNITS);
+    if (n == 0) {
+      first = seconds;
+      last = ticks;
+    }
+
+    // times are from the first note, so leading silence does not count
+    double offset = (seconds - first) * 1000;
+    uint64_t ms = isfinite(offset) ? (uint64_t)llround(offset) : 0;
+    hash = mix_(hash ^ mix_(ms << 8 | (unsigned char)type));
+
+    // a run is hashed by its gaps, not its times, so that the same run
+    // anywhere in the chart hashes the same
+    memmove(run, run + 1, (RUN_LENGTH - 1) * sizeof(uint64_t));
+    run[RUN_LENGTH - 1] = (uint64_t)(ticks - last) << 8 | (unsigned char)type;
+    last = ticks;
+    n += 1;
+    if (n < RUN_LENGTH)
+      continue;
+
+    // the gap before a run is not part of it
+    uint64_t h = mix_(run[0] & 0xff);
+    for (int k = 1; k < RUN_LENGTH; ++k)
+      h = mix_(h ^ run[k]);
+    for (int j = 0; j < TACO_SKETCH_SIZE; ++j) {
+      uint32_t v = mix_(h + j * GOLDEN) >> 32;
+      if (v < sketch->min[j])
+        sketch->min[j] = v;
+    }
+  }
+
+  *fingerprint = mix_(hash ^ n);
+}
+
+// Tells whether a sketch has no runs, as for sections of fewer notes than
+// a run; such sketches are alike without sharing any rhythm.
+static bool empty_(const taco_sketch *restrict sketch) {
+  for (int j = 0; j < TACO_SKETCH_SIZE; ++j) {
+    if (sketch->min[j] != UINT32_MAX)
+      return false;
+  }
+  return true;
+}
+
+double taco_sketch_similarity(const taco_sketch *a, const taco_sketch *b) {
+  if (empty_(a) || empty_(b))
+    return 0;
+
+  int equal = 0;
+  for (int j = 0; j < TACO_SKETCH_SIZE; ++j)
+    equal += a->min[j] == b->min[j];
+  return (double)equal / TACO_SKETCH_SIZE;
+}
+
+uint64_t taco_sketch_band(const taco_sketch *restrict sketch, int band) {
+  const int rows = TACO_SKETCH_SIZE / TACO_SKETCH_BANDS;
+  if (band < 0 || band >= TACO_SKETCH_BANDS || empty_(sketch))
+    return 0;
+
+  uint64_t h = mix_(band + 1);
+  for (int k = 0; k < rows; ++k)
+    h = mix_(h ^ sketch->min[band * rows + k]);
+  return h;
+}
+
+// Visits each section of a course once; NULL when done.
+static const taco_section *next_section_(const taco_course *restrict course,
+                                         int *restrict index) {
+  int sides = taco_course_style(course) == TACO_STYLE_SINGLE ? 1 : 2;
+  int branches = taco_course_branched(course) ? 3 : 1;
+  while (*index < sides * branches) {
+    int side = *index / branches;
+    int branch = *index % branches;
+    *index += 1;
+
+    const taco_section *s = taco_course_get_branch(course, side, branch);
+    if (s)
+      return s;
+  }
+  return NULL;
+}
+
+int taco_course_fingerprint(const taco_course *restrict course,
+                            uint64_t *restrict fingerprint) {
+  uint64_t hash = 0;
+  int index = 0;
+  const taco_section *s;
+  while ((s = next_section_(course, &index))) {
+    uint64_t f;
+    if (taco_section_fingerprint(s, &f) != 0)
+      return -1;
+    // mixed in order, telling sides and branches apart
+    hash = mix_(hash ^ f);
+  }
+
+  *fingerprint = hash;
+  return 0;
+}
+
+int taco_course_sketch(const taco_course *restrict course,
+                       taco_sketch *restrict sketch) {
+  for (int j = 0; j < TACO_SKETCH_SIZE; ++j)
+    sketch->min[j] = UINT32_MAX;
+
+  // minimums of the union of the runs of every section
+  int index = 0;
+  const taco_section *s;
+  while ((s = next_section_(course, &index))) {
+    taco_sketch other;
+    if (taco_section_sketch(s, &other) != 0)
+      return -1;
+    for (int j = 0; j < TACO_SKETCH_SIZE; ++j) {
+      if (other.min[j] < sketch->min[j])
+        sketch->min[j] = other.min[j];
+    }
+  }
+  return 0;
+}
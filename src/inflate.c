@@ -0,0 +1,333 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "inflate.h"
+
+#include "io.h"
+#include <stddef.h>
+#include <string.h>
+
+#define MAX_BITS 15
+#define FAST_BITS 9
+#define WINDOW_MASK 32767
+
+enum { STATE_HEADER, STATE_STORED, STATE_CODES, STATE_DONE };
+
+static const short length_base[29] = {
+    3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+    31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const short length_extra[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
+                                       1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                       4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const short distance_base[30] = {
+    1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,
+    97,  129, 193, 257, 385, 513,  769,  1025, 1537, 2049, 3073, 4097, 6145,
+    8193, 12289, 16385, 24577};
+static const short distance_extra[30] = {0, 0, 0,  0,  1,  1,  2,  2,
+                                         3, 3, 4,  4,  5,  5,  6,  6,
+                                         7, 7, 8,  8,  9,  9,  10, 10,
+                                         11, 11, 12, 12, 13, 13};
+
+void taco_inflate_init_(taco_inflate *restrict s, taco_file *file,
+                        uint64_t size) {
+  memset(s, 0, offsetof(taco_inflate, window));
+  s->file = file;
+  s->remaining = size;
+  s->state = STATE_HEADER;
+}
+
+// Returns the next byte of input, or -1 past its end.
+static int next_byte(taco_inflate *s) {
+  if (s->input_head == s->input_size) {
+    size_t want = sizeof(s->input);
+    if (want > s->remaining)
+      want = s->remaining;
+    s->input_size = want ? taco_file_read_(s->file, s->input, want) : 0;
+    s->input_head = 0;
+    s->remaining -= s->input_size;
+    if (s->input_size == 0) {
+      s->error = true;
+      return -1;
+    }
+  }
+  return s->input[s->input_head++];
+}
+
+// Returns the next byte of a byte aligned block, taking whole bytes left in
+// the bit buffer by decode first.
+static int aligned_byte(taco_inflate *s) {
+  if (s->bit_count >= 8) {
+    int b = s->bits & 0xff;
+    s->bits >>= 8;
+    s->bit_count -= 8;
+    return b;
+  }
+  return next_byte(s);
+}
+
+static int get_bits(taco_inflate *s, int count) {
+  while (s->bit_count < count) {
+    int b = next_byte(s);
+    if (b < 0)
+      return 0;
+    s->bits |= (uint32_t)b << s->bit_count;
+    s->bit_count += 8;
+  }
+
+  int value = s->bits & ((1u << count) - 1);
+  s->bits >>= count;
+  s->bit_count -= count;
+  return value;
+}
+
+// Decodes a symbol, by table if input already read has enough bits for the
+// code, or else one bit at a time. Huffman codes are packed starting from
+// their most significant bit.
+static int decode(taco_inflate *s, const taco_huffman *h) {
+  while (s->bit_count <= 24 && s->input_head < s->input_size) {
+    s->bits |= (uint32_t)s->input[s->input_head++] << s->bit_count;
+    s->bit_count += 8;
+  }
+  if (s->bit_count >= FAST_BITS) {
+    int entry = h->fast[s->bits & ((1u << FAST_BITS) - 1)];
+    if (entry) {
+      s->bits >>= entry >> FAST_BITS;
+      s->bit_count -= entry >> FAST_BITS;
+      return entry & ((1u << FAST_BITS) - 1);
+    }
+  }
+
+  int code = 0, first = 0, index = 0;
+  for (int len = 1; len <= MAX_BITS; ++len) {
+    code |= get_bits(s, 1);
+    int count = h->count[len];
+    if (code - count < first)
+      return h->symbol[index + (code - first)];
+    index += count;
+    first = (first + count) << 1;
+    code <<= 1;
+  }
+  return -1;
+}
+
+// Builds a code from the code length of each symbol. Returns 0 for a
+// complete code, a positive number if incomplete, and -1 if
+// over-subscribed.
+static int construct(taco_huffman *h, const short *lengths, int n) {
+  memset(h->count, 0, sizeof(h->count));
+  memset(h->fast, 0, sizeof(h->fast));
+  for (int i = 0; i < n; ++i)
+    h->count[lengths[i]] += 1;
+  if (h->count[0] == n)
+    return 0;
+
+  int left = 1;
+  for (int len = 1; len <= MAX_BITS; ++len) {
+    left <<= 1;
+    left -= h->count[len];
+    if (left < 0)
+      return -1;
+  }
+
+  short offsets[MAX_BITS + 1];
+  offsets[1] = 0;
+  for (int len = 1; len < MAX_BITS; ++len)
+    offsets[len + 1] = offsets[len] + h->count[len];
+  for (int i = 0; i < n; ++i) {
+    if (lengths[i])
+      h->symbol[offsets[lengths[i]]++] = i;
+  }
+
+  int code = 0, index = 0;
+  for (int len = 1; len <= FAST_BITS; ++len) {
+    for (int i = 0; i < h->count[len]; ++i, ++code) {
+      int reversed = 0;
+      for (int bit = 0; bit < len; ++bit)
+        reversed |= (code >> bit & 1) << (len - 1 - bit);
+      uint16_t entry = len << FAST_BITS | h->symbol[index + i];
+      for (int j = reversed; j < 1 << FAST_BITS; j += 1 << len)
+        h->fast[j] = entry;
+    }
+    index += h->count[len];
+    code <<= 1;
+  }
+  return left;
+}
+
+static bool fixed(taco_inflate *s) {
+  short lengths[288];
+  int i = 0;
+  for (; i < 144; ++i)
+    lengths[i] = 8;
+  for (; i < 256; ++i)
+    lengths[i] = 9;
+  for (; i < 280; ++i)
+    lengths[i] = 7;
+  for (; i < 288; ++i)
+    lengths[i] = 8;
+  construct(&s->lengths, lengths, 288);
+
+  for (i = 0; i < 30; ++i)
+    lengths[i] = 5;
+  construct(&s->distances, lengths, 30);
+  return true;
+}
+
+static bool dynamic(taco_inflate *s) {
+  static const short order[19] = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                  11, 4,  12, 3, 13, 2, 14, 1, 15};
+  short lengths[320];
+
+  int nlen = get_bits(s, 5) + 257;
+  int ndist = get_bits(s, 5) + 1;
+  int ncode = get_bits(s, 4) + 4;
+  if (nlen > 286 || ndist > 30)
+    return false;
+
+  // code lengths are themselves Huffman coded
+  int i = 0;
+  for (; i < ncode; ++i)
+    lengths[order[i]] = get_bits(s, 3);
+  for (; i < 19; ++i)
+    lengths[order[i]] = 0;
+  if (construct(&s->lengths, lengths, 19) != 0)
+    return false;
+
+  for (i = 0; i < nlen + ndist && !s->error;) {
+    int symbol = decode(s, &s->lengths);
+    if (symbol < 0)
+      return false;
+    if (symbol < 16) {
+      lengths[i++] = symbol;
+      continue;
+    }
+
+    int len = 0, repeat;
+    if (symbol == 16) {
+      if (i == 0)
+        return false;
+      len = lengths[i - 1];
+      repeat = 3 + get_bits(s, 2);
+    } else if (symbol == 17) {
+      repeat = 3 + get_bits(s, 3);
+    } else {
+      repeat = 11 + get_bits(s, 7);
+    }
+    if (i + repeat > nlen + ndist)
+      return false;
+    while (repeat--)
+      lengths[i++] = len;
+  }
+
+  // the end of block code is required
+  if (s->error || lengths[256] == 0)
+    return false;
+
+  // incomplete codes are only allowed with a single code
+  int left = construct(&s->lengths, lengths, nlen);
+  if (left < 0 || (left > 0 && nlen - s->lengths.count[0] != 1))
+    return false;
+  left = construct(&s->distances, lengths + nlen, ndist);
+  if (left < 0 || (left > 0 && ndist - s->distances.count[0] != 1))
+    return false;
+  return true;
+}
+
+static bool header(taco_inflate *s) {
+  if (s->last) {
+    s->state = STATE_DONE;
+    return true;
+  }
+
+  s->last = get_bits(s, 1);
+  switch (get_bits(s, 2)) {
+  case 0: {
+    // stored blocks start on a byte boundary
+    get_bits(s, s->bit_count % 8);
+    int b[4];
+    for (int i = 0; i < 4; ++i) {
+      if ((b[i] = aligned_byte(s)) < 0)
+        return false;
+    }
+    s->stored = b[0] | b[1] << 8;
+    if ((uint32_t)(b[2] | b[3] << 8) != (~s->stored & 0xffff))
+      return false;
+    s->state = STATE_STORED;
+    return true;
+  }
+  case 1:
+    s->state = STATE_CODES;
+    return fixed(s);
+  case 2:
+    s->state = STATE_CODES;
+    return dynamic(s);
+  default:
+    return false;
+  }
+}
+
+// Decodes a length/distance pair following a length symbol.
+static bool match(taco_inflate *s, int symbol) {
+  symbol -= 257;
+  if (symbol >= 29)
+    return false;
+  s->length = length_base[symbol] + get_bits(s, length_extra[symbol]);
+
+  symbol = decode(s, &s->distances);
+  if (symbol < 0 || symbol >= 30)
+    return false;
+  s->distance = distance_base[symbol] + get_bits(s, distance_extra[symbol]);
+  return (uint64_t)s->distance <= s->total;
+}
+
+static void put(taco_inflate *s, char *dst, size_t *n, int byte) {
+  s->window[s->total & WINDOW_MASK] = byte;
+  s->total += 1;
+  dst[(*n)++] = byte;
+}
+
+size_t taco_inflate_read_(taco_inflate *restrict s, char *dst, size_t count) {
+  size_t n = 0;
+
+  while (n < count && !s->error) {
+    if (s->length) {
+      while (s->length && n < count) {
+        put(s, dst, &n, s->window[(s->total - s->distance) & WINDOW_MASK]);
+        s->length -= 1;
+      }
+    } else if (s->state == STATE_CODES) {
+      int symbol = decode(s, &s->lengths);
+      if (symbol < 0 || s->error)
+        s->error = true;
+      else if (symbol < 256)
+        put(s, dst, &n, symbol);
+      else if (symbol == 256)
+        s->state = STATE_HEADER;
+      else if (!match(s, symbol))
+        s->error = true;
+    } else if (s->state == STATE_STORED) {
+      if (s->stored == 0) {
+        s->state = STATE_HEADER;
+        continue;
+      }
+      int byte = aligned_byte(s);
+      if (byte >= 0)
+        put(s, dst, &n, byte);
+      s->stored -= 1;
+    } else if (s->state == STATE_HEADER) {
+      if (!header(s))
+        s->error = true;
+    } else {
+      break;
+    }
+  }
+
+  return n;
+}
+
+bool taco_inflate_done_(const taco_inflate *restrict s) {
+  if (s->state == STATE_DONE)
+    return true;
+  // the end of the last block, before looking for the next header
+  return s->last && s->length == 0 &&
+         (s->state == STATE_HEADER ||
+          (s->state == STATE_STORED && s->stored == 0));
+}
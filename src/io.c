@@ -13,8 +13,12 @@
 #include "alloc.h"
 #include "taco.h"
 #include <stdarg.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
+#include <string.h>
+
+#define BUFFER_SIZE 65536
 
 #ifdef TACO_HAS_FSEEKO_
 #define stdio_seek ((taco_seek_fn *)fseeko)
@@ -29,6 +33,15 @@ struct taco_file_ {
   void *stream;
   char *filename;
   const taco_io *callbacks;
+
+  // read-ahead; bytes from head to tail are yet to be read
+  char *buffer;
+  size_t buffer_size;
+  size_t block_size; // size of reads from the stream
+  size_t head;
+  size_t tail;
+  bool eof;
+  bool error; // the buffer could not grow; input would be cut short
 };
 
 static const taco_io stdio_owned_callbacks_ = {
@@ -38,6 +51,7 @@ static const taco_io stdio_owned_callbacks_ = {
     .seek = stdio_seek,
     .printf = (taco_printf_fn *)vfprintf,
     .close = (taco_close_fn *)fclose,
+    .error = (taco_error_fn *)ferror,
 };
 
 static const taco_io stdio_borrowed_callbacks_ = {
@@ -46,6 +60,7 @@ static const taco_io stdio_borrowed_callbacks_ = {
     .write = (taco_write_fn *)fwrite,
     .seek = stdio_seek,
     .printf = (taco_printf_fn *)vfprintf,
+    .error = (taco_error_fn *)ferror,
 };
 
 static const taco_io null_callbacks_ = {
@@ -58,10 +73,12 @@ taco_file *taco_file_open_(taco_allocator *alloc, void *stream,
   if (!f)
     return NULL;
 
+  memset(f, 0, sizeof(taco_file));
   f->alloc = alloc;
   f->stream = stream;
   f->filename = taco_strdup_(alloc, filename);
   f->callbacks = callbacks;
+  f->block_size = BUFFER_SIZE;
   return f;
 }
 
@@ -100,6 +117,7 @@ void taco_file_close_(taco_file *file) {
       file->callbacks->close)
     file->callbacks->close(file->stream);
 
+  taco_free_(file->alloc, file->buffer);
   taco_free_(file->alloc, file->filename);
   taco_free_(file->alloc, file);
 }
@@ -111,13 +129,80 @@ void taco_file_set_name_(taco_file *file, const char *filename) {
   file->filename = taco_strdup_(file->alloc, filename);
 }
 
-size_t taco_file_read_(taco_file *file, void *dst, size_t size) {
+void taco_file_set_block_size_(taco_file *file, size_t size) {
+  file->block_size = size;
+}
+
+static size_t read_stream(taco_file *file, void *dst, size_t size) {
   if (file->callbacks->version > offsetof(taco_io, read) &&
       file->callbacks->read)
     return file->callbacks->read(dst, 1, size, file->stream);
   return 0;
 }
 
+// Buffers at least want bytes unless the stream ends first. Every read from
+// the stream asks for all the space left in the buffer.
+static void fill(taco_file *file, size_t want) {
+  size_t buffered = file->tail - file->head;
+  if (buffered >= want || file->eof)
+    return;
+
+  size_t size = file->block_size > want ? file->block_size : want;
+  if (file->buffer_size < size) {
+    char *buffer = taco_realloc_at_(file->alloc, file->buffer, size,
+                                    TACO_ALLOC_SITE_IO);
+    if (!buffer) {
+      file->error = true;
+      return;
+    }
+    file->buffer = buffer;
+    file->buffer_size = size;
+  }
+
+  memmove(file->buffer, file->buffer + file->head, buffered);
+  file->head = 0;
+  file->tail = buffered;
+
+  while (file->tail < want) {
+    size_t count = read_stream(file, file->buffer + file->tail,
+                               file->buffer_size - file->tail);
+    if (count == 0) {
+      file->eof = true;
+      break;
+    }
+    file->tail += count;
+  }
+}
+
+const char *taco_file_peek_(taco_file *file, size_t want, size_t *size) {
+  fill(file, want ? want : 1);
+  *size = file->tail - file->head;
+  return file->buffer ? file->buffer + file->head : NULL;
+}
+
+void taco_file_consume_(taco_file *file, size_t size) {
+  size_t buffered = file->tail - file->head;
+  file->head += size < buffered ? size : buffered;
+}
+
+void taco_file_resume_(taco_file *file) { file->eof = false; }
+
+size_t taco_file_read_(taco_file *file, void *dst, size_t size) {
+  // reads as large as a block skip the buffer
+  if (file->head == file->tail && size >= file->block_size)
+    return read_stream(file, dst, size);
+
+  size_t available;
+  const char *src = taco_file_peek_(file, 1, &available);
+  if (size > available)
+    size = available;
+  if (size) {
+    memcpy(dst, src, size);
+    file->head += size;
+  }
+  return size;
+}
+
 size_t taco_file_write_(taco_file *file, const void *src, size_t size) {
   if (file->callbacks->version > offsetof(taco_io, write) &&
       file->callbacks->write)
@@ -145,14 +230,31 @@ int taco_file_vprintf_(taco_file *file, const char *format, va_list arg) {
   int len = vsnprintf(NULL, 0, format, ap_lencheck);
   va_end(ap_lencheck);
 
-  char *str = taco_malloc_(file->alloc, len + 1);
+  char *str =
+      taco_malloc_at_(file->alloc, len + 1, TACO_ALLOC_SITE_DIAGNOSTIC);
   vsnprintf(str, len + 1, format, arg);
   int result = taco_file_write_(file, str, len);
   taco_free_(file->alloc, str);
   return result;
 }
 
+bool taco_file_error_(const taco_file *file) {
+  if (file->error)
+    return true;
+  if (file->callbacks->version > offsetof(taco_io, error) &&
+      file->callbacks->error)
+    return file->callbacks->error(file->stream) != 0;
+  return false;
+}
+
 int taco_file_seek_(taco_file *file, uint64_t offset, int whence) {
+  // the stream is ahead of the reader by what is buffered
+  if (whence == SEEK_CUR)
+    offset -= file->tail - file->head;
+  file->head = 0;
+  file->tail = 0;
+  file->eof = false;
+
   if (file->callbacks->version > offsetof(taco_io, seek) &&
       file->callbacks->seek)
     return file->callbacks->seek(file->stream, offset, whence);
@@ -0,0 +1,366 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "alloc.h"
+#include "path.h"
+#include "score.h"
+#include "section.h"
+#include "taco.h"
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+// Events are consumed in order along the branch path being played. Control
+// events take effect as soon as every note before them is judged, so branch
+// conditions only ever see notes in front of their check. Each branch keeps
+// its own position and time cursor; both only move forward, so play costs
+// amortized constant time per event no matter how inputs are spread.
+
+struct taco_judge_ {
+  taco_allocator *alloc;
+  taco_path path;
+  taco_time_cursor cursors[3];
+  unsigned char *record; // branches taken at each jump
+  size_t record_size;
+
+  double good;
+  double ok;
+  double bad;
+  int base;
+  int bonus;
+
+  bool gogotime;
+  taco_branch_scoring weights;
+  int condition;
+
+  // current drum roll; type is 0 outside rolls
+  int roll_type;
+  double roll_checkpoint; // NAN if there is none
+  int roll_hits;
+  int roll_required;
+
+  int score;
+  int combo;
+  int max_combo;
+  int counts[TACO_JUDGE_MAX];
+};
+
+static const double windows[2][3] = {
+    {0.0417, 0.1084, 0.125}, // Easy and Normal
+    {0.025, 0.075, 0.1084},  // Hard and Oni
+};
+
+taco_judge *taco_judge_create(const taco_course *restrict course, int side) {
+  return taco_judge_create2(course, side, &taco_default_allocator_);
+}
+
+taco_judge *taco_judge_create2(const taco_course *restrict course, int side,
+                               taco_allocator *alloc) {
+  if (!course)
+    return NULL;
+
+  const taco_section *sections[3];
+  for (int b = 0; b < 3; ++b) {
+    sections[b] = taco_course_get_branch(course, side, b);
+    if (!sections[b])
+      return NULL;
+  }
+
+  taco_judge *j = taco_malloc_(alloc, sizeof(taco_judge));
+  if (!j)
+    return NULL;
+
+  memset(j, 0, sizeof(taco_judge));
+  j->alloc = alloc;
+  taco_path_init_(&j->path, sections, NULL, 0);
+
+  const double *w = windows[taco_course_class(course) % 4 >= TACO_CLASS_HARD];
+  j->good = w[0];
+  j->ok = w[1];
+  j->bad = w[2];
+
+  taco_score score;
+  if (taco_section_score(sections[TACO_BRANCH_MASTER], course,
+                         TACO_RULES_DEFAULT, &score) == 0) {
+    j->base = score.base;
+    j->bonus = score.bonus;
+  }
+
+  taco_judge_reset(j);
+  return j;
+}
+
+void taco_judge_free(taco_judge *judge) {
+  if (judge)
+    taco_free_(judge->alloc, judge);
+}
+
+void taco_judge_reset(taco_judge *judge) {
+  taco_path_rewind(&judge->path);
+  for (int b = 0; b < 3; ++b)
+    taco_time_cursor_init_(&judge->cursors[b], judge->path.sections[b]);
+
+  judge->gogotime = false;
+  memset(&judge->weights, 0, sizeof(taco_branch_scoring));
+  judge->condition = 0;
+  judge->roll_type = 0;
+
+  judge->score = 0;
+  judge->combo = 0;
+  judge->max_combo = 0;
+  memset(judge->counts, 0, sizeof(judge->counts));
+}
+
+int taco_judge_set_windows(taco_judge *restrict judge, double good, double ok,
+                           double bad) {
+  if (!(good >= 0 && ok >= good && bad >= ok))
+    return -1;
+
+  judge->good = good;
+  judge->ok = ok;
+  judge->bad = bad;
+  return 0;
+}
+
+void taco_judge_set_path(taco_judge *restrict judge,
+                         unsigned char *restrict path, size_t size) {
+  judge->record = path;
+  judge->record_size = path ? size : 0;
+}
+
+int taco_judge_set_score(taco_judge *restrict judge, int base, int bonus) {
+  if (base < 0 || bonus < 0)
+    return -1;
+
+  judge->base = base;
+  judge->bonus = bonus;
+  return 0;
+}
+
+static const taco_event *front(const taco_judge *j) {
+  return taco_path_peek_(&j->path);
+}
+
+static void consume(taco_judge *j) { taco_path_next(&j->path); }
+
+static double seconds_of(taco_judge *j, const taco_event *e) {
+  return taco_time_cursor_seconds_(&j->cursors[j->path.branch], e);
+}
+
+static bool is_balloon(int type) {
+  return type == TACO_EVENT_BALLOON || type == TACO_EVENT_KUSUDAMA;
+}
+
+static void control(taco_judge *j, const taco_event *e) {
+  int advanced, master;
+
+  switch (taco_event_type(e)) {
+  case TACO_EVENT_GOGOSTART:
+    j->gogotime = true;
+    break;
+  case TACO_EVENT_GOGOEND:
+    j->gogotime = false;
+    break;
+  case TACO_EVENT_BRANCH_START:
+    taco_event_branch_scoring(e, &j->weights);
+    j->condition = 0;
+    break;
+  case TACO_EVENT_BRANCH_CHECK:
+    taco_event_branch_thresholds(e, &advanced, &master);
+    if (j->condition >= master)
+      taco_path_choose_(&j->path, TACO_BRANCH_MASTER);
+    else if (j->condition >= advanced)
+      taco_path_choose_(&j->path, TACO_BRANCH_ADVANCED);
+    else
+      taco_path_choose_(&j->path, TACO_BRANCH_NORMAL);
+    break;
+  case TACO_EVENT_BRANCH_JUMP:
+    // the path has already jumped
+    if (j->path.jumps <= j->record_size)
+      j->record[j->path.jumps - 1] = j->path.branch;
+    break;
+  }
+}
+
+// Starts a drum roll. Rolls cut short by anything other than a checkpoint
+// have no defined end, and are skipped like score computations do.
+static void start_roll(taco_judge *j, const taco_event *e) {
+  const taco_section *s = j->path.sections[j->path.branch];
+  const taco_event *end = taco_section_end(s);
+
+  j->roll_checkpoint = NAN;
+  for (const taco_event *i = taco_event_next(e); i != end;
+       i = taco_event_next(i)) {
+    int type = taco_event_type(i);
+    if (type <= 0)
+      continue;
+    if (type == TACO_EVENT_ROLL_CHECKPOINT) {
+      if (isnan(j->roll_checkpoint))
+        j->roll_checkpoint = taco_event_seconds(i, s);
+      continue;
+    }
+    if (type == TACO_EVENT_ROLL_END) {
+      j->roll_type = taco_event_type(e);
+      j->roll_hits = 0;
+      j->roll_required = taco_event_hits(e) > 0 ? taco_event_hits(e) : 1;
+    }
+    break;
+  }
+}
+
+static void judge_note(taco_judge *j, int type, int judgement) {
+  bool big = type == TACO_EVENT_DON_BIG || type == TACO_EVENT_KAT_BIG;
+  j->counts[judgement] += 1;
+
+  if (judgement == TACO_JUDGE_BAD) {
+    j->combo = 0;
+    j->condition += j->weights.bad;
+    return;
+  }
+
+  j->combo += 1;
+  if (j->combo > j->max_combo)
+    j->max_combo = j->combo;
+
+  int points = taco_score_note_(j->combo, j->gogotime, j->base, j->bonus);
+  if (judgement == TACO_JUDGE_OK) {
+    points = points / 20 * 10; // halved, rounded down to 10 points
+    j->condition += big ? j->weights.ok_big : j->weights.ok;
+  } else {
+    j->condition += big ? j->weights.good_big : j->weights.good;
+  }
+  j->score += big ? points * 2 : points;
+}
+
+void taco_judge_advance(taco_judge *restrict judge, double seconds) {
+  const taco_event *e;
+  while ((e = front(judge))) {
+    int type = taco_event_type(e);
+
+    if (type <= 0) {
+      consume(judge);
+      control(judge, e);
+      continue;
+    }
+
+    double time = seconds_of(judge, e);
+    switch (type) {
+    case TACO_EVENT_DON:
+    case TACO_EVENT_KAT:
+    case TACO_EVENT_DON_BIG:
+    case TACO_EVENT_KAT_BIG:
+      if (!(seconds > time + judge->bad))
+        return;
+      judge_note(judge, type, TACO_JUDGE_BAD);
+      break;
+    case TACO_EVENT_ROLL:
+    case TACO_EVENT_ROLL_BIG:
+    case TACO_EVENT_BALLOON:
+    case TACO_EVENT_KUSUDAMA:
+      if (!(seconds >= time))
+        return;
+      start_roll(judge, e);
+      break;
+    case TACO_EVENT_ROLL_END:
+      // hits right on the end still count
+      if (!(seconds > time))
+        return;
+      judge->roll_type = 0;
+      break;
+    case TACO_EVENT_ROLL_CHECKPOINT:
+      if (!(seconds >= time))
+        return;
+      break;
+    default:
+      // not judged
+      break;
+    }
+    consume(judge);
+  }
+}
+
+static int hit_roll(taco_judge *j, double seconds, int input) {
+  if (is_balloon(j->roll_type)) {
+    if (input != TACO_INPUT_DON || j->roll_hits >= j->roll_required)
+      return TACO_JUDGE_NONE;
+  }
+
+  j->roll_hits += 1;
+  j->condition += j->weights.roll;
+
+  if (!is_balloon(j->roll_type)) {
+    j->counts[TACO_JUDGE_ROLL] += 1;
+    j->score += j->roll_type == TACO_EVENT_ROLL_BIG ? TACO_SCORE_ROLL_BIG_
+                                                    : TACO_SCORE_ROLL_;
+    return TACO_JUDGE_ROLL;
+  }
+
+  if (j->roll_hits < j->roll_required) {
+    j->counts[TACO_JUDGE_ROLL] += 1;
+    j->score += TACO_SCORE_BALLOON_;
+    return TACO_JUDGE_ROLL;
+  }
+
+  // popping a kusudama after its checkpoint gives less
+  bool late =
+      j->roll_type == TACO_EVENT_KUSUDAMA && seconds > j->roll_checkpoint;
+  j->counts[TACO_JUDGE_POP] += 1;
+  j->score += late ? TACO_SCORE_POP_LATE_ : TACO_SCORE_POP_;
+  return TACO_JUDGE_POP;
+}
+
+int taco_judge_hit(taco_judge *restrict judge, double seconds, int input) {
+  if (isnan(seconds) ||
+      (input != TACO_INPUT_DON && input != TACO_INPUT_KAT))
+    return TACO_JUDGE_NONE;
+
+  taco_judge_advance(judge, seconds);
+  if (judge->roll_type)
+    return hit_roll(judge, seconds, input);
+
+  const taco_event *e = front(judge);
+  if (!e || !taco_event_is_normal_note(e))
+    return TACO_JUDGE_NONE;
+
+  double offset = fabs(seconds - seconds_of(judge, e));
+  if (offset > judge->bad)
+    return TACO_JUDGE_NONE;
+
+  int type = taco_event_type(e);
+  bool don = type == TACO_EVENT_DON || type == TACO_EVENT_DON_BIG;
+  int judgement;
+  if (don != (input == TACO_INPUT_DON) || offset > judge->ok)
+    judgement = TACO_JUDGE_BAD;
+  else if (offset > judge->good)
+    judgement = TACO_JUDGE_OK;
+  else
+    judgement = TACO_JUDGE_GOOD;
+
+  consume(judge);
+  judge_note(judge, type, judgement);
+  return judgement;
+}
+
+void taco_judge_finish(taco_judge *restrict judge) {
+  taco_judge_advance(judge, INFINITY);
+}
+
+int taco_judge_score(const taco_judge *restrict judge) { return judge->score; }
+
+int taco_judge_combo(const taco_judge *restrict judge) { return judge->combo; }
+
+int taco_judge_max_combo(const taco_judge *restrict judge) {
+  return judge->max_combo;
+}
+
+int taco_judge_count(const taco_judge *restrict judge, int judgement) {
+  if (judgement < 0 || judgement >= TACO_JUDGE_MAX)
+    return 0;
+  return judge->counts[judgement];
+}
+
+int taco_judge_branch(const taco_judge *restrict judge) {
+  return judge->path.branch;
+}
+
+size_t taco_judge_jumps(const taco_judge *restrict judge) {
+  return judge->path.jumps;
+}
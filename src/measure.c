@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "measure.h"
+
+#include "taco.h"
+
+int taco_measure_time(const taco_measure *restrict m) { return m->ticks; }
+
+double taco_measure_seconds(const taco_measure *restrict m) {
+  return m->seconds;
+}
+
+int taco_measure_length(const taco_measure *restrict m) { return m->length; }
+
+size_t taco_measure_first_event(const taco_measure *restrict m) {
+  return m->first;
+}
+
+double taco_measure_bpm(const taco_measure *restrict m) { return m->bpm; }
+
+int taco_measure_scroll(const taco_measure *restrict m, double *restrict x,
+                        double *restrict y) {
+  if (!x || !y)
+    return -1;
+
+  *x = m->scroll_x;
+  *y = m->scroll_y;
+  return 0;
+}
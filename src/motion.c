@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "motion.h"
+
+#include "note.h"
+#include "section.h"
+#include "taco.h"
+#include <math.h>
+
+#define SQRT1_2 0.70710678118654752440
+
+// where notes come from, as unit vectors with y pointing up
+static const float directions[8][2] = {
+    [TACO_DIRECTION_RIGHT] = {1, 0},
+    [TACO_DIRECTION_TOP] = {0, 1},
+    [TACO_DIRECTION_BOTTOM] = {0, -1},
+    [TACO_DIRECTION_TOP_RIGHT] = {SQRT1_2, SQRT1_2},
+    [TACO_DIRECTION_BOTTOM_RIGHT] = {SQRT1_2, -SQRT1_2},
+    [TACO_DIRECTION_LEFT] = {-1, 0},
+    [TACO_DIRECTION_BOTTOM_LEFT] = {-SQRT1_2, -SQRT1_2},
+    [TACO_DIRECTION_TOP_LEFT] = {-SQRT1_2, SQRT1_2},
+};
+
+void taco_motion_state_init_(taco_motion_state *restrict st) {
+  st->bpm = TACO_DEFAULT_BPM_;
+  st->scroll_x = 1;
+  st->scroll_y = 0;
+  st->direction = TACO_DIRECTION_RIGHT;
+  st->appear = INFINITY;
+  st->move = INFINITY;
+}
+
+void taco_motion_state_update_(taco_motion_state *restrict st,
+                               const taco_event *restrict i) {
+  switch (i->type) {
+  case TACO_EVENT_BPM:
+    st->bpm = i->detail_float.value;
+    break;
+  case TACO_EVENT_SCROLL:
+    st->scroll_x = i->detail_float.value;
+    st->scroll_y = 0;
+    break;
+  case TACO_EVENT_SCROLL_COMPLEX:
+    st->scroll_x = i->scroll_complex.x;
+    st->scroll_y = i->scroll_complex.y;
+    break;
+  case TACO_EVENT_DIRECTION:
+    st->direction = i->detail_int.value < 8 ? i->detail_int.value : 0;
+    break;
+  case TACO_EVENT_SUDDEN:
+    st->appear = i->sudden.appear > 0 ? i->sudden.appear : INFINITY;
+    st->move = i->sudden.appear > 0 ? i->sudden.move : INFINITY;
+    break;
+  }
+}
+
+void taco_motion_state_vector_(const taco_motion_state *restrict st,
+                               bool scrolled, double *restrict x,
+                               double *restrict y) {
+  // the direction turns the scroll speed as a complex number
+  const float *d = directions[st->direction];
+  double scroll_x = scrolled ? st->scroll_x : 1;
+  double scroll_y = scrolled ? st->scroll_y : 0;
+  *x = scroll_x * d[0] - scroll_y * d[1];
+  *y = scroll_x * d[1] + scroll_y * d[0];
+}
+
+void taco_motion_compute_(const taco_event *restrict events, size_t count,
+                          taco_motion_entry *restrict motions) {
+  taco_motion_state st;
+  taco_motion_state_init_(&st);
+
+  for (size_t n = 0; n < count; ++n) {
+    taco_motion_state_update_(&st, &events[n]);
+
+    // a 4/4 measure takes 240 / bpm seconds to pass
+    double speed = st.bpm / 240;
+    double x, y;
+    taco_motion_state_vector_(&st, true, &x, &y);
+    taco_motion_entry *m = &motions[n];
+    m->x = speed * x;
+    m->y = speed * y;
+    m->appear = st.appear;
+    m->move = st.move;
+  }
+}
+
+int taco_motion_offset(const taco_motion *restrict m, double seconds,
+                       double *restrict x, double *restrict y) {
+  if (!x || !y || seconds > m->appear)
+    return -1;
+
+  if (seconds > m->move)
+    seconds = m->move;
+  *x = m->x * seconds;
+  *y = m->y * seconds;
+  return 0;
+}
+
+int taco_scroll_position(const taco_scroll *restrict scroll, size_t index,
+                         double progress, double *restrict x,
+                         double *restrict y) {
+  if (index >= scroll->count || !x || !y)
+    return -1;
+
+  double d = scroll->anchor[index] - progress;
+  if (d > scroll->appear[index])
+    return -1;
+  if (d > scroll->move[index])
+    d = scroll->move[index];
+  *x = scroll->x[index] * d;
+  *y = scroll->y[index] * d;
+  return 0;
+}
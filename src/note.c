@@ -18,6 +18,7 @@ int taco_event_detail_int(const taco_event *event) {
   case TACO_EVENT_BALLOON:         // hits required
   case TACO_EVENT_KUSUDAMA:        // hits required
   case TACO_EVENT_LANDMINE:        // annotation
+  case TACO_EVENT_DIRECTION:       // direction notes come from
   case TACO_EVENT_TJA_BRANCH_TYPE: // branch type
     return event->detail_int.value;
   default:
@@ -49,11 +50,38 @@ int taco_event_scroll(const taco_event *restrict event, double *restrict x,
   case TACO_EVENT_SCROLL_COMPLEX:
     *x = event->scroll_complex.x;
     *y = event->scroll_complex.y;
+    return 0;
   default:
     return -1;
   }
 }
 
+int taco_event_sudden(const taco_event *restrict event,
+                      double *restrict appear, double *restrict move) {
+  if (event->type != TACO_EVENT_SUDDEN || !appear || !move)
+    return -1;
+
+  if (event->sudden.appear <= 0) {
+    *appear = INFINITY;
+    *move = INFINITY;
+  } else {
+    *appear = event->sudden.appear;
+    *move = event->sudden.move;
+  }
+  return 0;
+}
+
+int taco_event_jposscroll(const taco_event *restrict event,
+                          double *restrict seconds,
+                          double *restrict distance) {
+  if (event->type != TACO_EVENT_JPOSSCROLL || !seconds || !distance)
+    return -1;
+
+  *seconds = event->jposscroll.seconds;
+  *distance = event->jposscroll.distance;
+  return 0;
+}
+
 int taco_event_branch_scoring(const taco_event *restrict event,
                               taco_branch_scoring *restrict scoring) {
   if (event->type != TACO_EVENT_BRANCH_START)
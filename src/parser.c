@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: BSD-2-Clause
 #include "parser.h"
 #include "alloc.h"
+#include "archive.h"
 #include "courseset.h"
 #include "io.h"
 #include "taco.h"
@@ -59,13 +60,70 @@ taco_courseset *taco_parser_parse_stdio(taco_parser *restrict parser,
   return result;
 }
 
+taco_courseset *taco_parser_parse_archive(taco_parser *restrict parser,
+                                          taco_archive *restrict archive,
+                                          size_t index) {
+  taco_file *f = taco_archive_open_entry_(archive, index);
+  if (!f)
+    return NULL;
+
+  taco_courseset *result = parser->vtable->parse(parser->parser, f);
+  post_parse_cleanup_(result, f);
+  return result;
+}
+
 int taco_parser_set_error_stdio(taco_parser *restrict parser, FILE *file) {
-  taco_file *f;
+  // without a stream, diagnostics are dropped before being formatted
+  taco_file *f = NULL;
   if (file) {
     f = taco_file_open_stdio_(file);
-  } else {
-    f = taco_file_open_null_(parser->alloc);
+    if (!f)
+      return -1;
   }
 
   return parser->vtable->set_error(parser->parser, f);
 }
+
+int taco_parser_feed(taco_parser *restrict parser, const void *restrict bytes,
+                     size_t size) {
+  if (!parser->vtable->feed)
+    return -1;
+  return parser->vtable->feed(parser->parser, bytes, size);
+}
+
+int taco_parser_step(taco_parser *restrict parser, uint64_t budget) {
+  if (!parser->vtable->step)
+    return 0;
+  return parser->vtable->step(parser->parser, budget);
+}
+
+taco_courseset *taco_parser_finish(taco_parser *restrict parser) {
+  if (!parser->vtable->finish)
+    return NULL;
+  return parser->vtable->finish(parser->parser);
+}
+
+int taco_parser_set_timing(taco_parser *restrict parser, int timing) {
+  if (!parser->vtable->set_timing)
+    return -1;
+  return parser->vtable->set_timing(parser->parser, timing);
+}
+
+int taco_parser_set_diagnostics(taco_parser *restrict parser,
+                                taco_diagnostic_fn *callback, void *data) {
+  if (!parser->vtable->set_diagnostics)
+    return -1;
+  return parser->vtable->set_diagnostics(parser->parser, callback, data);
+}
+
+int taco_parser_set_severity(taco_parser *restrict parser, int severity) {
+  if (!parser->vtable->set_severity)
+    return -1;
+  return parser->vtable->set_severity(parser->parser, severity);
+}
+
+int taco_parser_set_sources(taco_parser *restrict parser, int track) {
+  if (!parser->vtable->set_sources)
+    return -1;
+  return parser->vtable->set_sources(parser->parser, track);
+}
@@ -0,0 +1,295 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "path.h"
+
+#include "alloc.h"
+#include "course.h"
+#include "section.h"
+#include "taco.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+void taco_path_init_(taco_path *restrict p,
+                     const taco_section *const sections[3],
+                     const unsigned char *branches, size_t count) {
+  memset(p, 0, sizeof(taco_path));
+  memcpy(p->sections, sections, sizeof(p->sections));
+  p->branches = branches;
+  p->count = count;
+  taco_path_rewind(p);
+}
+
+taco_path *taco_path_create(const taco_course *restrict course, int side,
+                            const unsigned char *restrict branches,
+                            size_t count) {
+  taco_allocator *a =
+      course ? taco_course_allocator_(course) : &taco_default_allocator_;
+  return taco_path_create2(course, side, branches, count, a);
+}
+
+taco_path *taco_path_create2(const taco_course *restrict course, int side,
+                             const unsigned char *restrict branches,
+                             size_t count, taco_allocator *alloc) {
+  if (!course || (count && !branches))
+    return NULL;
+
+  const taco_section *sections[3];
+  for (int b = 0; b < 3; ++b) {
+    sections[b] = taco_course_get_branch(course, side, b);
+    if (!sections[b])
+      return NULL;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    if (branches[i] > TACO_BRANCH_MASTER)
+      return NULL;
+  }
+
+  taco_path *p = taco_malloc_(alloc, sizeof(taco_path));
+  unsigned char *copy = taco_malloc_(alloc, count ? count : 1);
+  if (!p || !copy) {
+    taco_free_(alloc, p);
+    taco_free_(alloc, copy);
+    return NULL;
+  }
+
+  if (count)
+    memcpy(copy, branches, count);
+  taco_path_init_(p, sections, copy, count);
+  p->alloc = alloc;
+  p->course = course;
+  return p;
+}
+
+void taco_path_free(taco_path *path) {
+  if (path && path->alloc) {
+    taco_free_(path->alloc, (unsigned char *)path->branches);
+    taco_free_(path->alloc, path);
+  }
+}
+
+void taco_path_rewind(taco_path *restrict path) {
+  for (int b = 0; b < 3; ++b)
+    path->next[b] = taco_section_begin(path->sections[b]);
+  path->branch = TACO_BRANCH_NORMAL;
+  path->last = TACO_BRANCH_NORMAL;
+  path->target = TACO_BRANCH_NORMAL;
+  path->jumps = 0;
+}
+
+void taco_path_choose_(taco_path *restrict p, int branch) {
+  p->target = branch;
+}
+
+const taco_event *taco_path_peek_(const taco_path *restrict p) {
+  const taco_event *e = p->next[p->branch];
+  return e != taco_section_end(p->sections[p->branch]) ? e : NULL;
+}
+
+static void jump(taco_path *p, const taco_event *e) {
+  int to = p->jumps < p->count ? p->branches[p->jumps] : p->target;
+  p->jumps += 1;
+  if (to == p->branch)
+    return;
+
+  if (p->sections[to] == p->sections[p->branch]) {
+    p->next[to] = p->next[p->branch];
+  } else {
+    const taco_event *i = p->next[to];
+    const taco_event *end = taco_section_end(p->sections[to]);
+    while (i != end && taco_event_compare(i, e) <= 0)
+      i = taco_event_next(i);
+    p->next[to] = i;
+  }
+  p->branch = to;
+}
+
+const taco_event *taco_path_next(taco_path *restrict path) {
+  const taco_event *e = taco_path_peek_(path);
+  if (!e)
+    return NULL;
+
+  path->next[path->branch] = taco_event_next(e);
+  path->last = path->branch;
+  if (taco_event_type(e) == TACO_EVENT_BRANCH_JUMP)
+    jump(path, e);
+  return e;
+}
+
+const taco_section *taco_path_section(const taco_path *restrict path) {
+  return path->sections[path->last];
+}
+
+int taco_path_branch(const taco_path *restrict path) { return path->last; }
+
+size_t taco_path_jumps(const taco_path *restrict path) { return path->jumps; }
+
+typedef struct walk_ walk;
+
+// Enumerates paths depth first. Each decision replays the path up to it,
+// so this is exponential in the number of jumps; it is meant for listing
+// paths, not for finding the best one.
+struct walk_ {
+  taco_path *path;
+  unsigned char *branches;
+  size_t jumps;
+  int rules;
+  taco_path_fn *fn;
+  void *data;
+};
+
+typedef struct condition_ condition;
+
+// Range of a branch condition reachable by playing differently.
+struct condition_ {
+  taco_branch_scoring weights;
+  int64_t min;
+  int64_t max;
+  bool checked;
+  int advanced;
+  int master;
+};
+
+static int64_t min3(int64_t a, int64_t b, int64_t c) {
+  int64_t m = a < b ? a : b;
+  return m < c ? m : c;
+}
+
+static int64_t max3(int64_t a, int64_t b, int64_t c) {
+  int64_t m = a > b ? a : b;
+  return m > c ? m : c;
+}
+
+static void accumulate(condition *c, const taco_event *e) {
+  const taco_branch_scoring *w = &c->weights;
+  int64_t roll_max;
+
+  switch (taco_event_type(e)) {
+  case TACO_EVENT_BRANCH_START:
+    taco_event_branch_scoring(e, &c->weights);
+    c->min = 0;
+    c->max = 0;
+    c->checked = false;
+    break;
+  case TACO_EVENT_BRANCH_CHECK:
+    taco_event_branch_thresholds(e, &c->advanced, &c->master);
+    c->checked = true;
+    break;
+  case TACO_EVENT_DON:
+  case TACO_EVENT_KAT:
+    c->min += min3(w->good, w->ok, w->bad);
+    c->max += max3(w->good, w->ok, w->bad);
+    break;
+  case TACO_EVENT_DON_BIG:
+  case TACO_EVENT_KAT_BIG:
+    c->min += min3(w->good_big, w->ok_big, w->bad);
+    c->max += max3(w->good_big, w->ok_big, w->bad);
+    break;
+  case TACO_EVENT_ROLL:
+  case TACO_EVENT_ROLL_BIG:
+  case TACO_EVENT_BALLOON:
+  case TACO_EVENT_KUSUDAMA:
+    // drum rolls take any number of hits; balloons take up to their count
+    roll_max = taco_event_type(e) >= TACO_EVENT_BALLOON
+                   ? taco_event_hits(e)
+                   : INT32_MAX;
+    if (w->roll > 0)
+      c->max += roll_max * w->roll;
+    else
+      c->min += roll_max * w->roll;
+    break;
+  }
+}
+
+int taco_path_reachable_(const taco_event *begin, const taco_event *end,
+                         int previous) {
+  condition c;
+  memset(&c, 0, sizeof(condition));
+
+  for (const taco_event *i = begin; i != end; i = taco_event_next(i)) {
+    if (taco_event_type(i) == TACO_EVENT_BRANCH_JUMP)
+      break;
+    if (!c.checked || taco_event_type(i) == TACO_EVENT_BRANCH_START)
+      accumulate(&c, i);
+  }
+
+  // without a check, the previous decision stands
+  if (!c.checked)
+    return 1 << previous;
+
+  int result = 0;
+  if (c.max >= c.master)
+    result |= 1 << TACO_BRANCH_MASTER;
+  if (c.max >= c.advanced && c.min < c.master && c.advanced < c.master)
+    result |= 1 << TACO_BRANCH_ADVANCED;
+  if (c.min < c.advanced && c.min < c.master)
+    result |= 1 << TACO_BRANCH_NORMAL;
+  return result;
+}
+
+static int enumerate(walk *w, size_t depth) {
+  taco_path *p = w->path;
+
+  if (depth == w->jumps) {
+    taco_score score;
+    p->branches = w->branches;
+    p->count = depth;
+    taco_path_score(p, w->rules, &score);
+    return w->fn(w->branches, depth, &score, w->data);
+  }
+
+  // follow the decisions so far up to the last one
+  p->branches = w->branches;
+  p->count = depth;
+  taco_path_rewind(p);
+  while (p->jumps < depth && taco_path_next(p))
+    continue;
+
+  int previous = depth ? w->branches[depth - 1] : TACO_BRANCH_NORMAL;
+  int branches =
+      taco_path_reachable_(p->next[p->branch],
+                           taco_section_end(p->sections[p->branch]), previous);
+  for (int b = 0; b < 3; ++b) {
+    if (!(branches & (1 << b)))
+      continue;
+    w->branches[depth] = b;
+    int result = enumerate(w, depth + 1);
+    if (result)
+      return result;
+  }
+  return 0;
+}
+
+int taco_course_foreach_path(const taco_course *restrict course, int side,
+                             int rules, taco_path_fn *fn, void *data) {
+  if (!course || !fn || rules < 0 || rules >= TACO_RULES_MAX)
+    return -1;
+
+  const taco_section *sections[3];
+  for (int b = 0; b < 3; ++b) {
+    sections[b] = taco_course_get_branch(course, side, b);
+    if (!sections[b])
+      return -1;
+  }
+
+  // every branch jumps at the same times
+  size_t jumps = 0;
+  taco_section_foreach(i, sections[TACO_BRANCH_NORMAL]) {
+    if (taco_event_type(i) == TACO_EVENT_BRANCH_JUMP)
+      jumps += 1;
+  }
+
+  taco_allocator *a = taco_course_allocator_(course);
+  unsigned char *branches = taco_malloc_(a, jumps ? jumps : 1);
+  if (!branches)
+    return -1;
+
+  taco_path p;
+  taco_path_init_(&p, sections, NULL, 0);
+  p.course = course;
+
+  walk w = {&p, branches, jumps, rules, fn, data};
+  int result = enumerate(&w, 0);
+
+  taco_free_(a, branches);
+  return result;
+}
@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "alloc.h"
+#include "taco.h"
+#include "thread.h"
+#include <math.h>
+
+typedef struct batch_ batch;
+
+// Replays are claimed one at a time; each worker keeps one judge for all of
+// its replays, so sections and their timing caches are only ever read.
+struct batch_ {
+  const taco_course *course;
+  int side;
+  taco_replay *replays;
+  size_t count;
+  atomic_size_t next;
+};
+
+static void replay(taco_judge *j, taco_replay *r) {
+  taco_judge_reset(j);
+  taco_judge_set_path(j, r->path, r->path_size);
+
+  r->valid = 1;
+  double last = -INFINITY;
+  for (size_t i = 0; i < r->count; ++i) {
+    const taco_hit *h = &r->hits[i];
+    if (!(h->seconds >= last) || isinf(h->seconds) ||
+        (h->input != TACO_INPUT_DON && h->input != TACO_INPUT_KAT)) {
+      r->valid = 0;
+      continue;
+    }
+    last = h->seconds;
+    taco_judge_hit(j, h->seconds, h->input);
+  }
+  taco_judge_finish(j);
+
+  r->score = taco_judge_score(j);
+  r->max_combo = taco_judge_max_combo(j);
+  for (int k = 0; k < TACO_JUDGE_MAX; ++k)
+    r->counts[k] = taco_judge_count(j, k);
+  r->jumps = taco_judge_jumps(j);
+}
+
+static void work(void *data) {
+  batch *b = data;
+  taco_judge *j = taco_judge_create(b->course, b->side);
+  if (!j)
+    return;
+
+  size_t i;
+  while ((i = taco_claim_job_(&b->next)) < b->count)
+    replay(j, &b->replays[i]);
+
+  taco_judge_free(j);
+}
+
+int taco_replay_validate(const taco_course *restrict course, int side,
+                         taco_replay *restrict replays, size_t count,
+                         int threads) {
+  if (!course || !taco_course_get_branch(course, side, TACO_BRANCH_NORMAL))
+    return -1;
+  if (count == 0)
+    return 0;
+
+  if (threads <= 0)
+    threads = taco_cpu_count_();
+  if ((size_t)threads > count)
+    threads = count;
+
+  batch b = {course, side, replays, count, 0};
+  if (threads == 1)
+    work(&b);
+  else if (taco_run_workers_(&taco_default_allocator_, threads, work, &b) != 0)
+    return -1;
+
+  // a worker without a judge leaves its share to the others
+  return atomic_load(&b.next) >= count ? 0 : -1;
+}
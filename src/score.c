@@ -0,0 +1,633 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "path.h"
+#include "score.h"
+#include "section.h"
+#include "taco.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// All rules are computed in one sweep. Rules differ in which events start
+// drum rolls and in how a roll is cut short, so each family keeps its own
+// roll tracker; note scores are bucketed so ceilings can be computed once
+// base and bonus scores are known.
+
+typedef struct roll_info_ roll_info;
+typedef struct tracker_ tracker;
+
+// Drum roll contributions under ac15 style rules.
+struct roll_info_ {
+  double small;
+  double big;
+  double unbreakable;
+  int balloon_hits;
+  int breaks;
+  int late_breaks;
+};
+
+struct tracker_ {
+  // how the tracker treats rolls
+  bool plain_rolls;  // whether (big) drum rolls are tracked
+  bool ac16;         // ac16 roll handling; otherwise ac15
+  double roll_start; // NAN outside rolls
+  double roll_checkpoint;
+  int roll_type;
+  int hits;
+
+  int combo;
+  int units;  // ac15 score units
+  int weight; // notes, big notes counting twice
+
+  roll_info rolls;
+  double roll_time; // ac16 only
+  int balloon_hits; // ac16 only
+};
+
+static const int score_targets[10][4] = {
+    {300000, 400000, 550000, 700000},  // Lv.1
+    {320000, 450000, 600000, 750000},  // Lv.2
+    {340000, 500000, 650000, 800000},  // Lv.3
+    {360000, 550000, 700000, 850000},  // Lv.4
+    {380000, 600000, 750000, 900000},  // Lv.5
+    {380000, 650000, 800000, 950000},  // Lv.6
+    {380000, 700000, 850000, 1000000}, // Lv.7
+    {380000, 700000, 900000, 1050000}, // Lv.8
+    {380000, 700000, 900000, 1100000}, // Lv.9
+    {380000, 700000, 900000, 1200000}, // Lv.10+
+};
+
+static const double ac16_roll_rates[8] = {7.0, 8.5, 11.0, 17.0,
+                                          7.0, 8.5, 11.0, 17.0};
+
+static int roll_hits(double duration, double roll_rate) {
+  return ceil(duration * roll_rate);
+}
+
+// combo brackets of 10, up to 100
+static int combo_bracket(int combo) {
+  if (combo < 0)
+    return 0;
+  if (combo >= 100)
+    return 10;
+  return combo / 10;
+}
+
+static int note_units(int combo, int gogotime) {
+  static const int table[2][11] = {
+      {20, 25, 25, 30, 30, 40, 40, 40, 40, 40, 60},
+      {24, 30, 30, 36, 36, 48, 48, 48, 48, 48, 72},
+  };
+  return table[gogotime ? 1 : 0][combo_bracket(combo)];
+}
+
+static int note_bonus(int bracket) {
+  static const int table[11] = {0, 1, 1, 2, 2, 4, 4, 4, 4, 4, 8};
+  return table[bracket];
+}
+
+static int note_score(int bracket, int gogotime, int base, int bonus) {
+  int raw = base + bonus * note_bonus(bracket);
+  if (gogotime)
+    raw = floor(raw * 1.2);
+  return floor(raw / 10.0) * 10;
+}
+
+int taco_score_note_(int combo, int gogotime, int base, int bonus) {
+  return note_score(combo_bracket(combo), gogotime, base, bonus);
+}
+
+static bool is_note(int type) {
+  return type == TACO_EVENT_DON || type == TACO_EVENT_KAT ||
+         type == TACO_EVENT_DON_BIG || type == TACO_EVENT_KAT_BIG;
+}
+
+static bool is_big(int type) {
+  return type == TACO_EVENT_DON_BIG || type == TACO_EVENT_KAT_BIG;
+}
+
+static void process_roll(roll_info *info, int type, double length, int hits,
+                         double checkpoint) {
+  if (type == TACO_EVENT_KUSUDAMA) {
+    if (isnan(checkpoint) || checkpoint > length)
+      checkpoint = length;
+
+    if (roll_hits(checkpoint, 20) >= hits) {
+      info->balloon_hits += hits - 1;
+      info->breaks += 1;
+    } else if (roll_hits(length, 20) >= hits) {
+      info->balloon_hits += hits - 1;
+      info->late_breaks += 1;
+    } else {
+      info->unbreakable += length;
+    }
+  } else if (type == TACO_EVENT_BALLOON) {
+    if (roll_hits(length, 20) >= hits) {
+      info->balloon_hits += hits - 1;
+      info->breaks += 1;
+    } else {
+      info->unbreakable += length;
+    }
+  } else if (type == TACO_EVENT_ROLL_BIG) {
+    info->big += length;
+  } else if (type == TACO_EVENT_ROLL) {
+    info->small += length;
+  }
+}
+
+// Handles an event inside a roll. Returns whether the event is consumed.
+static bool track_roll(tracker *t, int type, double seconds) {
+  double length = seconds - t->roll_start;
+
+  if (t->ac16) {
+    switch (type) {
+    case TACO_EVENT_ROLL_END:
+      // balloons are treated as normal rolls if too hard
+      if (t->roll_type == TACO_EVENT_ROLL || roll_hits(length, 20) < t->hits)
+        t->roll_time += length;
+      else
+        t->balloon_hits += t->hits;
+      t->roll_start = NAN;
+      break;
+    case TACO_EVENT_ROLL_CHECKPOINT:
+      break;
+    default:
+      // any roll without a specified end is discarded as invalid
+      t->roll_start = NAN;
+      break;
+    }
+    // the event may start something new
+    return !isnan(t->roll_start);
+  }
+
+  switch (type) {
+  case TACO_EVENT_ROLL_END:
+    process_roll(&t->rolls, t->roll_type, length, t->hits,
+                 seconds - t->roll_checkpoint);
+    t->roll_start = NAN;
+    t->roll_checkpoint = NAN;
+    break;
+  case TACO_EVENT_ROLL_CHECKPOINT:
+    t->roll_checkpoint = seconds;
+    /* FALLTHROUGH */
+  default:
+    // any roll without a specified end is discarded as invalid
+    t->roll_start = NAN;
+    break;
+  }
+  return true;
+}
+
+static void track(tracker *t, const taco_event *e, int type, int gogotime,
+                  double seconds) {
+  if (!isnan(t->roll_start) && track_roll(t, type, seconds))
+    return;
+
+  if (is_note(type)) {
+    int weight = is_big(type) ? 2 : 1;
+    t->combo += 1;
+    t->units += note_units(t->combo, gogotime) * weight;
+    t->weight += weight;
+    return;
+  }
+
+  switch (type) {
+  case TACO_EVENT_BALLOON:
+  case TACO_EVENT_KUSUDAMA:
+    t->hits = taco_event_hits(e);
+    break;
+  case TACO_EVENT_ROLL_BIG:
+  case TACO_EVENT_ROLL:
+    if (!t->plain_rolls)
+      return;
+    break;
+  default:
+    return;
+  }
+
+  t->roll_type = type;
+  t->roll_start = seconds;
+}
+
+// Removes roll contributions from a target score.
+static int roll_target(int target, const roll_info *r) {
+  target -= roll_hits(r->small, 15) * TACO_SCORE_ROLL_;
+  target -= roll_hits(r->big, 15) * TACO_SCORE_ROLL_BIG_;
+  target -=
+      (r->balloon_hits + roll_hits(r->unbreakable, 15)) * TACO_SCORE_BALLOON_;
+  target -= r->breaks * TACO_SCORE_POP_;
+  target -= r->late_breaks * TACO_SCORE_POP_LATE_;
+  return target;
+}
+
+static int roll_bonus(const roll_info *r) {
+  return r->balloon_hits * TACO_SCORE_BALLOON_ + r->breaks * TACO_SCORE_POP_ +
+         r->late_breaks * TACO_SCORE_POP_LATE_;
+}
+
+typedef struct sweep_ sweep;
+
+struct sweep_ {
+  tracker ac15;     // ac15 and ac15s
+  tracker existing; // rules using scores from the course
+  tracker ac16;
+  int notes[11][2][2]; // by combo bracket, gogotime and size
+};
+
+static int ceiling(const sweep *s, int base, int bonus, const roll_info *r) {
+  int score = 0;
+  for (int c = 0; c < 11; ++c) {
+    for (int g = 0; g < 2; ++g) {
+      int points = note_score(c, g, base, bonus);
+      score += s->notes[c][g][0] * points + s->notes[c][g][1] * points * 2;
+    }
+  }
+  return score + roll_bonus(r);
+}
+
+static void score_ac15(const sweep *s, const taco_course *c,
+                       taco_score *result) {
+  int level = taco_course_level(c) - 1;
+  if (level < 0)
+    level = 0;
+  if (level > 9)
+    level = 9;
+
+  const tracker *t = &s->ac15;
+  int target = score_targets[level][taco_course_class(c) % 4];
+  target = roll_target(target, &t->rolls);
+  // 10000 points are given every 100 combo
+  target -= (t->combo / 100) * 10000;
+
+  double unit = t->units ? target / (double)t->units : 0;
+  result->base = ceil((unit * 20) / 10) * 10;
+  result->bonus = ceil(unit * 5);
+  result->ceiling = ceiling(s, result->base, result->bonus, &t->rolls);
+  result->combo = t->combo;
+}
+
+static void score_ac15s(const sweep *s, taco_score *result) {
+  const tracker *t = &s->ac15;
+  int target = roll_target(1000000, &t->rolls);
+
+  result->base =
+      t->weight ? ceil(((double)target / t->weight) / 10.0) * 10.0 : 0;
+  result->bonus = 0;
+  result->combo = t->combo;
+  result->ceiling = result->base * t->weight + roll_bonus(&t->rolls);
+}
+
+static void score_ac16(const sweep *s, const taco_course *c,
+                       taco_score *result) {
+  const tracker *t = &s->ac16;
+  int cls = taco_course_class(c);
+
+  // rolls are worth 100 pts each
+  int target = 1000000;
+  target -= (roll_hits(t->roll_time, ac16_roll_rates[cls]) + t->balloon_hits) *
+            100;
+
+  int units = t->combo;
+  result->base = units ? ceil(((double)target / units) / 10.0) * 10.0 : 0;
+  result->bonus = 0;
+  result->ceiling = result->base * units + t->balloon_hits * 100;
+  result->combo = units;
+}
+
+static void score_existing(const sweep *s, int base, int bonus,
+                           taco_score *result) {
+  result->base = base;
+  result->bonus = bonus;
+  result->ceiling = ceiling(s, base, bonus, &s->existing.rolls);
+  result->combo = s->existing.combo;
+}
+
+static void score_path(taco_path *restrict path,
+                       const taco_course *restrict course,
+                       taco_score *restrict results) {
+  sweep s;
+  memset(&s, 0, sizeof(sweep));
+  tracker *trackers[3] = {&s.ac15, &s.existing, &s.ac16};
+  for (int i = 0; i < 3; ++i) {
+    trackers[i]->roll_start = NAN;
+    trackers[i]->roll_checkpoint = NAN;
+  }
+  s.ac15.plain_rolls = true;
+  s.ac16.plain_rolls = true;
+  s.ac16.ac16 = true;
+
+  taco_time_cursor cursors[3];
+  for (int b = 0; b < 3; ++b)
+    taco_time_cursor_init_(&cursors[b], path->sections[b]);
+  int gogotime = 0;
+  int combo = 0;
+
+  const taco_event *i;
+  while ((i = taco_path_next(path))) {
+    int type = taco_event_type(i);
+
+    if (type == TACO_EVENT_GOGOSTART)
+      gogotime = 1;
+    else if (type == TACO_EVENT_GOGOEND)
+      gogotime = 0;
+
+    if (type <= 0)
+      continue;
+
+    // ceilings count every note, even ones cutting rolls short
+    if (is_note(type)) {
+      combo += 1;
+      s.notes[combo_bracket(combo)][gogotime][is_big(type)] += 1;
+    }
+
+    double seconds = is_note(type)
+                         ? NAN
+                         : taco_time_cursor_seconds_(&cursors[path->last], i);
+    for (int t = 0; t < 3; ++t)
+      track(trackers[t], i, type, gogotime, seconds);
+  }
+
+  score_ac15(&s, course, &results[TACO_RULES_AC15]);
+  score_ac15s(&s, &results[TACO_RULES_AC15S]);
+  score_ac16(&s, course, &results[TACO_RULES_AC16]);
+
+  int base = taco_course_score_base(course);
+  int bonus = taco_course_score_bonus(course);
+  if (base <= 0 || bonus <= 0)
+    results[TACO_RULES_DEFAULT] = results[TACO_RULES_AC15];
+  else
+    score_existing(&s, base, bonus, &results[TACO_RULES_DEFAULT]);
+
+  if (taco_course_score_tournament(course) > 0)
+    score_existing(&s, taco_course_score_tournament(course), 0,
+                   &results[TACO_RULES_SHINUCHI]);
+  else if (base > 0 && bonus <= 0)
+    score_existing(&s, base, 0, &results[TACO_RULES_SHINUCHI]);
+  else
+    results[TACO_RULES_SHINUCHI] = results[TACO_RULES_AC15S];
+}
+
+int taco_section_score_all(const taco_section *restrict section,
+                           const taco_course *restrict course,
+                           taco_score *restrict results) {
+  if (!section || !course)
+    return -1;
+
+  taco_path path;
+  const taco_section *sections[3] = {section, section, section};
+  taco_path_init_(&path, sections, NULL, 0);
+  score_path(&path, course, results);
+  return 0;
+}
+
+int taco_section_score(const taco_section *restrict section,
+                       const taco_course *restrict course, int rules,
+                       taco_score *restrict result) {
+  if (rules < 0 || rules >= TACO_RULES_MAX)
+    return -1;
+
+  taco_score results[TACO_RULES_MAX];
+  if (taco_section_score_all(section, course, results) != 0)
+    return -1;
+  *result = results[rules];
+  return 0;
+}
+
+int taco_path_score(taco_path *restrict path, int rules,
+                    taco_score *restrict result) {
+  if (!path->course || rules < 0 || rules >= TACO_RULES_MAX)
+    return -1;
+
+  taco_score results[TACO_RULES_MAX];
+  taco_path_rewind(path);
+  score_path(path, path->course, results);
+  taco_path_rewind(path);
+  *result = results[rules];
+  return 0;
+}
+
+// Ceilings over every branch path are found segment by segment, a segment
+// being the events of one branch up to the next jump. Paths only differ in
+// the branch played in each segment and in their combo, and combos past 100
+// all score the same, so there are few states between segments and the work
+// stays linear in the course length. Each segment is walked once for all of
+// its states; under rules where combo does not count, all paths share one.
+
+#define COMBO_STATES 101
+
+typedef struct valuation_ valuation;
+typedef struct path_state_ path_state;
+typedef struct segment_ segment;
+
+// How notes and rolls are valued once scoring parameters are known.
+struct valuation_ {
+  int kind;         // TACO_RULES_AC15, AC15S or AC16 style
+  int table[11][2]; // by combo bracket and gogotime, ac15 style only
+  int base;
+  tracker rolls; // template for tracking rolls
+};
+
+// Lowest and highest ceilings among paths reaching a state.
+struct path_state_ {
+  int64_t min;
+  int64_t max;
+  double paths; // 0 if unreachable
+};
+
+static void valuation_init(valuation *v, const taco_course *c, int rules,
+                           const taco_score *results) {
+  memset(v, 0, sizeof(valuation));
+  v->rolls.roll_start = NAN;
+  v->rolls.roll_checkpoint = NAN;
+  v->base = results[rules].base;
+  int bonus = results[rules].bonus;
+
+  // course scores are ac15 style scores with other parameters
+  bool existing = false;
+  if (rules == TACO_RULES_DEFAULT) {
+    existing =
+        taco_course_score_base(c) > 0 && taco_course_score_bonus(c) > 0;
+    rules = TACO_RULES_AC15;
+  } else if (rules == TACO_RULES_SHINUCHI) {
+    existing = taco_course_score_tournament(c) > 0 ||
+               (taco_course_score_base(c) > 0 &&
+                taco_course_score_bonus(c) <= 0);
+    rules = existing ? TACO_RULES_AC15 : TACO_RULES_AC15S;
+  }
+
+  v->kind = rules;
+  v->rolls.plain_rolls = !existing;
+  v->rolls.ac16 = rules == TACO_RULES_AC16;
+  for (int b = 0; b < 11; ++b) {
+    for (int g = 0; g < 2; ++g)
+      v->table[b][g] = note_score(b, g, v->base, bonus);
+  }
+}
+
+// Gets the end of the segment starting at an event.
+static const taco_event *segment_end(const taco_event *begin,
+                                     const taco_event *end) {
+  for (const taco_event *i = begin; i != end; i = taco_event_next(i)) {
+    if (taco_event_type(i) == TACO_EVENT_BRANCH_JUMP)
+      return taco_event_next(i);
+  }
+  return end;
+}
+
+// A segment walked once, so it can be valued from every combo and gogotime
+// state. Only the first notes of a segment can have combos short of 100.
+struct segment_ {
+  int64_t rolls; // these do not depend on combo
+  int64_t flat;  // notes, under rules where combo does not count
+  int notes;
+  int gogotime; // at the end, or -1 if kept from the start
+  int head;
+  signed char weight[COMBO_STATES - 1];
+  signed char gogo[COMBO_STATES - 1]; // -1 if kept from the start
+  int64_t tail[2]; // notes past the head, by starting gogotime
+};
+
+static void segment_walk(segment *seg, const valuation *v,
+                         taco_time_cursor *cursor, const taco_event *begin,
+                         const taco_event *end) {
+  memset(seg, 0, sizeof(segment));
+  seg->gogotime = -1;
+  tracker t = v->rolls;
+  for (const taco_event *i = begin; i != end; i = taco_event_next(i)) {
+    int type = taco_event_type(i);
+    if (type == TACO_EVENT_GOGOSTART)
+      seg->gogotime = 1;
+    else if (type == TACO_EVENT_GOGOEND)
+      seg->gogotime = 0;
+    if (type <= 0)
+      continue;
+    // notes may cut rolls short
+    double seconds =
+        is_note(type) ? NAN : taco_time_cursor_seconds_(cursor, i);
+    track(&t, i, type, 0, seconds);
+    if (!is_note(type))
+      continue;
+
+    int weight = is_big(type) ? 2 : 1;
+    seg->flat += v->kind == TACO_RULES_AC15S ? v->base * weight : v->base;
+    if (seg->head < COMBO_STATES - 1) {
+      seg->weight[seg->head] = weight;
+      seg->gogo[seg->head++] = seg->gogotime;
+    } else {
+      for (int g = 0; g < 2; ++g) {
+        int gogotime = seg->gogotime < 0 ? g : seg->gogotime;
+        seg->tail[g] += v->table[10][gogotime] * weight;
+      }
+    }
+    seg->notes += 1;
+  }
+
+  if (v->kind == TACO_RULES_AC16)
+    seg->rolls = (int64_t)t.balloon_hits * 100;
+  else
+    seg->rolls = roll_bonus(&t.rolls);
+}
+
+// Gets points from a segment played from a state, updating the state.
+static int64_t segment_value(const segment *seg, const valuation *v,
+                             int *combo, int *gogotime) {
+  if (v->kind != TACO_RULES_AC15)
+    return seg->rolls + seg->flat;
+
+  int64_t score = seg->rolls + seg->tail[*gogotime];
+  for (int k = 0; k < seg->head; ++k) {
+    int c = *combo + k + 1;
+    int g = seg->gogo[k] < 0 ? *gogotime : seg->gogo[k];
+    score += v->table[combo_bracket(c)][g] * seg->weight[k];
+  }
+
+  *combo += seg->notes;
+  if (*combo > COMBO_STATES - 1)
+    *combo = COMBO_STATES - 1;
+  if (seg->gogotime >= 0)
+    *gogotime = seg->gogotime;
+  return score;
+}
+
+static void merge(path_state *s, const path_state *from, int64_t gained) {
+  if (s->paths == 0 || from->min + gained < s->min)
+    s->min = from->min + gained;
+  if (s->paths == 0 || from->max + gained > s->max)
+    s->max = from->max + gained;
+  s->paths += from->paths;
+}
+
+int taco_course_ceilings(const taco_course *restrict course, int side,
+                         int rules, taco_ceilings *restrict result) {
+  if (!course || rules < 0 || rules >= TACO_RULES_MAX)
+    return -1;
+
+  const taco_section *sections[3];
+  const taco_event *pos[3];
+  taco_time_cursor cursors[3];
+  for (int b = 0; b < 3; ++b) {
+    sections[b] = taco_course_get_branch(course, side, b);
+    if (!sections[b])
+      return -1;
+    pos[b] = taco_section_begin(sections[b]);
+    taco_time_cursor_init_(&cursors[b], sections[b]);
+  }
+
+  // scoring parameters are those of the master branch
+  taco_score results[TACO_RULES_MAX];
+  taco_section_score_all(sections[TACO_BRANCH_MASTER], course, results);
+  valuation v;
+  valuation_init(&v, course, rules, results);
+
+  path_state dp[3][COMBO_STATES][2], next[3][COMBO_STATES][2];
+  memset(dp, 0, sizeof(dp));
+  dp[TACO_BRANCH_NORMAL][0][0].paths = 1;
+
+  path_state final;
+  memset(&final, 0, sizeof(path_state));
+
+  bool done = false;
+  while (!done) {
+    memset(next, 0, sizeof(next));
+    done = true;
+
+    for (int b = 0; b < 3; ++b) {
+      const taco_event *end = taco_section_end(sections[b]);
+      const taco_event *seg = segment_end(pos[b], end);
+      // branches jump at the same times; the last segment ends all of them
+      bool last = seg == end;
+      done = done && last;
+
+      int targets = last ? 0 : taco_path_reachable_(pos[b], end, b);
+      segment summary;
+      bool walked = false;
+
+      for (int c = 0; c < COMBO_STATES; ++c) {
+        for (int g = 0; g < 2; ++g) {
+          const path_state *s = &dp[b][c][g];
+          if (s->paths == 0)
+            continue;
+          if (!walked)
+            segment_walk(&summary, &v, &cursors[b], pos[b], seg);
+          walked = true;
+
+          int combo = c, gogotime = g;
+          int64_t gained = segment_value(&summary, &v, &combo, &gogotime);
+          if (last)
+            merge(&final, s, gained);
+          for (int t = 0; t < 3; ++t) {
+            if (targets & (1 << t))
+              merge(&next[t][combo][gogotime], s, gained);
+          }
+        }
+      }
+      pos[b] = seg;
+    }
+    memcpy(dp, next, sizeof(dp));
+  }
+
+  result->min = final.min;
+  result->max = final.max;
+  result->paths = final.paths;
+  return 0;
+}
@@ -2,23 +2,39 @@
 #include "section.h"
 
 #include "alloc.h"
+#include "fingerprint.h"
+#include "measure.h"
+#include "motion.h"
 #include "note.h" /* IWYU pragma: keep; struct size taken */
 #include "taco.h"
 #include <assert.h>
 #include <limits.h>
 #include <math.h>
+#include <stdbool.h>
 #include <stdatomic.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #define INITIAL_CAPACITY (4096 / sizeof(taco_event))
 
+// caches, as bits of taco_section.stale
+enum {
+  CACHE_SECONDS = 1,
+  CACHE_MEASURES = 2,
+  CACHE_MOTIONS = 4,
+  CACHE_SCROLL = 8,
+  CACHE_FINGERPRINT = 16,
+  CACHE_ALL = 31,
+};
+
 typedef struct bpm_entry_ bpm_entry;
 
 struct bpm_entry_ {
   int ticks;
   float bpm;
+  double whole; // position in whole notes
   double time;
 };
 
@@ -31,9 +47,36 @@ struct taco_section_ {
 
   bpm_entry *bpm_times;
   size_t time_events;
+
+  taco_measure *measures;
+  size_t measure_count;
+
+  // motion of each event under Taiko scrolling; NULL until cached
+  taco_motion_entry *motions;
+  // scroll curves of drawn events under a scroll mode; NULL until cached
+  taco_scroll_cache *scroll;
+
+  // gameplay hashes
+  uint64_t fingerprint;
+  taco_sketch sketch;
+
+  // caches not matching the events; every change to events marks all of
+  // them, and they are freed or rebuilt when next cached
+  unsigned stale;
+
+  // exact positions parallel to events; NULL unless tracked
+  taco_position *positions;
+  // locations in the input parallel to events; NULL unless tracked
+  taco_source *sources;
 };
 
-static inline void invalidate_bpm_times_(taco_section *restrict s);
+static inline void invalidate_caches_(taco_section *restrict s) {
+  s->stale = CACHE_ALL;
+}
+
+static inline bool current_(const taco_section *restrict s, unsigned cache) {
+  return !(s->stale & cache);
+}
 
 taco_section *taco_section_create_(void) {
   return taco_section_create2_(&taco_default_allocator_);
@@ -41,7 +84,8 @@ taco_section *taco_section_create_(void) {
 
 taco_section *taco_section_create2_(taco_allocator *a) {
   taco_section *section = taco_malloc_(a, sizeof(taco_section));
-  taco_event *events = taco_malloc_(a, INITIAL_CAPACITY * sizeof(taco_event));
+  taco_event *events = taco_malloc_at_(a, INITIAL_CAPACITY * sizeof(taco_event),
+                                       TACO_ALLOC_SITE_SECTION);
 
   if (!section || !events) {
     taco_free_(a, section);
@@ -57,13 +101,21 @@ taco_section *taco_section_create2_(taco_allocator *a) {
   section->tickrate = 96;
   section->bpm_times = NULL;
   section->time_events = 0;
+  section->measures = NULL;
+  section->measure_count = 0;
+  section->motions = NULL;
+  section->scroll = NULL;
+  section->stale = CACHE_ALL;
+  section->positions = NULL;
+  section->sources = NULL;
   return section;
 }
 
 taco_section *taco_section_clone_(const taco_section *restrict other) {
   taco_allocator *a = other->alloc;
   taco_section *section = taco_malloc_(a, sizeof(taco_section));
-  taco_event *events = taco_malloc_(a, other->capacity * sizeof(taco_event));
+  taco_event *events = taco_malloc_at_(a, other->capacity * sizeof(taco_event),
+                                       TACO_ALLOC_SITE_SECTION);
 
   if (!section || !events) {
     taco_free_(a, section);
@@ -73,6 +125,31 @@ taco_section *taco_section_clone_(const taco_section *restrict other) {
 
   memcpy(events, other->events, other->size * sizeof(taco_event));
 
+  taco_position *positions = NULL;
+  if (other->positions) {
+    positions = taco_malloc_at_(a, other->capacity * sizeof(taco_position),
+                                TACO_ALLOC_SITE_SECTION);
+    if (!positions) {
+      taco_free_(a, section);
+      taco_free_(a, events);
+      return NULL;
+    }
+    memcpy(positions, other->positions, other->size * sizeof(taco_position));
+  }
+
+  taco_source *sources = NULL;
+  if (other->sources) {
+    sources = taco_malloc_at_(a, other->capacity * sizeof(taco_source),
+                              TACO_ALLOC_SITE_SECTION);
+    if (!sources) {
+      taco_free_(a, section);
+      taco_free_(a, events);
+      taco_free_(a, positions);
+      return NULL;
+    }
+    memcpy(sources, other->sources, other->size * sizeof(taco_source));
+  }
+
   memset(section, 0, sizeof(taco_section));
   section->alloc = a;
   section->events = events;
@@ -81,6 +158,13 @@ taco_section *taco_section_clone_(const taco_section *restrict other) {
   section->tickrate = other->tickrate;
   section->bpm_times = NULL;
   section->time_events = 0;
+  section->measures = NULL;
+  section->measure_count = 0;
+  section->motions = NULL;
+  section->scroll = NULL;
+  section->stale = CACHE_ALL;
+  section->positions = positions;
+  section->sources = sources;
   return section;
 }
 
@@ -88,6 +172,11 @@ void taco_section_free_(taco_section *section) {
   if (section) {
     taco_free_(section->alloc, section->events);
     taco_free_(section->alloc, section->bpm_times);
+    taco_free_(section->alloc, section->measures);
+    taco_free_(section->alloc, section->motions);
+    taco_free_(section->alloc, section->scroll);
+    taco_free_(section->alloc, section->positions);
+    taco_free_(section->alloc, section->sources);
     taco_free_(section->alloc, section);
   }
 }
@@ -99,9 +188,14 @@ int taco_section_tickrate(const taco_section *restrict s) {
 }
 
 void taco_section_set_tickrate_(taco_section *restrict s, int tickrate) {
+  invalidate_caches_(s);
   s->tickrate = tickrate;
 }
 
+taco_allocator *taco_section_allocator_(const taco_section *restrict s) {
+  return s->alloc;
+}
+
 const taco_event *taco_section_begin(const taco_section *restrict s) {
   return s->events;
 }
@@ -118,17 +212,17 @@ const taco_event *taco_section_locate(const taco_section *restrict s,
 }
 
 taco_event *taco_section_begin_mut_(taco_section *restrict s) {
-  invalidate_bpm_times_(s);
+  invalidate_caches_(s);
   return s->events;
 }
 
 taco_event *taco_section_end_mut_(taco_section *restrict s) {
-  invalidate_bpm_times_(s);
+  invalidate_caches_(s);
   return s->events + s->size;
 }
 
 taco_event *taco_section_locate_mut_(taco_section *restrict s, size_t i) {
-  invalidate_bpm_times_(s);
+  invalidate_caches_(s);
   return s->events + i;
 }
 
@@ -152,8 +246,26 @@ static taco_event *reserve(taco_section *restrict s, size_t count) {
   }
 
   /* realloc */
+  if (s->positions) {
+    taco_position *positions =
+        taco_realloc_at_(s->alloc, s->positions, newcap * sizeof(taco_position),
+                         TACO_ALLOC_SITE_SECTION);
+    if (!positions)
+      return NULL;
+    s->positions = positions;
+  }
+  if (s->sources) {
+    taco_source *sources =
+        taco_realloc_at_(s->alloc, s->sources, newcap * sizeof(taco_source),
+                         TACO_ALLOC_SITE_SECTION);
+    if (!sources)
+      return NULL;
+    s->sources = sources;
+  }
+
   taco_event *events =
-      taco_realloc_(s->alloc, s->events, newcap * sizeof(taco_event));
+      taco_realloc_at_(s->alloc, s->events, newcap * sizeof(taco_event),
+                       TACO_ALLOC_SITE_SECTION);
   if (!events)
     return NULL;
 
@@ -165,8 +277,26 @@ static taco_event *reserve(taco_section *restrict s, size_t count) {
 
 int taco_section_trim_(taco_section *restrict s) {
   size_t size = s->size < INITIAL_CAPACITY ? INITIAL_CAPACITY : s->size;
+  if (s->positions) {
+    taco_position *positions =
+        taco_realloc_at_(s->alloc, s->positions, size * sizeof(taco_position),
+                         TACO_ALLOC_SITE_SECTION);
+    if (!positions)
+      return -1;
+    s->positions = positions;
+  }
+  if (s->sources) {
+    taco_source *sources =
+        taco_realloc_at_(s->alloc, s->sources, size * sizeof(taco_source),
+                         TACO_ALLOC_SITE_SECTION);
+    if (!sources)
+      return -1;
+    s->sources = sources;
+  }
+
   taco_event *events =
-      taco_realloc_(s->alloc, s->events, size * sizeof(taco_event));
+      taco_realloc_at_(s->alloc, s->events, size * sizeof(taco_event),
+                       TACO_ALLOC_SITE_SECTION);
   if (!events)
     return -1;
 
@@ -175,37 +305,293 @@ int taco_section_trim_(taco_section *restrict s) {
   return 0;
 }
 
+// mark positions and sources of newly added events as unknown
+static void forget_positions_(taco_section *restrict s, const taco_event *start,
+                              size_t count) {
+  if (s->positions)
+    memset(s->positions + (start - s->events), 0,
+           count * sizeof(taco_position));
+  if (s->sources)
+    memset(s->sources + (start - s->events), 0, count * sizeof(taco_source));
+}
+
 int taco_section_push_(taco_section *restrict s,
                        const taco_event *restrict event) {
-  invalidate_bpm_times_(s);
+  invalidate_caches_(s);
   taco_event *start = reserve(s, 1);
   if (!start)
     return -1;
 
   memcpy(start, event, sizeof(*event));
+  forget_positions_(s, start, 1);
   return 0;
 }
 
 extern int taco_section_push_many_(taco_section *restrict s,
                                    const taco_event *restrict events,
                                    size_t count) {
-  invalidate_bpm_times_(s);
+  invalidate_caches_(s);
   taco_event *start = reserve(s, count);
   if (!start)
     return -1;
 
   memcpy(start, events, count * sizeof(taco_event));
+  forget_positions_(s, start, count);
   return 0;
 }
 
 int taco_section_concat_(taco_section *restrict s,
                          const taco_section *restrict other) {
-  invalidate_bpm_times_(s);
-  return taco_section_push_many_(s, other->events, other->size);
+  size_t oldsize = s->size;
+  if (taco_section_push_many_(s, other->events, other->size) != 0)
+    return -1;
+
+  if (s->positions && other->positions)
+    memcpy(s->positions + oldsize, other->positions,
+           other->size * sizeof(taco_position));
+  if (s->sources && other->sources)
+    memcpy(s->sources + oldsize, other->sources,
+           other->size * sizeof(taco_source));
+  return 0;
+}
+
+int taco_section_track_positions_(taco_section *restrict s) {
+  if (s->positions)
+    return 0;
+
+  taco_position *positions =
+      taco_malloc_at_(s->alloc, s->capacity * sizeof(taco_position),
+                      TACO_ALLOC_SITE_SECTION);
+  if (!positions)
+    return -1;
+
+  memset(positions, 0, s->capacity * sizeof(taco_position));
+  invalidate_caches_(s);
+  s->positions = positions;
+  return 0;
+}
+
+taco_position *taco_section_positions_mut_(taco_section *restrict s) {
+  invalidate_caches_(s);
+  return s->positions;
+}
+
+int taco_section_track_sources_(taco_section *restrict s, bool track) {
+  if (!track) {
+    taco_free_(s->alloc, s->sources);
+    s->sources = NULL;
+    return 0;
+  }
+  if (s->sources)
+    return 0;
+
+  taco_source *sources = taco_malloc_at_(
+      s->alloc, s->capacity * sizeof(taco_source), TACO_ALLOC_SITE_SECTION);
+  if (!sources)
+    return -1;
+
+  memset(sources, 0, s->capacity * sizeof(taco_source));
+  s->sources = sources;
+  return 0;
+}
+
+taco_source *taco_section_sources_mut_(taco_section *restrict s) {
+  return s->sources;
+}
+
+void taco_section_set_last_source_(taco_section *restrict s,
+                                   const taco_source *restrict source) {
+  if (s->sources && s->size != 0)
+    s->sources[s->size - 1] = *source;
+}
+
+int taco_event_source(const taco_event *restrict e,
+                      const taco_section *restrict s,
+                      uint64_t *restrict offset, int *restrict line,
+                      int *restrict column) {
+  if (!s->sources || e < s->events || e >= s->events + s->size)
+    return -1;
+
+  const taco_source *source = &s->sources[e - s->events];
+  if (source->line == 0)
+    return -1;
+
+  if (offset)
+    *offset = source->offset;
+  if (line)
+    *line = source->line;
+  if (column)
+    *column = source->column;
+  return 0;
+}
+
+typedef struct sort_entry_ sort_entry;
+
+struct sort_entry_ {
+  taco_event event;
+  taco_position position;
+  taco_source source;
+};
+
+static int compare_positions_(const taco_position *a, const taco_position *b) {
+  int result = (a->measure > b->measure) - (a->measure < b->measure);
+  if (result == 0) {
+    uint64_t x = (uint64_t)a->num * b->den;
+    uint64_t y = (uint64_t)b->num * a->den;
+    result = (x > y) - (x < y);
+  }
+  return result;
+}
+
+// Compare two events, but none events always compare greater than others.
+static int compare_events_(const taco_event *a, const taco_event *b) {
+  int result = (a->type == TACO_EVENT_NONE) - (b->type == TACO_EVENT_NONE);
+  if (result == 0)
+    result = taco_event_compare(a, b);
+  return result;
+}
+
+static int compare_entries_(const sort_entry *a, const sort_entry *b) {
+  int result =
+      (a->event.type == TACO_EVENT_NONE) - (b->event.type == TACO_EVENT_NONE);
+  if (result == 0)
+    result = compare_positions_(&a->position, &b->position);
+  if (result == 0)
+    result = taco_event_compare(&a->event, &b->event);
+  return result;
+}
+
+static int compare_barlines_(const taco_event *const *a,
+                             const taco_event *const *b) {
+  return ((*a)->time > (*b)->time) - ((*a)->time < (*b)->time);
+}
+
+static uint32_t gcd_(uint32_t x, uint32_t y) {
+  while (y != 0) {
+    uint32_t z = y;
+    y = x % y;
+    x = z;
+  }
+  return x;
+}
+
+// Derive unknown positions from time in ticks, relative to real barlines
+// with known positions.
+static int resolve_positions_(taco_section *restrict s) {
+  size_t count = 0;
+  for (size_t n = 0; n < s->size; ++n) {
+    const taco_event *i = &s->events[n];
+    if (i->type == TACO_EVENT_MEASURE && i->measure.real &&
+        s->positions[n].den != 0)
+      count += 1;
+  }
+
+  const taco_event **barlines = NULL;
+  if (count != 0) {
+    barlines = taco_malloc_(s->alloc, count * sizeof(taco_event *));
+    if (!barlines)
+      return -1;
+  }
+
+  const taco_event **b = barlines;
+  for (size_t n = 0; n < s->size; ++n) {
+    const taco_event *i = &s->events[n];
+    if (i->type == TACO_EVENT_MEASURE && i->measure.real &&
+        s->positions[n].den != 0)
+      *(b++) = i;
+  }
+  if (count != 0)
+    qsort(barlines, count, sizeof(taco_event *),
+          (int (*)(const void *, const void *))compare_barlines_);
+
+  for (size_t n = 0; n < s->size; ++n) {
+    taco_position *p = &s->positions[n];
+    const taco_event *e = &s->events[n];
+    if (p->den != 0)
+      continue;
+
+    // find last barline at or before the event
+    size_t lo = 0;
+    size_t hi = count;
+    while (hi - lo > 1) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (e->time < barlines[mid]->time)
+        hi = mid;
+      else
+        lo = mid;
+    }
+
+    if (count == 0 || e->time < barlines[lo]->time) {
+      // no measures to refer to; use whole notes from the start
+      p->measure = 0;
+      p->num = e->time;
+      p->den = s->tickrate;
+    } else {
+      const taco_event *barline = barlines[lo];
+      p->measure = s->positions[barline - s->events].measure;
+      p->num = e->time - barline->time;
+      p->den = barline->measure.ticks;
+      if (p->den == 0) {
+        p->num = 0;
+        p->den = 1;
+      }
+    }
+
+    uint32_t g = gcd_(p->num, p->den);
+    p->num /= g;
+    p->den /= g;
+  }
+
+  taco_free_(s->alloc, barlines);
+  return 0;
+}
+
+int taco_section_sort_(taco_section *restrict s) {
+  invalidate_caches_(s);
+  if (s->size == 0)
+    return 0;
+
+  if (!s->positions && !s->sources) {
+    qsort(s->events, s->size, sizeof(taco_event),
+          (int (*)(const void *, const void *))compare_events_);
+    return 0;
+  }
+
+  // sort events along with their positions and sources; untracked
+  // positions compare equal
+  if (s->positions && resolve_positions_(s) != 0)
+    return -1;
+
+  sort_entry *entries = taco_malloc_(s->alloc, s->size * sizeof(sort_entry));
+  if (!entries)
+    return -1;
+
+  memset(entries, 0, s->size * sizeof(sort_entry));
+  for (size_t n = 0; n < s->size; ++n) {
+    entries[n].event = s->events[n];
+    if (s->positions)
+      entries[n].position = s->positions[n];
+    if (s->sources)
+      entries[n].source = s->sources[n];
+  }
+
+  qsort(entries, s->size, sizeof(sort_entry),
+        (int (*)(const void *, const void *))compare_entries_);
+
+  for (size_t n = 0; n < s->size; ++n) {
+    s->events[n] = entries[n].event;
+    if (s->positions)
+      s->positions[n] = entries[n].position;
+    if (s->sources)
+      s->sources[n] = entries[n].source;
+  }
+
+  taco_free_(s->alloc, entries);
+  return 0;
 }
 
 int taco_section_pop_(taco_section *s, size_t count) {
-  invalidate_bpm_times_(s);
+  invalidate_caches_(s);
   if (count > s->size)
     count = s->size;
   s->size -= count;
@@ -213,7 +599,7 @@ int taco_section_pop_(taco_section *s, size_t count) {
 }
 
 void taco_section_clear_(taco_section *restrict s) {
-  invalidate_bpm_times_(s);
+  invalidate_caches_(s);
   s->size = 0;
 }
 
@@ -239,6 +625,34 @@ int taco_section_set_balloons_(taco_section *restrict section,
 
 #define TIME(bpm, ticks, tickrate)                                             \
   ((60.0 / (double)(bpm) * 4.0) * ((double)(ticks) / (double)(tickrate)))
+#define TIME_WHOLE(bpm, whole) ((60.0 / (double)(bpm) * 4.0) * (whole))
+
+// Gets the position of an event in whole notes. Exact positions are used
+// when tracked; this requires the measure table.
+static double whole_of_(const taco_section *restrict s, size_t n) {
+  if (s->positions && current_(s, CACHE_MEASURES)) {
+    const taco_position *p = &s->positions[n];
+    if (p->den != 0 && p->measure < s->measure_count) {
+      const taco_measure *m = &s->measures[p->measure];
+      return m->whole + m->whole_length * p->num / p->den;
+    }
+  }
+
+  return (double)s->events[n].time / s->tickrate;
+}
+
+static double seconds_at_(const taco_section *restrict s, int ticks);
+static double seconds_at_whole_(const taco_section *restrict s, double whole);
+
+static void update_measure_seconds_(taco_section *restrict s) {
+  for (size_t n = 0; n < s->measure_count; ++n) {
+    taco_measure *m = &s->measures[n];
+    if (s->positions)
+      m->seconds = seconds_at_whole_(s, m->whole);
+    else
+      m->seconds = seconds_at_(s, m->ticks);
+  }
+}
 
 int taco_section_cache_seconds_(taco_section *restrict s) {
   bpm_entry *old = s->bpm_times;
@@ -253,40 +667,55 @@ int taco_section_cache_seconds_(taco_section *restrict s) {
   }
 
   if (time_events == 0) {
+    taco_free_(s->alloc, old);
     s->bpm_times = NULL;
+    s->stale &= ~CACHE_SECONDS;
+    update_measure_seconds_(s);
     return 0;
   }
 
   bpm_entry *bpm_times =
-      taco_malloc_(s->alloc, time_events * sizeof(bpm_entry));
+      taco_malloc_at_(s->alloc, time_events * sizeof(bpm_entry),
+                      TACO_ALLOC_SITE_CACHE);
   if (!bpm_times) {
+    taco_free_(s->alloc, old);
     s->bpm_times = NULL;
     return -1;
   }
 
   int ticks = 0;
+  double whole = 0;
   double time = 0;
   bpm_entry *entry = bpm_times;
-  double bpm = 120; // sane default for initial bpm
+  double bpm = TACO_DEFAULT_BPM_;
 
   // calculate time for events affecting timing
-  taco_section_foreach(i, s) {
+  for (size_t n = 0; n < s->size; ++n) {
+    const taco_event *i = &s->events[n];
     if (i->type == TACO_EVENT_BPM || i->type == TACO_EVENT_DELAY) {
       int delta = i->time - ticks;
-      time += TIME(bpm, delta, s->tickrate);
+      double w = whole_of_(s, n);
+      bool same = s->positions ? w == whole : delta == 0;
+
+      if (s->positions)
+        time += TIME_WHOLE(bpm, w - whole);
+      else
+        time += TIME(bpm, delta, s->tickrate);
       ticks = i->time;
+      whole = w;
 
       if (i->type == TACO_EVENT_BPM)
         bpm = i->detail_float.value;
       if (i->type == TACO_EVENT_DELAY)
         time += i->detail_float.value;
 
-      if (entry > bpm_times && delta == 0) {
+      if (entry > bpm_times && same) {
         entry -= 1;
         time_events -= 1;
       }
 
       entry->ticks = ticks;
+      entry->whole = whole;
       entry->time = time;
       entry->bpm = bpm;
       entry += 1;
@@ -296,15 +725,12 @@ int taco_section_cache_seconds_(taco_section *restrict s) {
   s->time_events = time_events;
   taco_free_(s->alloc, old);
   s->bpm_times = bpm_times;
+  s->stale &= ~CACHE_SECONDS;
 
+  update_measure_seconds_(s);
   return 0;
 }
 
-static inline void invalidate_bpm_times_(taco_section *restrict s) {
-  taco_free_(s->alloc, s->bpm_times);
-  s->bpm_times = NULL;
-}
-
 static const bpm_entry *find_bpm_section_start_(int ticks,
                                                 const bpm_entry *start,
                                                 const bpm_entry *end) {
@@ -318,18 +744,438 @@ static const bpm_entry *find_bpm_section_start_(int ticks,
     return find_bpm_section_start_(ticks, mid, end);
 }
 
+static double seconds_at_(const taco_section *restrict s, int ticks) {
+  if (!s->bpm_times || !current_(s, CACHE_SECONDS))
+    return NAN;
+
+  const bpm_entry *entry = find_bpm_section_start_(
+      ticks, s->bpm_times, s->bpm_times + s->time_events);
+  double start = entry->time;
+  int delta = ticks - entry->ticks;
+  return start + TIME(entry->bpm, delta, s->tickrate);
+}
+
+static double seconds_at_whole_(const taco_section *restrict s,
+                                double whole) {
+  if (!s->bpm_times || !current_(s, CACHE_SECONDS))
+    return NAN;
+
+  // find last entry at or before position
+  size_t lo = 0;
+  size_t hi = s->time_events;
+  while (hi - lo > 1) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (whole < s->bpm_times[mid].whole)
+      hi = mid;
+    else
+      lo = mid;
+  }
+
+  const bpm_entry *entry = &s->bpm_times[lo];
+  return entry->time + TIME_WHOLE(entry->bpm, whole - entry->whole);
+}
+
 TACO_PUBLIC double taco_event_seconds(const taco_event *restrict e,
                                       const taco_section *restrict s) {
   if (e < s->events || e >= s->events + s->size)
     return NAN;
 
-  if (!s->bpm_times) {
+  if (s->positions)
+    return seconds_at_whole_(s, whole_of_(s, e - s->events));
+  return seconds_at_(s, taco_event_time(e));
+}
+
+void taco_time_cursor_init_(taco_time_cursor *restrict c,
+                            const taco_section *restrict s) {
+  c->section = s;
+  c->entry = 0;
+}
+
+double taco_time_cursor_seconds_(taco_time_cursor *restrict c,
+                                 const taco_event *restrict e) {
+  const taco_section *s = c->section;
+  if (e < s->events || e >= s->events + s->size || !s->bpm_times ||
+      !current_(s, CACHE_SECONDS))
     return NAN;
+
+  // same entry as the binary searches would find
+  const bpm_entry *entry;
+  if (s->positions) {
+    double whole = whole_of_(s, e - s->events);
+    while (c->entry + 1 < s->time_events &&
+           whole >= s->bpm_times[c->entry + 1].whole)
+      c->entry += 1;
+    entry = &s->bpm_times[c->entry];
+    return entry->time + TIME_WHOLE(entry->bpm, whole - entry->whole);
   }
 
-  const bpm_entry *entry = find_bpm_section_start_(
-      taco_event_time(e), s->bpm_times, s->bpm_times + s->time_events);
-  double start = entry->time;
-  int delta = taco_event_time(e) - entry->ticks;
-  return start + TIME(entry->bpm, delta, s->tickrate);
+  int ticks = taco_event_time(e);
+  while (c->entry + 1 < s->time_events &&
+         ticks >= s->bpm_times[c->entry + 1].ticks)
+    c->entry += 1;
+  entry = &s->bpm_times[c->entry];
+  return entry->time + TIME(entry->bpm, ticks - entry->ticks, s->tickrate);
+}
+
+int taco_event_position(const taco_event *restrict e,
+                        const taco_section *restrict s,
+                        size_t *restrict measure, int *restrict num,
+                        int *restrict den) {
+  if (e < s->events || e >= s->events + s->size)
+    return -1;
+
+  uint32_t m, n, d;
+  const taco_position *p = s->positions ? &s->positions[e - s->events] : NULL;
+
+  if (p && p->den != 0) {
+    m = p->measure;
+    n = p->num;
+    d = p->den;
+  } else {
+    // derive from ticks
+    const taco_measure *found = taco_section_measure_at_tick(s, e->time);
+    if (!found)
+      return -1;
+    m = found - s->measures;
+    n = e->time - found->ticks;
+    d = found->length;
+    if (d == 0) {
+      n = 0;
+      d = 1;
+    }
+    uint32_t g = gcd_(n, d);
+    n /= g;
+    d /= g;
+  }
+
+  if (measure)
+    *measure = m;
+  if (num)
+    *num = n;
+  if (den)
+    *den = d;
+  return 0;
+}
+
+int64_t taco_event_time_at(const taco_event *restrict e,
+                           const taco_section *restrict s, int tickrate) {
+  if (e < s->events || e >= s->events + s->size || tickrate <= 0)
+    return -1;
+
+  if (!s->positions)
+    return ((int64_t)e->time * tickrate * 2 + s->tickrate) /
+           (2 * (int64_t)s->tickrate);
+  return llround(whole_of_(s, e - s->events) * tickrate);
+}
+
+int taco_section_cache_measures_(taco_section *restrict s) {
+  taco_free_(s->alloc, s->measures);
+  s->measures = NULL;
+  s->measure_count = 0;
+
+  // scan
+  size_t count = 0;
+  taco_section_foreach(i, s) {
+    if (i->type == TACO_EVENT_MEASURE && i->measure.real)
+      count += 1;
+  }
+
+  if (count == 0) {
+    s->stale &= ~CACHE_MEASURES;
+    return 0;
+  }
+
+  taco_measure *measures = taco_malloc_at_(
+      s->alloc, count * sizeof(taco_measure), TACO_ALLOC_SITE_CACHE);
+  if (!measures)
+    return -1;
+
+  taco_measure *m = measures;
+  size_t first = 0;
+  double whole = 0;
+  taco_motion_state st;
+  taco_motion_state_init_(&st);
+
+  for (size_t n = 0; n < s->size; ++n) {
+    const taco_event *i = &s->events[n];
+
+    // events sharing a tick with a barline belong to its measure
+    if (n == 0 || i->time != s->events[n - 1].time)
+      first = n;
+
+    taco_motion_state_update_(&st, i);
+    if (i->type != TACO_EVENT_MEASURE || !i->measure.real)
+      continue;
+    m->ticks = i->time;
+    m->length = i->measure.ticks;
+    m->bpm = st.bpm;
+    m->scroll_x = st.scroll_x;
+    m->scroll_y = st.scroll_y;
+    m->first = first;
+    m->seconds = NAN;
+
+    // exact lengths are summed, so that starts do not drift with rounding
+    const taco_position *p = s->positions ? &s->positions[n] : NULL;
+    if (p && p->length_den != 0) {
+      m->whole = whole;
+      m->whole_length = (double)p->length_num / p->length_den;
+    } else {
+      m->whole = (double)m->ticks / s->tickrate;
+      m->whole_length = (double)m->length / s->tickrate;
+    }
+    whole = m->whole + m->whole_length;
+    m += 1;
+  }
+
+  s->measures = measures;
+  s->measure_count = count;
+  s->stale &= ~CACHE_MEASURES;
+  update_measure_seconds_(s);
+  return 0;
+}
+
+int taco_section_cache_motions_(taco_section *restrict s) {
+  taco_free_(s->alloc, s->motions);
+  s->motions = NULL;
+  if (s->size == 0) {
+    s->stale &= ~CACHE_MOTIONS;
+    return 0;
+  }
+
+  taco_motion_entry *motions = taco_malloc_at_(
+      s->alloc, s->size * sizeof(taco_motion_entry), TACO_ALLOC_SITE_CACHE);
+  if (!motions)
+    return -1;
+
+  taco_motion_compute_(s->events, s->size, motions);
+  s->motions = motions;
+  s->stale &= ~CACHE_MOTIONS;
+  return 0;
+}
+
+int taco_event_motion(const taco_event *restrict e,
+                      const taco_section *restrict s,
+                      taco_motion *restrict motion) {
+  if (e < s->events || e >= s->events + s->size || !s->motions ||
+      !current_(s, CACHE_MOTIONS) || !motion)
+    return -1;
+
+  const taco_motion_entry *m = &s->motions[e - s->events];
+  motion->x = m->x;
+  motion->y = m->y;
+  motion->appear = m->appear;
+  motion->move = m->move;
+  return 0;
+}
+
+// Gets 4/4 measures passed at a time, as scrolled by beats. Progress stops
+// during delays, until the time of the next timing entry.
+static double progress_at_(const taco_section *restrict s, double seconds) {
+  double whole = 0;
+  double time = 0;
+  double bpm = TACO_DEFAULT_BPM_;
+  double limit = INFINITY;
+  const bpm_entry *times = current_(s, CACHE_SECONDS) ? s->bpm_times : NULL;
+
+  if (times && seconds >= times[0].time) {
+    // find last entry at or before time
+    size_t lo = 0;
+    size_t hi = s->time_events;
+    while (hi - lo > 1) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (seconds < times[mid].time)
+        hi = mid;
+      else
+        lo = mid;
+    }
+
+    const bpm_entry *entry = &times[lo];
+    whole = entry->whole;
+    time = entry->time;
+    bpm = entry->bpm;
+    if (lo + 1 < s->time_events)
+      limit = times[lo + 1].whole;
+  } else if (times) {
+    limit = times[0].whole;
+  }
+
+  return fmin(whole + (seconds - time) * bpm / 240, limit);
+}
+
+double taco_section_scroll_progress(const taco_section *restrict s, int mode,
+                                    double seconds) {
+  if (mode == TACO_SCROLLMODE_TAIKO)
+    return seconds;
+  return progress_at_(s, seconds);
+}
+
+static bool drawn_(const taco_event *restrict e) {
+  return e->type > 0 || (e->type == TACO_EVENT_MEASURE && !e->measure.hidden);
+}
+
+int taco_section_cache_scroll_(taco_section *restrict s, int mode) {
+  taco_free_(s->alloc, s->scroll);
+  s->scroll = NULL;
+
+  // scan
+  size_t count = 0;
+  taco_section_foreach(i, s) {
+    if (drawn_(i))
+      count += 1;
+  }
+
+  // arrays follow the cache, widest first to keep them aligned
+  size_t size = sizeof(taco_scroll_cache) +
+                count * (sizeof(double) + 4 * sizeof(float) + sizeof(uint32_t));
+  taco_scroll_cache *c = taco_malloc_at_(s->alloc, size, TACO_ALLOC_SITE_CACHE);
+  if (!c)
+    return -1;
+
+  c->mode = mode;
+  c->count = count;
+  c->anchor = (double *)(c + 1);
+  c->x = (float *)(c->anchor + count);
+  c->y = c->x + count;
+  c->appear = c->y + count;
+  c->move = c->appear + count;
+  c->events = (uint32_t *)(c->move + count);
+
+  taco_motion_state st;
+  taco_motion_state_init_(&st);
+  taco_time_cursor cursor;
+  taco_time_cursor_init_(&cursor, s);
+  size_t k = 0;
+
+  for (size_t n = 0; n < s->size; ++n) {
+    const taco_event *i = &s->events[n];
+    taco_motion_state_update_(&st, i);
+    if (!drawn_(i))
+      continue;
+
+    double seconds = taco_time_cursor_seconds_(&cursor, i);
+    double x, y;
+    c->events[k] = n;
+    if (mode == TACO_SCROLLMODE_TAIKO) {
+      // a 4/4 measure takes 240 / bpm seconds to pass
+      taco_motion_state_vector_(&st, true, &x, &y);
+      c->anchor[k] = seconds;
+      c->x[k] = x * st.bpm / 240;
+      c->y[k] = y * st.bpm / 240;
+      c->appear[k] = st.appear;
+      c->move[k] = st.move;
+    } else {
+      // tempo is in the progress; BM scrolling ignores scroll speed
+      double anchor = progress_at_(s, seconds);
+      taco_motion_state_vector_(&st, mode == TACO_SCROLLMODE_HB, &x, &y);
+      c->anchor[k] = anchor;
+      c->x[k] = x;
+      c->y[k] = y;
+      c->appear[k] = isinf(st.appear)
+                         ? INFINITY
+                         : anchor - progress_at_(s, seconds - st.appear);
+      c->move[k] = isinf(st.move) ? INFINITY
+                                  : anchor - progress_at_(s, seconds - st.move);
+    }
+    k += 1;
+  }
+
+  s->scroll = c;
+  s->stale &= ~CACHE_SCROLL;
+  return 0;
+}
+
+int taco_section_scroll(const taco_section *restrict s,
+                        taco_scroll *restrict scroll) {
+  const taco_scroll_cache *c = s->scroll;
+  if (!c || !current_(s, CACHE_SCROLL) || !scroll)
+    return -1;
+
+  scroll->mode = c->mode;
+  scroll->count = c->count;
+  scroll->anchor = c->anchor;
+  scroll->x = c->x;
+  scroll->y = c->y;
+  scroll->appear = c->appear;
+  scroll->move = c->move;
+  scroll->events = c->events;
+  return 0;
+}
+
+void taco_section_cache_fingerprint_(taco_section *restrict s) {
+  taco_fingerprint_compute_(s, &s->fingerprint, &s->sketch);
+  s->stale &= ~CACHE_FINGERPRINT;
+}
+
+int taco_section_fingerprint(const taco_section *restrict s,
+                             uint64_t *restrict fingerprint) {
+  if (!current_(s, CACHE_FINGERPRINT) || !fingerprint)
+    return -1;
+  *fingerprint = s->fingerprint;
+  return 0;
+}
+
+int taco_section_sketch(const taco_section *restrict s,
+                        taco_sketch *restrict sketch) {
+  if (!current_(s, CACHE_FINGERPRINT) || !sketch)
+    return -1;
+  *sketch = s->sketch;
+  return 0;
+}
+
+// Gets the number of measures in the table, or 0 while it is stale.
+static size_t measure_count_(const taco_section *restrict s) {
+  return current_(s, CACHE_MEASURES) ? s->measure_count : 0;
+}
+
+size_t taco_section_measure_count(const taco_section *restrict s) {
+  return measure_count_(s);
+}
+
+const taco_measure *taco_section_measure(const taco_section *restrict s,
+                                         size_t i) {
+  if (i >= measure_count_(s))
+    return NULL;
+  return s->measures + i;
+}
+
+const taco_measure *taco_section_measure_at_tick(const taco_section *restrict s,
+                                                 int ticks) {
+  if (measure_count_(s) == 0 || ticks < s->measures[0].ticks)
+    return NULL;
+
+  // find last measure starting at or before ticks
+  size_t lo = 0;
+  size_t hi = measure_count_(s);
+  while (hi - lo > 1) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (ticks < s->measures[mid].ticks)
+      hi = mid;
+    else
+      lo = mid;
+  }
+
+  return s->measures + lo;
+}
+
+const taco_measure *taco_section_measure_at_time(const taco_section *restrict s,
+                                                 double seconds) {
+  if (measure_count_(s) == 0 || !(seconds >= s->measures[0].seconds))
+    return NULL;
+
+  size_t lo = 0;
+  size_t hi = measure_count_(s);
+  while (hi - lo > 1) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (seconds < s->measures[mid].seconds)
+      hi = mid;
+    else
+      lo = mid;
+  }
+
+  return s->measures + lo;
+}
+
+size_t taco_measure_index(const taco_measure *restrict m,
+                          const taco_section *restrict s) {
+  return m - s->measures;
 }
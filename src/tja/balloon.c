@@ -18,7 +18,8 @@ struct tja_balloon_ {
 
 tja_balloon *tja_balloon_create2_(taco_allocator *a) {
   tja_balloon *b =
-      taco_malloc_(a, sizeof(tja_balloon) + INITIAL_CAPACITY * sizeof(int));
+      taco_malloc_at_(a, sizeof(tja_balloon) + INITIAL_CAPACITY * sizeof(int),
+                      TACO_ALLOC_SITE_BALLOON);
   b->alloc = a;
   b->size = 0;
   b->capacity = INITIAL_CAPACITY;
@@ -29,8 +30,9 @@ tja_balloon *tja_balloon_create2_(taco_allocator *a) {
 tja_balloon *tja_balloon_append_(tja_balloon *b, int hits) {
   if (b->size == b->capacity) {
     size_t capacity = b->capacity * 2;
-    tja_balloon *new = taco_realloc_(
-        b->alloc, b, sizeof(tja_balloon) + capacity * sizeof(int));
+    tja_balloon *new = taco_realloc_at_(
+        b->alloc, b, sizeof(tja_balloon) + capacity * sizeof(int),
+        TACO_ALLOC_SITE_BALLOON);
     if (!new)
       return NULL;
 
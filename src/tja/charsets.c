@@ -0,0 +1,193 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "tja/charsets.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+static unsigned char *put_utf8(unsigned char *out, uint32_t cp) {
+  if (cp < 0x80) {
+    *out++ = cp;
+  } else if (cp < 0x800) {
+    *out++ = 0xc0 | (cp >> 6);
+    *out++ = 0x80 | (cp & 0x3f);
+  } else if (cp < 0x10000) {
+    *out++ = 0xe0 | (cp >> 12);
+    *out++ = 0x80 | ((cp >> 6) & 0x3f);
+    *out++ = 0x80 | (cp & 0x3f);
+  } else {
+    *out++ = 0xf0 | (cp >> 18);
+    *out++ = 0x80 | ((cp >> 12) & 0x3f);
+    *out++ = 0x80 | ((cp >> 6) & 0x3f);
+    *out++ = 0x80 | (cp & 0x3f);
+  }
+  return out;
+}
+
+// Copies ASCII eight bytes at a time; returns the first byte that is not.
+static const unsigned char *copy_ascii(const unsigned char *in,
+                                       const unsigned char *end,
+                                       unsigned char **out) {
+  while (end - in >= 8) {
+    uint64_t word;
+    memcpy(&word, in, 8);
+    if (word & UINT64_C(0x8080808080808080))
+      break;
+    memcpy(*out, in, 8);
+    in += 8;
+    *out += 8;
+  }
+  return in;
+}
+
+// Maps a four-byte GB 18030 sequence to a code point, or 0 if unmapped.
+static uint32_t gb18030_four(const unsigned char *s) {
+  if (s[2] < 0x81 || s[2] > 0xfe || s[3] < 0x30 || s[3] > 0x39)
+    return 0;
+
+  uint32_t index =
+      (((s[0] - 0x81) * 10 + (s[1] - 0x30)) * 126 + (s[2] - 0x81)) * 10 +
+      (s[3] - 0x30);
+  if (s[0] >= 0x90 && s[0] <= 0xe3) {
+    // supplementary planes are mapped linearly from 0x90308130
+    uint32_t cp = index - 189000 + 0x10000;
+    return cp <= 0x10ffff ? cp : 0;
+  }
+  if (index > 39419)
+    return 0;
+
+  // find the last run starting at or before the index
+  size_t lo = 0, hi = 206;
+  while (hi - lo > 1) {
+    size_t mid = (lo + hi) / 2;
+    if (tja_gb18030_ranges_[mid][0] <= index)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return tja_gb18030_ranges_[lo][1] + (index - tja_gb18030_ranges_[lo][0]);
+}
+
+size_t tja_gb18030_decode_(const char *restrict src, size_t size,
+                           char *restrict dst, size_t *restrict consumed,
+                           bool eof) {
+  const unsigned char *in = (const unsigned char *)src;
+  const unsigned char *end = in + size;
+  unsigned char *out = (unsigned char *)dst;
+
+  while ((in = copy_ascii(in, end, &out)) != end) {
+    unsigned c = *in;
+    uint32_t cp = 0xfffd;
+    size_t len = 1;
+
+    if (c < 0x80) {
+      cp = c;
+    } else if (c != 0x80 && c != 0xff) {
+      // four-byte sequences have a digit second
+      size_t need = end - in >= 2 && in[1] >= 0x30 && in[1] <= 0x39 ? 4 : 2;
+      if ((size_t)(end - in) < need) {
+        if (!eof)
+          break;
+      } else if (need == 4) {
+        uint32_t m = gb18030_four(in);
+        cp = m ? m : cp;
+        len = m ? 4 : 1;
+      } else if (in[1] >= 0x40 && in[1] <= 0xfe) {
+        uint32_t m = tja_gbk_table_[c - 0x81][in[1] - 0x40];
+        cp = m ? m : cp;
+        len = m ? 2 : 1;
+      }
+    }
+
+    out = put_utf8(out, cp);
+    in += len;
+  }
+
+  *consumed = (const char *)in - src;
+  return (char *)out - dst;
+}
+
+size_t tja_cp949_decode_(const char *restrict src, size_t size,
+                         char *restrict dst, size_t *restrict consumed,
+                         bool eof) {
+  const unsigned char *in = (const unsigned char *)src;
+  const unsigned char *end = in + size;
+  unsigned char *out = (unsigned char *)dst;
+
+  while ((in = copy_ascii(in, end, &out)) != end) {
+    unsigned c = *in;
+    uint32_t cp = 0xfffd;
+    size_t len = 1;
+
+    if (c < 0x80) {
+      cp = c;
+    } else if (c != 0x80 && c != 0xff) {
+      if (end - in < 2) {
+        if (!eof)
+          break;
+      } else if (in[1] >= 0x41 && in[1] <= 0xfe) {
+        uint32_t m = tja_cp949_table_[c - 0x81][in[1] - 0x41];
+        cp = m ? m : cp;
+        len = m ? 2 : 1;
+      }
+    }
+
+    out = put_utf8(out, cp);
+    in += len;
+  }
+
+  *consumed = (const char *)in - src;
+  return (char *)out - dst;
+}
+
+static size_t utf16_decode(const char *restrict src, size_t size,
+                           char *restrict dst, size_t *restrict consumed,
+                           bool eof, bool big) {
+  const unsigned char *in = (const unsigned char *)src;
+  const unsigned char *end = in + size;
+  unsigned char *out = (unsigned char *)dst;
+  int hi = big ? 0 : 1;
+
+  while (end - in >= 2) {
+    uint32_t unit = in[hi] << 8 | in[1 - hi];
+    size_t len = 2;
+
+    if (unit >= 0xd800 && unit <= 0xdbff) {
+      if (end - in < 4 && !eof)
+        break;
+      uint32_t low = end - in >= 4 ? in[2 + hi] << 8 | in[3 - hi] : 0;
+      if (low >= 0xdc00 && low <= 0xdfff) {
+        unit = 0x10000 + ((unit - 0xd800) << 10) + (low - 0xdc00);
+        len = 4;
+      } else {
+        unit = 0xfffd;
+      }
+    } else if (unit >= 0xdc00 && unit <= 0xdfff) {
+      unit = 0xfffd;
+    }
+
+    out = put_utf8(out, unit);
+    in += len;
+  }
+
+  // an odd byte out at the end
+  if (in != end && eof) {
+    out = put_utf8(out, 0xfffd);
+    in = end;
+  }
+
+  *consumed = (const char *)in - src;
+  return (char *)out - dst;
+}
+
+size_t tja_utf16le_decode_(const char *restrict src, size_t size,
+                           char *restrict dst, size_t *restrict consumed,
+                           bool eof) {
+  return utf16_decode(src, size, dst, consumed, eof, false);
+}
+
+size_t tja_utf16be_decode_(const char *restrict src, size_t size,
+                           char *restrict dst, size_t *restrict consumed,
+                           bool eof) {
+  return utf16_decode(src, size, dst, consumed, eof, true);
+}
@@ -71,13 +71,13 @@ int tja_coursebody_append_branched_(tja_coursebody *restrict c,
           {
               .time = 0,
               .type = TACO_EVENT_TJA_BRANCH_TYPE,
-              .line = branched->line,
+              .line = branched->location.first_line,
               .detail_int = {branched->branchtype},
           },
           {
               .time = 0,
               .type = TACO_EVENT_TJA_BRANCH_THRESHOLD,
-              .line = branched->line,
+              .line = branched->location.first_line,
               .branch_cond =
                   {
                       .advanced = branched->threshold_advanced,
@@ -88,7 +88,10 @@ int tja_coursebody_append_branched_(tja_coursebody *restrict c,
       tja_event_set_measure_(&condition[0], c->measures);
       condition[1].time = condition[0].time;
 
-      taco_section_push_many_(branch, condition, 2);
+      for (int i = 0; i < 2; ++i) {
+        taco_section_push_(branch, &condition[i]);
+        tja_set_source_(branch, &branched->location);
+      }
     }
 
     taco_section_concat_(branch, section);
@@ -0,0 +1,251 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "tja/charsets.h"
+
+#include "taco.h"
+#include "tja/shiftjis.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SAMPLE_SIZE 4096
+
+// Each double-byte character read from a sample scores by how likely it is
+// in text of the encoding tried. Misreading another encoding tends to give
+// invalid sequences or characters rarely seen, so the right one usually
+// scores highest even on a short title.
+#define SCORE_INVALID (-8)
+#define SCORE_RARE 0
+#define SCORE_PLAIN 2  // in the common block of an encoding
+#define SCORE_COMMON 4 // kana, or among the most frequent characters
+
+// The most frequent characters of Chinese and Korean, as byte pairs. Pairs
+// frequent in both are left out, as they tell nothing.
+// clang-format off
+static const uint16_t common_gb18030[] = {
+    0xb0ae, 0xb0b2, 0xb0cb, 0xb0d1, 0xb0d7, 0xb0d9, 0xb0eb, 0xb0ec, 0xb1a3,
+    0xb1a8, 0xb1b1, 0xb1bb, 0xb1be, 0xb1c8, 0xb1d8, 0xb1df, 0xb1e3, 0xb1e4,
+    0xb1ed, 0xb1f0, 0xb2a2, 0xb2bb, 0xb2bd, 0xb2bf, 0xb2c5, 0xb2fa, 0xb3a1,
+    0xb3a3, 0xb3a4, 0xb3b5, 0xb3c7, 0xb3c9, 0xb3cc, 0xb3d4, 0xb3d6, 0xb3f6,
+    0xb4a6, 0xb4ba, 0xb4cb, 0xb4ce, 0xb4d3, 0xb4ef, 0xb4f2, 0xb4f3, 0xb4f8,
+    0xb4fa, 0xb5a5, 0xb5ab, 0xb5b1, 0xb5b3, 0xb5b8, 0xb5b9, 0xb5bd, 0xb5c0,
+    0xb5c2, 0xb5c3, 0xb5c4, 0xb5c8, 0xb5d8, 0xb5da, 0xb5e3, 0xb5e7, 0xb6a8,
+    0xb6ab, 0xb6ac, 0xb6af, 0xb6bc, 0xb6c8, 0xb6d3, 0xb6d4, 0xb6e0, 0xb6f8,
+    0xb6f9, 0xb6fe, 0xb7a2, 0xb7a8, 0xb7b4, 0xb7bd, 0xb7bf, 0xb7c5, 0xb7c7,
+    0xb7d6, 0xb7e7, 0xb7f2, 0xb7fe, 0xb8c3, 0xb8c4, 0xb8c9, 0xb8d0, 0xb8df,
+    0xb8e6, 0xb8e8, 0xb8ef, 0xb8f6, 0xb8f7, 0xb8f8, 0xb8fa, 0xb8fc, 0xb9a4,
+    0xb9a6, 0xb9b2, 0xb9c4, 0xb9d8, 0xb9dc, 0xb9e2, 0xb9fa, 0xb9fb, 0xb9fd,
+    0xbaa2, 0xbaa3, 0xbac3, 0xbacd, 0xbacf, 0xbadc, 0xbaec, 0xbaf2, 0xbaf3,
+    0xbba8, 0xbbaa, 0xbbaf, 0xbbb0, 0xbbb9, 0xbbc3, 0xbbc6, 0xbbd8, 0xbbe1,
+    0xbbee, 0xbbf0, 0xbbf2, 0xbbf9, 0xbbfa, 0xbca3, 0xbcab, 0xbcb0, 0xbcb4,
+    0xbcb8, 0xbcc0, 0xbcc6, 0xbcc7, 0xbcca, 0xbcdb, 0xbce4, 0xbcfb, 0xbcfe,
+    0xbda8, 0xbdab, 0xbdad, 0xbdbb, 0xbdcc, 0xbdd0, 0xbdd3, 0xbdda, 0xbde1,
+    0xbde2, 0xbde7, 0xbdf0, 0xbdf1, 0xbdf8, 0xbdfc, 0xbea9, 0xbead, 0xbec5,
+    0xbecd, 0xbef5, 0xbefc, 0xbfaa, 0xbfb4, 0xbfc6, 0xbfc9, 0xbfda, 0xc0b4,
+    0xc0eb, 0xc0ed, 0xc0ee, 0xc0ef, 0xc1a2, 0xc1aa, 0xc1ac, 0xc1b3, 0xc1b5,
+    0xc1bd, 0xc1bf, 0xc1cb, 0xc1ec, 0xc1f4, 0xc1f7, 0xc1f9, 0xc1fa, 0xc2b7,
+    0xc2c9, 0xc2db, 0xc2ed, 0xc2fa, 0xc3ab, 0xc3b4, 0xc3bb, 0xc3bf, 0xc3c0,
+    0xc3c5, 0xc3c7, 0xc3ce, 0xc3e6, 0xc3f1, 0xc3f7, 0xc3fb, 0xc3fc, 0xc4a7,
+    0xc4bf, 0xc4c7, 0xc4cf, 0xc4d1, 0xc4d8, 0xc4dc, 0xc4e3, 0xc4ea, 0xc5ae,
+    0xc5c9, 0xc5dc, 0xc6ac, 0xc6b7, 0xc6bd, 0xc6da, 0xc6df, 0xc6e6, 0xc6f0,
+    0xc6f8, 0xc7a7, 0xc7ae, 0xc7b0, 0xc7bf, 0xc7d7, 0xc7e1, 0xc7e5, 0xc7e9,
+    0xc7eb, 0xc7ef, 0xc7f3, 0xc7f8, 0xc7fa, 0xc8a1, 0xc8a5, 0xc8a8, 0xc8ab,
+    0xc8b4, 0xc8bb, 0xc8c3, 0xc8cb, 0xc8ce, 0xc8cf, 0xc8d5, 0xc8dd, 0xc8e7,
+    0xc8eb, 0xc8fd, 0xc9ab, 0xc9bd, 0xc9c1, 0xc9cc, 0xc9cf, 0xc9d9, 0xc9e7,
+    0xc9e8, 0xc9ed, 0xc9ee, 0xc9f1, 0xc9f5, 0xc9f9, 0xc9fa, 0xcaa6, 0xcaae,
+    0xcab1, 0xcab2, 0xcab5, 0xcab6, 0xcab7, 0xcab9, 0xcabc, 0xcabd, 0xcabf,
+    0xcac0, 0xcac2, 0xcac7, 0xcad0, 0xcad5, 0xcad6, 0xcad7, 0xcadc, 0xcae9,
+    0xcaf5, 0xcafd, 0xcbab, 0xcbae, 0xcbb5, 0xcbbc, 0xcbbe, 0xcbc0, 0xcbc4,
+    0xcbe3, 0xcbf9, 0xcbfb, 0xcbfc, 0xcbfd, 0xcca8, 0xccab, 0xccd8, 0xcce1,
+    0xcce2, 0xcce5, 0xccec, 0xccf5, 0xccfd, 0xcda8, 0xcdac, 0xcdb3, 0xcdb7,
+    0xcde2, 0xcdea, 0xcdf2, 0xcdf5, 0xcdf9, 0xcdfb, 0xceaa, 0xceac, 0xceaf,
+    0xceb4, 0xcebb, 0xcec4, 0xceca, 0xced2, 0xcede, 0xcee4, 0xcee5, 0xcee8,
+    0xceef, 0xcef1, 0xcef7, 0xcfa2, 0xcfb5, 0xcfc2, 0xcfc4, 0xcfc8, 0xcfd6,
+    0xcfe0, 0xcfeb, 0xcff1, 0xcff2, 0xcff3, 0xd0a1, 0xd0a6, 0xd0a9, 0xd0b4,
+    0xd0c2, 0xd0c4, 0xd0c5, 0xd0c7, 0xd0ce, 0xd0d0, 0xd0d4, 0xd0ed, 0xd0fd,
+    0xd1a7, 0xd1a9, 0xd1d0, 0xd1d4, 0xd1db, 0xd1f9, 0xd2aa, 0xd2ab, 0xd2b2,
+    0xd2b5, 0xd2b9, 0xd2bb, 0xd2d1, 0xd2d4, 0xd2e2, 0xd2e5, 0xd2e9, 0xd2f2,
+    0xd2f4, 0xd3a2, 0xd3a3, 0xd3a6, 0xd3c3, 0xd3c9, 0xd3d0, 0xd3d1, 0xd3d6,
+    0xd3da, 0xd3eb, 0xd3ef, 0xd4aa, 0xd4ad, 0xd4b1, 0xd4b6, 0xd4ba, 0xd4bd,
+    0xd4c2, 0xd4cb, 0xd4d9, 0xd4da, 0xd4e7, 0xd4f2, 0xd4f5, 0xd5b9, 0xd5bd,
+    0xd5be, 0xd5c5, 0xd5d2, 0xd5df, 0xd5e2, 0xd5e6, 0xd5fd, 0xd5fe, 0xd6a4,
+    0xd6aa, 0xd6ae, 0xd6b1, 0xd6b8, 0xd6bb, 0xd6c1, 0xd6c6, 0xd6ce, 0xd6d0,
+    0xd6d6, 0xd6d8, 0xd6da, 0xd6dc, 0xd6f7, 0xd7a1, 0xd7aa, 0xd7c5, 0xd7ca,
+    0xd7d3, 0xd7d4, 0xd7d6, 0xd7dc, 0xd7df, 0xd7e0, 0xd7ee, 0xd7f6, 0xd7f7,
+};
+
+static const uint16_t common_cp949[] = {
+    0xb0a1, 0xb0a3, 0xb0ad, 0xb0c5, 0xb0cd, 0xb0d4, 0xb0dc, 0xb0e1, 0xb0e8,
+    0xb0ed, 0xb0f8, 0xb0fa, 0xb1b8, 0xb1b9, 0xb1d7, 0xb1e2, 0xb1e6, 0xb1ee,
+    0xb2c9, 0xb2de, 0xb3af, 0xb3bb, 0xb3ca, 0xb3eb, 0xb4c2, 0xb4c3, 0xb4cf,
+    0xb4d9, 0xb4de, 0xb4eb, 0xb4f5, 0xb5b5, 0xb5bf, 0xb5c7, 0xb5e5, 0xb5e9,
+    0xb6a7, 0xb6f3, 0xb6f7, 0xb6fb, 0xb7a1, 0xb7af, 0xb7b9, 0xb7ce, 0xb8a6,
+    0xb8a7, 0xb8ae, 0xb8b5, 0xb8b6, 0xb8bb, 0xb8be, 0xb8e9, 0xb8ed, 0xb8f0,
+    0xb9ae, 0xb9b0, 0xb9cc, 0xb9d6, 0xb9d9, 0xb9df, 0xbab0, 0xbab8, 0xbab9,
+    0xbabd, 0xbad2, 0xbaea, 0xbaf1, 0xbafb, 0xbba1, 0xbbe7, 0xbbea, 0xbbf3,
+    0xbbf5, 0xbbfd, 0xbcad, 0xbcb1, 0xbcd5, 0xbcf6, 0xbdba, 0xbdc3, 0xbdc5,
+    0xbdc7, 0xbdc9, 0xbec6, 0xbec8, 0xbee7, 0xbeee, 0xbef8, 0xbfa1, 0xbfa9,
+    0xbfac, 0xbfb5, 0xbfc0, 0xbfe4, 0xbfeb, 0xbfee, 0xbfef, 0xbff4, 0xbff8,
+    0xc0a7, 0xc0af, 0xc0b8, 0xc0bb, 0xc0bd, 0xc0c7, 0xc0cc, 0xc0ce, 0xc0d9,
+    0xc0da, 0xc0e5, 0xc0fc, 0xc1a4, 0xc1df, 0xc1f6, 0xc1f8, 0xc3b5, 0xc3e3,
+    0xc4a1, 0xc4a3, 0xc4ed, 0xc5a9, 0xc5c2, 0xc5cd, 0xc5e4, 0xc5f5, 0xc6ae,
+    0xc6c4, 0xc6db, 0xc7c1, 0xc7c3, 0xc7cf, 0xc7d1, 0xc7d8, 0xc8a3, 0xc8ad,
+};
+// clang-format on
+
+static int compare_code(const void *a, const void *b) {
+  return *(const uint16_t *)a - *(const uint16_t *)b;
+}
+
+static bool is_common(const uint16_t *list, size_t size, unsigned code) {
+  uint16_t key = code;
+  return bsearch(&key, list, size, sizeof(uint16_t), compare_code) != NULL;
+}
+
+// Skips ASCII eight bytes at a time.
+static size_t skip_ascii(const unsigned char *s, size_t i, size_t size) {
+  while (size - i >= 8) {
+    uint64_t word;
+    memcpy(&word, s + i, 8);
+    if (word & UINT64_C(0x8080808080808080))
+      break;
+    i += 8;
+  }
+  while (i < size && s[i] < 0x80)
+    i += 1;
+  return i;
+}
+
+static int score_shiftjis(const unsigned char *s, size_t size) {
+  int score = 0;
+  size_t i = 0;
+  while ((i = skip_ascii(s, i, size)) + 1 < size) {
+    unsigned c = s[i], t = s[i + 1];
+    // single bytes, mostly half-width katakana, could be anything
+    if (!((c >= 0x81 && c <= 0x9f) || (c >= 0xe0 && c <= 0xfc))) {
+      i += 1;
+      continue;
+    }
+
+    int row = c <= 0x9f ? c - 0x81 : c - 0xe0 + 31;
+    if (t < 0x40 || t > 0xfc || !tja_cp932_table_[row][t - 0x40]) {
+      score += SCORE_INVALID;
+      i += 1;
+      continue;
+    }
+
+    unsigned code = c << 8 | t;
+    if ((code >= 0x829f && code <= 0x82f1) ||
+        (code >= 0x8340 && code <= 0x8396) || code == 0x815b)
+      score += SCORE_COMMON; // kana and the long vowel mark
+    else if (code >= 0x889f && code <= 0x9872)
+      score += SCORE_PLAIN; // JIS level 1 kanji
+    else
+      score += SCORE_RARE;
+    i += 2;
+  }
+  return score;
+}
+
+static int score_gb18030(const unsigned char *s, size_t size) {
+  int score = 0;
+  size_t i = 0;
+  while ((i = skip_ascii(s, i, size)) + 1 < size) {
+    unsigned c = s[i], t = s[i + 1];
+    if (c == 0x80 || c == 0xff) {
+      score += SCORE_INVALID;
+      i += 1;
+      continue;
+    }
+
+    if (t >= 0x30 && t <= 0x39) {
+      // four-byte sequences are for characters rarely used
+      bool valid = i + 3 < size && s[i + 2] >= 0x81 && s[i + 2] <= 0xfe &&
+                   s[i + 3] >= 0x30 && s[i + 3] <= 0x39;
+      score += valid ? SCORE_RARE : SCORE_INVALID;
+      i += valid ? 4 : 1;
+      continue;
+    }
+    if (t < 0x40 || t > 0xfe || !tja_gbk_table_[c - 0x81][t - 0x40]) {
+      score += SCORE_INVALID;
+      i += 1;
+      continue;
+    }
+
+    unsigned code = c << 8 | t;
+    if (is_common(common_gb18030,
+                  sizeof(common_gb18030) / sizeof(uint16_t), code))
+      score += SCORE_COMMON;
+    else if (code >= 0xb0a1 && code <= 0xd7f9 && t >= 0xa1)
+      score += SCORE_PLAIN; // GB 2312 level 1 hanzi
+    else
+      score += SCORE_RARE;
+    i += 2;
+  }
+  return score;
+}
+
+static int score_cp949(const unsigned char *s, size_t size) {
+  int score = 0;
+  size_t i = 0;
+  while ((i = skip_ascii(s, i, size)) + 1 < size) {
+    unsigned c = s[i], t = s[i + 1];
+    if (c == 0x80 || c == 0xff || t < 0x41 || t > 0xfe ||
+        !tja_cp949_table_[c - 0x81][t - 0x41]) {
+      score += SCORE_INVALID;
+      i += 1;
+      continue;
+    }
+
+    unsigned code = c << 8 | t;
+    if (is_common(common_cp949, sizeof(common_cp949) / sizeof(uint16_t),
+                  code))
+      score += SCORE_COMMON;
+    else if (code >= 0xb0a1 && code <= 0xc8fe && t >= 0xa1)
+      score += SCORE_PLAIN; // KS X 1001 hangul
+    else
+      score += SCORE_RARE;
+    i += 2;
+  }
+  return score;
+}
+
+int tja_detect_unicode_(const char *buf, size_t size) {
+  const unsigned char *s = (const unsigned char *)buf;
+  if (size >= 2 && s[0] == 0xff && s[1] == 0xfe)
+    return TACO_ENCODING_UTF16LE;
+  if (size >= 2 && s[0] == 0xfe && s[1] == 0xff)
+    return TACO_ENCODING_UTF16BE;
+
+  // ASCII text in UTF-16 has every other byte NUL
+  size_t n = size < SAMPLE_SIZE ? size : SAMPLE_SIZE;
+  size_t zeros[2] = {0, 0};
+  for (size_t i = 0; i + 1 < n; i += 2) {
+    zeros[0] += s[i] == 0;
+    zeros[1] += s[i + 1] == 0;
+  }
+
+  size_t pairs = n / 2;
+  if (pairs >= 2 && zeros[1] * 2 >= pairs && zeros[0] * 8 < zeros[1])
+    return TACO_ENCODING_UTF16LE;
+  if (pairs >= 2 && zeros[0] * 2 >= pairs && zeros[1] * 8 < zeros[0])
+    return TACO_ENCODING_UTF16BE;
+  return TACO_ENCODING_UTF8;
+}
+
+int tja_detect_legacy_(const char *buf, size_t size) {
+  const unsigned char *s = (const unsigned char *)buf;
+  size_t n = size < SAMPLE_SIZE ? size : SAMPLE_SIZE;
+
+  // ties go to Shift_JIS, per TJA scene convention
+  int encoding = TACO_ENCODING_SHIFT_JIS;
+  int best = score_shiftjis(s, n);
+  int score = score_gb18030(s, n);
+  if (score > best) {
+    encoding = TACO_ENCODING_GB18030;
+    best = score;
+  }
+  if (score_cp949(s, n) > best)
+    encoding = TACO_ENCODING_EUC_KR;
+  return encoding;
+}
@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "tja/encoding.h"
+
+#include "alloc.h"
+#include "io.h"
+#include "taco.h"
+#include "tja/charsets.h"
+#include "tja/shiftjis.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define BUFFER_SIZE 16384 // page size of Apple silicon
+
+typedef struct tja_decoder_ tja_decoder;
+
+static int tja_decoder_destroy_(tja_decoder *self);
+static size_t tja_decoder_read_(char *restrict buf, size_t reserved,
+                                size_t count, tja_decoder *self);
+
+// Input is looked at in the buffer of the file read. Reads are served from
+// a window; valid UTF-8 is served from that buffer itself, and consumed once
+// read, while converted text is served from the output buffer.
+struct tja_decoder_ {
+  taco_allocator *alloc;
+  taco_file *file;
+  int *encoding;
+  tja_decode_fn_ *decode; // NULL while passing UTF-8 through
+  bool started;
+  size_t left;    // input left over after the last window
+  size_t pending; // input in the window
+
+  char *output;
+
+  const char *window;
+  size_t window_head;
+  size_t window_size;
+};
+
+static const taco_io tja_decoder_funcs_ = {
+    .version = sizeof(taco_io),
+    .close = (taco_close_fn *)tja_decoder_destroy_,
+    .read = (taco_read_fn *)tja_decoder_read_,
+};
+
+static tja_decoder *tja_decoder_create_(taco_allocator *alloc,
+                                        taco_file *file, int *encoding) {
+  tja_decoder *obj = taco_malloc_(alloc, sizeof(tja_decoder));
+  char *output =
+      taco_malloc_at_(alloc, 3 * BUFFER_SIZE, TACO_ALLOC_SITE_ICONV);
+
+  if (!obj || !output) {
+    taco_free_(alloc, output);
+    taco_free_(alloc, obj);
+    return NULL;
+  }
+
+  memset(obj, 0, sizeof(tja_decoder));
+  obj->alloc = alloc;
+  obj->file = file;
+  obj->encoding = encoding;
+  *encoding = TACO_ENCODING_UTF8;
+  obj->output = output;
+  return obj;
+}
+
+static int tja_decoder_destroy_(tja_decoder *self) {
+  taco_free_(self->alloc, self->output);
+  taco_free_(self->alloc, self);
+
+  // make the occasional user of fclose return value happy here
+  return 0;
+}
+
+taco_file *tja_decoder_open_(taco_allocator *alloc, taco_file *file,
+                             int *encoding) {
+  tja_decoder *obj = tja_decoder_create_(alloc, file, encoding);
+  if (!obj) {
+    return NULL;
+  }
+
+  taco_file *wrapper =
+      taco_file_open_(alloc, obj, taco_file_name_(file), &tja_decoder_funcs_);
+  if (!wrapper) {
+    tja_decoder_destroy_(obj);
+    return NULL;
+  }
+
+  // windows are buffered already
+  taco_file_set_block_size_(wrapper, 0);
+  return wrapper;
+}
+
+static void use(tja_decoder *self, int encoding) {
+  static tja_decode_fn_ *const decoders[] = {
+      [TACO_ENCODING_UTF16LE] = tja_utf16le_decode_,
+      [TACO_ENCODING_UTF16BE] = tja_utf16be_decode_,
+      [TACO_ENCODING_SHIFT_JIS] = tja_cp932_decode_,
+      [TACO_ENCODING_GB18030] = tja_gb18030_decode_,
+      [TACO_ENCODING_EUC_KR] = tja_cp949_decode_,
+  };
+
+  *self->encoding = encoding;
+  self->decode = decoders[encoding];
+}
+
+static void serve(tja_decoder *self, const char *window, size_t size) {
+  self->window = window;
+  self->window_head = 0;
+  self->window_size = size;
+}
+
+// Prepares the next window. Returns false at end of file.
+static bool convert(tja_decoder *self) {
+  taco_file_consume_(self->file, self->pending);
+  self->pending = 0;
+
+  while (1) {
+    // detection looks at all of the first buffer; afterwards, any input
+    // past what was left over will do
+    bool first = !self->started;
+    size_t want = first ? BUFFER_SIZE : self->left + 1;
+    size_t size;
+    const char *input = taco_file_peek_(self->file, want, &size);
+    bool eof = size < want;
+    self->started = true;
+    if (size == 0)
+      return false;
+
+    // UTF-16 can only be told from the start
+    if (first) {
+      int encoding = tja_detect_unicode_(input, size);
+      if (encoding != TACO_ENCODING_UTF8)
+        use(self, encoding);
+    }
+
+    if (!self->decode) {
+      bool truncated;
+      size_t valid = tja_utf8_prefix_(input, size, &truncated);
+      if (valid == size || (truncated && !eof)) {
+        // pass through; a truncated character waits for more input
+        self->left = size - valid;
+        if (valid == 0)
+          continue;
+        self->pending = valid;
+        serve(self, input, valid);
+        return true;
+      }
+
+      // text already passed on stays as it was, but an invalid first
+      // buffer is converted as a whole
+      if (first)
+        valid = 0;
+      use(self, tja_detect_legacy_(input + valid, size - valid));
+      if (valid) {
+        self->left = 0;
+        self->pending = valid;
+        serve(self, input, valid);
+        return true;
+      }
+    }
+
+    // output has room for a buffer of input at a time
+    if (size > BUFFER_SIZE) {
+      size = BUFFER_SIZE;
+      eof = false;
+    }
+
+    size_t consumed;
+    size_t count = self->decode(input, size, self->output, &consumed, eof);
+    taco_file_consume_(self->file, consumed);
+    self->left = size - consumed;
+    if (count) {
+      serve(self, self->output, count);
+      return true;
+    }
+  }
+}
+
+static size_t tja_decoder_read_(char *restrict buf, size_t reserved,
+                                size_t count, tja_decoder *self) {
+  if (self->window_head >= self->window_size && !convert(self))
+    return 0;
+
+  size_t available = self->window_size - self->window_head;
+  if (count > available)
+    count = available;
+  memcpy(buf, self->window + self->window_head, count);
+  self->window_head += count;
+  return count;
+}
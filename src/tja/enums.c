@@ -1,37 +1,16 @@
 // SPDX-License-Identifier: BSD-2-Clause
 #include "tja/metadata.h"
+#include "tja/keyword.h"
 
 #include "taco.h"
 #include <stdlib.h>
 #include <string.h>
 
-typedef struct enumerator_ {
-  const char text[28];
-  int integer;
-} enumerator;
-
-#define lenof_(a) (sizeof(a) / sizeof((a)[0]))
-
-static int cmp_enumerator_(const void *restrict kv, const void *restrict vv) {
-  const char *key = kv;
-  const enumerator *value = vv;
-  return strcmp(key, value->text);
-}
-
-static const int *lookup_enumerator_(const char *key, const enumerator *list,
-                                     size_t size) {
-  const enumerator *e =
-      bsearch(key, list, size, sizeof(enumerator), cmp_enumerator_);
-  if (!e)
-    return NULL;
-  return &(e->integer);
-}
-
 int tja_interpret_side_(const char *str) {
-  static const enumerator side_enum[] = {
-      {"Both", TACO_CLASS_EASY},   {"Ex", TACO_CLASS_EX_EASY},
-      {"Normal", TACO_CLASS_EASY}, {"both", TACO_CLASS_EASY},
-      {"ex", TACO_CLASS_EX_EASY},  {"normal", TACO_CLASS_EASY},
+  static const tja_keyword side_enum[TJA_KEYWORD_SLOTS] = {
+      TJA_KEYWORD_("BOTH", 'B', 'H', TACO_CLASS_EASY),
+      TJA_KEYWORD_("EX", 'E', 'X', TACO_CLASS_EX_EASY),
+      TJA_KEYWORD_("NORMAL", 'N', 'L', TACO_CLASS_EASY),
   };
 
   // numeric
@@ -40,20 +19,20 @@ int tja_interpret_side_(const char *str) {
     return TACO_CLASS_EX_EASY;
 
   // textual
-  const int *e = lookup_enumerator_(str, side_enum, lenof_(side_enum));
+  const tja_keyword *e = tja_keyword_find_(side_enum, str, strlen(str));
   if (e)
-    return *e;
+    return e->value;
 
   return TACO_CLASS_EASY;
 }
 
 int tja_interpret_course_(const char *str) {
-  static const enumerator course_enum[] = {
-      {"Easy", TACO_CLASS_EASY},     {"Edit", TACO_CLASS_EX},
-      {"Hard", TACO_CLASS_HARD},     {"Normal", TACO_CLASS_NORMAL},
-      {"Oni", TACO_CLASS_ONI},       {"easy", TACO_CLASS_EASY},
-      {"edit", TACO_CLASS_EX},       {"hard", TACO_CLASS_HARD},
-      {"normal", TACO_CLASS_NORMAL}, {"oni", TACO_CLASS_ONI},
+  static const tja_keyword course_enum[TJA_KEYWORD_SLOTS] = {
+      TJA_KEYWORD_("EASY", 'E', 'Y', TACO_CLASS_EASY),
+      TJA_KEYWORD_("EDIT", 'E', 'T', TACO_CLASS_EX),
+      TJA_KEYWORD_("HARD", 'H', 'D', TACO_CLASS_HARD),
+      TJA_KEYWORD_("NORMAL", 'N', 'L', TACO_CLASS_NORMAL),
+      TJA_KEYWORD_("ONI", 'O', 'I', TACO_CLASS_ONI),
   };
 
   static const int course_numeric[] = {
@@ -69,9 +48,9 @@ int tja_interpret_course_(const char *str) {
     return course_numeric[code];
 
   // textual
-  const int *e = lookup_enumerator_(str, course_enum, lenof_(course_enum));
+  const tja_keyword *e = tja_keyword_find_(course_enum, str, strlen(str));
   if (e)
-    return *e;
+    return e->value;
 
   return TACO_CLASS_ONI;
 }
@@ -34,23 +34,23 @@ static const taco_event note_types_[128] = {
 };
 
 int tja_events_push_note_(tja_parser *restrict parser,
-                          tja_events *restrict events, int note, int line) {
+                          tja_events *restrict events, int note,
+                          const tja_location *restrict loc) {
   taco_event e = note_types_[note >= 0 && note < 128 ? note : 127];
-  e.line = line;
 
   if (e.type == TACO_EVENT_NONE && e.detail_int.value != ACTUAL_NONE) {
-    tja_parser_diagnose_(parser, line, TJA_DIAG_WARN,
-                         "unrecognized note type '%c'", note);
+    tja_parser_diagnose_at_(parser, loc, TACO_DIAG_UNKNOWN_NOTE, note);
   }
 
-  int result = tja_events_push_event_(parser, events, &e);
+  int result = tja_events_push_event_(parser, events, &e, loc);
   events->units += 1;
   return result;
 }
 
 int tja_events_push_event_(tja_parser *restrict parser,
                            tja_events *restrict events,
-                           const taco_event *restrict event) {
+                           const taco_event *restrict event,
+                           const tja_location *restrict loc) {
   if (event->type == TACO_EVENT_NONE) {
     return 0;
   } else if (event->type == TACO_EVENT_TJA_LEVELHOLD) {
@@ -63,6 +63,11 @@ int tja_events_push_event_(tja_parser *restrict parser,
 
   taco_event e;
   memcpy(&e, event, sizeof(e));
+  e.line = loc->first_line;
   tja_event_set_timestamp_(&e, 0, events->units);
-  return taco_section_push_(events->events, &e);
+  if (taco_section_push_(events->events, &e) != 0)
+    return -1;
+
+  tja_set_source_(events->events, loc);
+  return 0;
 }
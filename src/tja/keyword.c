@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "tja/keyword.h"
+
+#include "tja.tab.h"
+#include <string.h>
+
+#define HEADER_(name, first, last, token, mode)                                \
+  TJA_KEYWORD_(name, first, last, token, mode, TJA_SCOPE_HEADER)
+#define BODY_(name, first, last, token)                                        \
+  TJA_KEYWORD_(name, first, last, token, TJA_MODE_BODY_COMMAND, TJA_SCOPE_BODY)
+
+const tja_keyword tja_header_keywords_[TJA_KEYWORD_SLOTS] = {
+    HEADER_("TITLE", 'T', 'E', TITLE, TJA_MODE_TEXT),
+    HEADER_("SUBTITLE", 'S', 'E', SUBTITLE, TJA_MODE_TEXT),
+    HEADER_("GENRE", 'G', 'E', GENRE, TJA_MODE_TEXT),
+    HEADER_("MAKER", 'M', 'R', MAKER, TJA_MODE_TEXT),
+    HEADER_("WAVE", 'W', 'E', AUDIO, TJA_MODE_TEXT),
+    HEADER_("BPM", 'B', 'M', BPM, TJA_MODE_NUMERIC),
+    HEADER_("OFFSET", 'O', 'T', OFFSET, TJA_MODE_NUMERIC),
+    HEADER_("DEMOSTART", 'D', 'T', DEMOSTART, TJA_MODE_NUMERIC),
+    HEADER_("SIDE", 'S', 'E', SIDE, TJA_MODE_TEXT),
+    HEADER_("COURSE", 'C', 'E', COURSE, TJA_MODE_TEXT),
+    HEADER_("LEVEL", 'L', 'L', LEVEL, TJA_MODE_NUMERIC),
+    HEADER_("STYLE", 'S', 'E', STYLE, TJA_MODE_TEXT),
+    HEADER_("SCOREINIT", 'S', 'T', SCOREINIT, TJA_MODE_NUMERIC),
+    HEADER_("SCOREDIFF", 'S', 'F', SCOREDIFF, TJA_MODE_NUMERIC),
+    HEADER_("BALLOON", 'B', 'N', BALLOON, TJA_MODE_NUMERIC),
+    HEADER_("BALLOONNOR", 'B', 'R', BALLOONNOR, TJA_MODE_NUMERIC),
+    HEADER_("BALLOONEXP", 'B', 'P', BALLOONEXP, TJA_MODE_NUMERIC),
+    HEADER_("BALLOONMAS", 'B', 'S', BALLOONMAS, TJA_MODE_NUMERIC),
+    HEADER_("NOTESDESIGNER", 'N', 'R', NOTESDESIGNER, TJA_MODE_TEXT),
+    HEADER_("NOTESDESIGNER0", 'N', '0', NOTESDESIGNER0, TJA_MODE_TEXT),
+    HEADER_("NOTESDESIGNER1", 'N', '1', NOTESDESIGNER1, TJA_MODE_TEXT),
+    HEADER_("NOTESDESIGNER2", 'N', '2', NOTESDESIGNER2, TJA_MODE_TEXT),
+    HEADER_("NOTESDESIGNER3", 'N', '3', NOTESDESIGNER3, TJA_MODE_TEXT),
+    HEADER_("NOTESDESIGNER4", 'N', '4', NOTESDESIGNER4, TJA_MODE_TEXT),
+};
+
+const tja_keyword tja_command_keywords_[TJA_KEYWORD_SLOTS] = {
+    TJA_KEYWORD_("PAPAMAMA", 'P', 'A', PAPAMAMA_CMD, TJA_MODE_COMMAND,
+                 TJA_SCOPE_HEADER),
+    TJA_KEYWORD_("START", 'S', 'T', START_CMD, TJA_MODE_BODY_PRETEXT,
+                 TJA_SCOPE_HEADER),
+    TJA_KEYWORD_("NMSCROLL", 'N', 'L', NMSCROLL_CMD, TJA_MODE_COMMAND,
+                 TJA_SCOPE_HEADER),
+    TJA_KEYWORD_("BMSCROLL", 'B', 'L', BMSCROLL_CMD, TJA_MODE_COMMAND,
+                 TJA_SCOPE_HEADER),
+    TJA_KEYWORD_("HBSCROLL", 'H', 'L', HBSCROLL_CMD, TJA_MODE_COMMAND,
+                 TJA_SCOPE_HEADER),
+    TJA_KEYWORD_("END", 'E', 'D', END_CMD, TJA_MODE_COMMAND, TJA_SCOPE_BODY),
+    BODY_("BRANCHSTART", 'B', 'T', BRANCHSTART_CMD),
+    BODY_("N", 'N', 'N', N_CMD),
+    BODY_("E", 'E', 'E', E_CMD),
+    BODY_("M", 'M', 'M', M_CMD),
+    BODY_("BRANCHEND", 'B', 'D', BRANCHEND_CMD),
+    BODY_("MEASURE", 'M', 'E', MEASURE_CMD),
+    BODY_("SECTION", 'S', 'N', SECTION_CMD),
+    BODY_("LEVELHOLD", 'L', 'D', LEVELHOLD_CMD),
+    BODY_("GOGOSTART", 'G', 'T', GOGOSTART_CMD),
+    BODY_("GOGOEND", 'G', 'D', GOGOEND_CMD),
+    BODY_("SCROLL", 'S', 'L', SCROLL_CMD),
+    BODY_("BPMCHANGE", 'B', 'E', BPMCHANGE_CMD),
+    BODY_("DELAY", 'D', 'Y', DELAY_CMD),
+    BODY_("BARLINEON", 'B', 'N', BARLINEON_CMD),
+    BODY_("BARLINEOFF", 'B', 'F', BARLINEOFF_CMD),
+    BODY_("BARLINE", 'B', 'E', BARLINE_CMD),
+    BODY_("SUDDEN", 'S', 'N', SUDDEN_CMD),
+    BODY_("DIRECTION", 'D', 'N', DIRECTION_CMD),
+    BODY_("JPOSSCROLL", 'J', 'L', JPOSSCROLL_CMD),
+};
+
+const tja_keyword *tja_keyword_find_(const tja_keyword *table,
+                                     const char *name, size_t size) {
+  if (size == 0 || size > TJA_KEYWORD_MAX)
+    return NULL;
+
+  char folded[TJA_KEYWORD_MAX];
+  for (size_t i = 0; i < size; ++i)
+    folded[i] = TJA_KEYWORD_FOLD_(name[i]);
+
+  const tja_keyword *k = &table[TJA_KEYWORD_HASH_(
+      size, (unsigned char)folded[0], (unsigned char)folded[size - 1])];
+  if (k->size != size || memcmp(k->name, folded, size) != 0)
+    return NULL;
+  return k;
+}
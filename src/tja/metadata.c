@@ -30,6 +30,7 @@ tja_metadata *tja_metadata_create2_(taco_allocator *a) {
   m->scoreinit = -1;
   m->scoreinit_s = -1;
   m->scorediff = -1;
+  m->scrollmode = -1;
   return m;
 }
 
@@ -125,6 +126,9 @@ int tja_metadata_update_(tja_metadata *meta, tja_metadata *updates) {
 
   if (updates->course != -1)
     meta->papamama = updates->papamama;
+  // scrolling is set for each course, like papamama
+  if (updates->course != -1 || updates->scrollmode != -1)
+    meta->scrollmode = updates->scrollmode;
 
   return 0;
 }
@@ -151,6 +155,8 @@ int tja_course_apply_metadata_(taco_course *course, tja_metadata *meta) {
   if (!isnan(meta->level))
     taco_course_set_level_(course, meta->level);
   taco_course_set_papamama_(course, meta->papamama);
+  if (meta->scrollmode != -1)
+    taco_course_set_scrollmode_(course, meta->scrollmode);
 
   if (meta->course_makers[taco_course_class(course)])
     taco_course_set_maker_(course,
@@ -186,9 +192,47 @@ int tja_course_apply_metadata_(taco_course *course, tja_metadata *meta) {
   meta->balloon_n = NULL;
   meta->balloon_a = NULL;
   meta->balloon_m = NULL;
+
+  // balloon counts are the last change to events
+  taco_course_cache_(course);
   return 0;
 }
 
+tja_metadata *tja_metadata_take_course_(tja_metadata *meta) {
+  tja_metadata *m = tja_metadata_create2_(meta->alloc);
+  if (!m)
+    return NULL;
+
+  m->course = meta->course;
+  m->level = meta->level;
+  m->papamama = meta->papamama;
+  m->scrollmode = meta->scrollmode;
+  m->scoreinit = meta->scoreinit;
+  m->scoreinit_s = meta->scoreinit_s;
+  m->scorediff = meta->scorediff;
+
+  bool copied = true;
+  if (meta->course_maker) {
+    m->course_maker = taco_strdup_(m->alloc, meta->course_maker);
+    copied = m->course_maker != NULL;
+  }
+  for (int i = 0; i < 8 && copied; ++i) {
+    if (meta->course_makers[i]) {
+      m->course_makers[i] = taco_strdup_(m->alloc, meta->course_makers[i]);
+      copied = m->course_makers[i] != NULL;
+    }
+  }
+  if (!copied) {
+    tja_metadata_free_(m);
+    return NULL;
+  }
+
+  move_balloon(m, meta, balloon_n);
+  move_balloon(m, meta, balloon_a);
+  move_balloon(m, meta, balloon_m);
+  return m;
+}
+
 #define SETTER_(field) set_##field##_
 #define MAKE_SETTER_(field, type)                                              \
   static int set_##field##_(tja_metadata *m, tja_metadata_field *f) {          \
@@ -227,6 +271,7 @@ MAKE_SETTER_(balloon_a, balloon);
 MAKE_SETTER_(balloon_m, balloon);
 MAKE_SETTER_(scorediff, integer);
 MAKE_SETTER_(papamama, integer);
+MAKE_SETTER_(scrollmode, integer);
 
 static int SETTER_(subtitle)(tja_metadata *m, tja_metadata_field *f) {
   if (strncmp("--", f->text, 2) == 0) {
@@ -276,6 +321,7 @@ static const metadata_setter setters[] = {
     [TJA_METADATA_SCOREINIT] = SETTER_(scoreinit),
     [TJA_METADATA_SCOREDIFF] = SETTER_(scorediff),
     [TJA_METADATA_PAPAMAMA] = SETTER_(papamama),
+    [TJA_METADATA_SCROLLMODE] = SETTER_(scrollmode),
 };
 
 static metadata_setter setter(int index) { return setters[index]; };
@@ -2,17 +2,28 @@
 #include "parser.h"
 
 #include "alloc.h"
-#include "config.h"
+#include "clock.h"
+#include "course.h"
+#include "courseset.h"
+#include "diagnostic.h"
 #include "io.h"
 #include "section.h"
 #include "taco.h"
 #include "tja.tab.h"
+#include "tja/charsets.h"
+#include "tja/encoding.h"
+#include "tja/metadata.h"
 #include "tja/parser.h"
+#include "tja/postproc.h"
+#include <stdbool.h>
 #include <string.h>
 
-#ifdef TACO_HAS_ICONV_
-#include "tja/shiftjis.h"
-#endif
+// input is held back for encoding detection until this much arrives, or a
+// line ends past the first SETTLE_SIZE bytes
+#define DETECT_SIZE 16384
+#define SETTLE_SIZE 64
+// tokens parsed between looks at the clock
+#define CLOCK_INTERVAL 64
 
 extern int tja_yylex_init(yyscan_t *scanner);
 extern int tja_yylex_destroy(yyscan_t scanner);
@@ -21,11 +32,77 @@ extern void tja_yyset_extra(void *data, yyscan_t scanner);
 extern void tja_yyset_debug(int debug, yyscan_t scanner);
 
 extern void tja_yyrestart(FILE *file, yyscan_t scanner);
+// discards lexer state left by a previous parse
+extern void tja_yyreset_(yyscan_t scanner);
+// continues lexing after the end of input, once there is more
+extern void tja_yyresume_(yyscan_t scanner);
+
+typedef struct tja_job_ tja_job;
+
+// A course awaiting post processing, and the metadata to apply to it after.
+// Passes are run one at a time: the branch passes on each branch in turn,
+// then the course passes.
+struct tja_job_ {
+  taco_course *course;
+  tja_metadata *metadata;
+  int branch;
+  size_t pass;
+  bool failed;        // a pass failed on the course
+  bool branch_failed; // a pass failed on the current branch
+};
+
+// Pushed input is queued raw, and read through the decoder as lines of it
+// complete. Lines end on a line feed, which never occurs within a character
+// except in UTF-16; there, a line feed of its own is looked for.
+//
+// Lexing stops between any two tokens when out of time. Once the lexer has
+// read all lines ready, it is idle, and resumed on lines arriving later.
+struct tja_push_ {
+  taco_allocator *alloc;
+  char *queue;
+  size_t head;  // start of input not yet read
+  size_t ready; // end of the last complete line
+  size_t scan;  // where to look for line ends next
+  size_t size;
+  size_t capacity;
+  int width;    // bytes per code unit; 0 until the encoding is known
+  int lf_index; // index of the line feed byte in a code unit
+  int encoding;
+  int status; // YYPUSH_MORE until the parse ends
+  bool idle;
+  taco_file *source;
+  taco_file *filter;
+  tja_yypstate *state;
+  tja_location location; // of the last token
+
+  // courses parsed, in order
+  tja_job *jobs;
+  size_t job_head;
+  size_t job_count;
+  size_t job_capacity;
+};
+
+static void tja_push_free_(tja_push *push);
+static size_t tja_push_read_(char *restrict buf, size_t reserved,
+                             size_t count, tja_push *self);
 
 static taco_parser_vfuncs vfuncs = {
     .free = (taco_parser_free_fn)tja_parser_free_,
     .parse = (taco_parser_parse_fn)tja_parser_parse_,
     .set_error = (taco_parser_seterror_fn)tja_parser_set_error_,
+    .set_timing = (taco_parser_settiming_fn)tja_parser_set_timing_,
+    .set_diagnostics =
+        (taco_parser_setdiagnostics_fn)tja_parser_set_diagnostics_,
+    .set_severity = (taco_parser_setseverity_fn)tja_parser_set_severity_,
+    .set_sources = (taco_parser_setsources_fn)tja_parser_set_sources_,
+    .feed = (taco_parser_feed_fn)tja_parser_feed_,
+    .step = (taco_parser_step_fn)tja_parser_step_,
+    .finish = (taco_parser_finish_fn)tja_parser_finish_,
+};
+
+static const taco_io tja_push_funcs_ = {
+    .version = sizeof(taco_io),
+    .read = (taco_read_fn *)tja_push_read_,
 };
 
 taco_parser *taco_parser_tja_create() {
@@ -68,6 +145,7 @@ tja_parser *tja_parser_create2_(taco_allocator *alloc) {
   parser->lexer = scanner;
   tja_yyset_extra(parser, scanner);
   parser->error_stream = error;
+  parser->severity = TACO_SEVERITY_NOTE;
 
   for (int i = 0; i < PURPOSE_MAX; ++i)
     parser->tmpsections[i] = taco_section_create2_(parser->alloc);
@@ -79,6 +157,9 @@ void tja_parser_free_(tja_parser *parser) {
   if (!parser)
     return;
 
+  // an unfinished parse still has values to free
+  if (parser->push)
+    taco_courseset_free(tja_parser_finish_(parser));
   tja_yylex_destroy(parser->lexer);
   taco_file_close_(parser->error_stream);
   for (int i = 0; i < PURPOSE_MAX; ++i)
@@ -86,45 +167,54 @@ void tja_parser_free_(tja_parser *parser) {
   taco_free_(parser->alloc, parser);
 }
 
+// Takes the courseset parsed, if parsing succeeded.
+static taco_courseset *end_parse_(tja_parser *parser, int errcode,
+                                  int encoding) {
+  tja_metadata_free_(parser->metadata);
+
+  if (errcode) {
+    taco_courseset_free(parser->set);
+    parser->set = NULL;
+  }
+
+  taco_courseset *set = parser->set;
+  parser->set = NULL;
+  parser->input = NULL;
+  if (set)
+    taco_courseset_set_encoding_(set, encoding);
+  return set;
+}
+
 taco_courseset *tja_parser_parse_(tja_parser *parser, taco_file *file) {
-  if (!file)
+  // courses parsed would be queued with those of the file being fed
+  if (!file || parser->push)
     return NULL;
 
-#ifdef TACO_HAS_ICONV_
-  // libtaco is expected to store all strings as UTF-8. The TJA frontend,
-  // when compiled with character set conversion support, supports UTF-8
-  // (with or without BOM) and Shift JIS as input encodings.
+  // libtaco is expected to store all strings as UTF-8. The TJA frontend
+  // supports UTF-8 (with or without BOM), UTF-16 and the legacy encodings
+  // Shift JIS, GB 18030 and EUC-KR as input encodings.
   //
-  // The input detection process is as follows:
+  // The input is read once through a decoder, which need not seek:
   //
-  //   - The input file is passed through a UTF-8 validator. If it is
-  //     valid, the file is passed to the parser as-is.
-  //   - If the input fails UTF-8 validation, the input is treated as
-  //     Shift JIS (most non UTF-8 TJA files are Shift JIS). A filter
-  //     is created to convert the input to UTF-8. The frontend does
-  //     not respect byte order marks (U+FEFF), and malformed UTF-8
-  //     files will appear as mojibake.
-  taco_file *filter = NULL;
-
-  if (tja_is_file_utf8_(file, parser->alloc)) {
-    parser->input = file;
-  } else {
-    filter = tja_iconv_open_(parser->alloc, file, "Shift_JIS");
-    if (!filter) {
-      tja_parser_diagnose_(parser, 0, TJA_DIAG_FATAL,
-                           "failed to create character set conversion filter");
-      return NULL;
-    }
-    parser->input = filter;
-  }
-#else
-  // Without support for character set conversion, the input is not
-  // processed. The user is warned of mojibake in this case.
-  tja_parser_diagnose_(
-      parser, 0, TJA_DIAG_NOTE,
-      "character set conversion not available; output may be unreadable");
+  //   - The first buffer of input is checked for UTF-16, by its byte order
+  //     mark or the NUL bytes of ASCII text. UTF-16 input is converted
+  //     as a whole.
+  //   - Otherwise, the first buffer is passed through a UTF-8 validator.
+  //     If it is valid, the input is passed to the parser as-is, and later
+  //     buffers are validated as the lexer reads them.
+  //   - From the first byte failing UTF-8 validation, the input is scored
+  //     against each legacy encoding and converted from the best match,
+  //     Shift JIS if in doubt (most non UTF-8 TJA files are Shift JIS). If
+  //     that byte is in the first buffer, the whole input is converted.
+  //     Malformed UTF-8 files will appear as mojibake.
+  int encoding;
+  taco_file *filter = tja_decoder_open_(parser->alloc, file, &encoding);
   parser->input = file;
-#endif
+  if (!filter) {
+    tja_parser_diagnose_(parser, 0, TACO_DIAG_NO_DECODER);
+    return NULL;
+  }
+  parser->input = filter;
 
 #ifdef YYDEBUG
   if (tja_yydebug)
@@ -132,22 +222,351 @@ taco_courseset *tja_parser_parse_(tja_parser *parser, taco_file *file) {
 #endif
 
   // parse
+  tja_yyreset_(parser->lexer);
+  parser->offset = 0;
+  parser->line_start = 0;
   int errcode = tja_yyparse(parser, parser->lexer);
-  tja_metadata_free_(parser->metadata);
+  taco_courseset *set = end_parse_(parser, errcode, encoding);
+  taco_file_close_(filter);
 
-  if (errcode) {
-    taco_courseset_free(parser->set);
-    parser->set = NULL;
+  // a failed read looks like the end of input to the lexer
+  if (taco_file_error_(file)) {
+    parser->input = file;
+    tja_parser_diagnose_(parser, 0, TACO_DIAG_READ_FAILED);
+    taco_courseset_free(set);
+    return NULL;
   }
 
-  taco_courseset *set = parser->set;
-  parser->set = NULL;
-  parser->input = NULL;
+  return set;
+}
+
+static int run_pass_(tja_parser *parser, const tja_pass *pass,
+                     void *target) {
+  if (parser->pass_hook)
+    return parser->pass_hook(parser->pass_hook_data, pass, parser, target);
+  return tja_pass_run_(pass, parser, target);
+}
+
+// Runs the next pass on a course. Returns true once none are left.
+static bool advance_(tja_parser *parser, tja_job *job) {
+  int branches = taco_course_branched(job->course) ? 3 : 1;
+
+  if (job->branch < branches) {
+    taco_section *branch =
+        taco_course_get_branch_mut_(job->course, TACO_SIDE_LEFT, job->branch);
+    if (!job->branch_failed)
+      job->branch_failed =
+          run_pass_(parser, &tja_branch_passes_[job->pass], branch) != 0;
+
+    if (++job->pass == tja_branch_pass_count_) {
+      job->failed = job->failed || job->branch_failed;
+      job->branch_failed = false;
+      job->branch += 1;
+      job->pass = 0;
+    }
+    return false;
+  }
+
+  if (job->pass < tja_course_pass_count_) {
+    if (!job->failed)
+      job->failed =
+          run_pass_(parser, &tja_course_passes_[job->pass], job->course) != 0;
+    job->pass += 1;
+    return false;
+  }
+
+  return true;
+}
+
+// Adds a course after post processing, unless it failed.
+static void complete_(tja_parser *parser, tja_job *job) {
+  if (!job->failed) {
+    tja_course_apply_metadata_(job->course, job->metadata);
+    taco_courseset_add_course_(parser->set, job->course);
+  } else {
+    taco_course_free_(job->course);
+  }
+}
+
+static int queue_job_(tja_push *push, const tja_job *job) {
+  if (push->job_count == push->job_capacity) {
+    size_t capacity = push->job_capacity ? push->job_capacity * 2 : 4;
+    tja_job *jobs =
+        taco_realloc_(push->alloc, push->jobs, capacity * sizeof(tja_job));
+    if (!jobs)
+      return -1;
+    push->jobs = jobs;
+    push->job_capacity = capacity;
+  }
+
+  push->jobs[push->job_count++] = *job;
+  return 0;
+}
+
+void tja_parser_add_course_(tja_parser *parser, taco_course *course) {
+  tja_job job = {.course = course, .metadata = parser->metadata};
+  if (!parser->push) {
+    while (!advance_(parser, &job))
+      continue;
+    complete_(parser, &job);
+    return;
+  }
+
+  // the metadata is as of now; later headers are for later courses
+  job.metadata = tja_metadata_take_course_(parser->metadata);
+  if (!job.metadata || queue_job_(parser->push, &job) != 0) {
+    tja_metadata_free_(job.metadata);
+    taco_course_free_(course);
+  }
+}
+
+// Post processes the next course for a pass. Returns false if there is no
+// course waiting.
+static bool process_(tja_parser *parser) {
+  tja_push *push = parser->push;
+  if (push->job_head == push->job_count)
+    return false;
+
+  tja_job *job = &push->jobs[push->job_head];
+  if (advance_(parser, job)) {
+    complete_(parser, job);
+    tja_metadata_free_(job->metadata);
+    if (++push->job_head == push->job_count) {
+      push->job_head = 0;
+      push->job_count = 0;
+    }
+  }
+  return true;
+}
+
+static tja_push *tja_push_create_(taco_allocator *alloc) {
+  tja_push *push = taco_malloc_(alloc, sizeof(tja_push));
+  if (!push)
+    return NULL;
+
+  memset(push, 0, sizeof(tja_push));
+  push->alloc = alloc;
+  push->status = YYPUSH_MORE;
+  push->idle = true;
+  push->source = taco_file_open_(alloc, push, "<stream>", &tja_push_funcs_);
+  if (push->source)
+    push->filter = tja_decoder_open_(alloc, push->source, &push->encoding);
+  push->state = tja_yypstate_new();
+  if (!push->filter || !push->state) {
+    tja_push_free_(push);
+    return NULL;
+  }
+
+  return push;
+}
+
+static void tja_push_free_(tja_push *push) {
+  for (size_t i = push->job_head; i < push->job_count; ++i) {
+    taco_course_free_(push->jobs[i].course);
+    tja_metadata_free_(push->jobs[i].metadata);
+  }
+  taco_free_(push->alloc, push->jobs);
+
+  if (push->state)
+    tja_yypstate_delete(push->state);
+  taco_file_close_(push->filter);
+  taco_file_close_(push->source);
+  taco_free_(push->alloc, push->queue);
+  taco_free_(push->alloc, push);
+}
+
+static size_t tja_push_read_(char *restrict buf, size_t reserved,
+                             size_t count, tja_push *self) {
+  size_t available = self->ready - self->head;
+  if (count > available)
+    count = available;
+  if (count)
+    memcpy(buf, self->queue + self->head, count);
+  self->head += count;
+  return count;
+}
 
-  if (filter) {
-    taco_file_close_(filter);
+static int start_push_(tja_parser *parser) {
+  tja_push *push = tja_push_create_(parser->alloc);
+  if (!push)
+    return -1;
+
+  parser->push = push;
+  parser->input = push->filter;
+
+#ifdef YYDEBUG
+  if (tja_yydebug)
+    tja_yyset_debug(1, parser->lexer);
+#endif
+
+  tja_yyreset_(parser->lexer);
+  parser->offset = 0;
+  parser->line_start = 0;
+  return 0;
+}
+
+// Checks if enough input is queued to tell UTF-16 from other encodings.
+static bool settled_(tja_push *push) {
+  // a byte order mark settles it at once
+  size_t mark = push->size < 2 ? push->size : 2;
+  if (push->size >= DETECT_SIZE ||
+      tja_detect_unicode_(push->queue, mark) != TACO_ENCODING_UTF8)
+    return true;
+
+  if (push->scan < SETTLE_SIZE)
+    push->scan = SETTLE_SIZE;
+  for (; push->scan < push->size; ++push->scan) {
+    char c = push->queue[push->scan];
+    if (c == '\n' || c == '\r')
+      return true;
   }
+  return false;
+}
+
+// Marks complete lines queued as ready to be read.
+static void find_lines_(tja_push *push) {
+  if (!push->width) {
+    if (!settled_(push))
+      return;
+
+    push->width = 1;
+    push->scan = 0;
+    int encoding = tja_detect_unicode_(push->queue, push->size);
+    if (encoding == TACO_ENCODING_UTF16LE) {
+      push->width = 2;
+    } else if (encoding == TACO_ENCODING_UTF16BE) {
+      push->width = 2;
+      push->lf_index = 1;
+    }
+  }
+
+  // lines end with a line feed or a carriage return
+  size_t end = push->size - push->size % push->width;
+  for (; push->scan < end; push->scan += push->width) {
+    const char *unit = push->queue + push->scan;
+    char c = unit[push->lf_index];
+    if ((c == '\n' || c == '\r') &&
+        (push->width == 1 || unit[1 - push->lf_index] == '\0'))
+      push->ready = push->scan + push->width;
+  }
+}
 
+static bool lexing_(tja_push *push) {
+  return !push->idle || push->head < push->ready;
+}
+
+// Lexes and parses the lines ready, until the deadline if nonzero, or a
+// course is parsed. At the end of input, the parse is ended as well.
+static void lex_(tja_parser *parser, bool end, uint64_t deadline) {
+  tja_push *push = parser->push;
+  size_t jobs = push->job_count;
+
+  for (unsigned i = 1; push->status == YYPUSH_MORE; ++i) {
+    TJA_YYSTYPE value;
+    if (lexing_(push)) {
+      if (push->idle) {
+        taco_file_resume_(push->source);
+        taco_file_resume_(push->filter);
+        tja_yyresume_(parser->lexer);
+        push->idle = false;
+      }
+
+      int token = tja_yylex(&value, &push->location, parser->lexer);
+      if (token == 0) {
+        push->idle = true;
+        continue;
+      }
+      push->status = tja_yypush_parse(push->state, token, &value,
+                                      &push->location, parser, parser->lexer);
+    } else if (end) {
+      push->status = tja_yypush_parse(push->state, 0, &value,
+                                      &push->location, parser, parser->lexer);
+    } else {
+      break;
+    }
+
+    if (push->job_count != jobs && deadline)
+      break;
+    if (deadline && i % CLOCK_INTERVAL == 0 && taco_clock_ns_() >= deadline)
+      break;
+  }
+
+  // lines read are dropped
+  if (push->head)
+    memmove(push->queue, push->queue + push->head, push->size - push->head);
+  push->size -= push->head;
+  push->ready -= push->head;
+  push->scan -= push->head;
+  push->head = 0;
+}
+
+int tja_parser_feed_(tja_parser *parser, const void *bytes, size_t size) {
+  if (!parser->push && start_push_(parser) != 0)
+    return -1;
+  tja_push *push = parser->push;
+  if (push->status != YYPUSH_MORE)
+    return -1;
+
+  if (push->size + size > push->capacity) {
+    size_t capacity = push->capacity ? push->capacity : DETECT_SIZE;
+    while (capacity < push->size + size)
+      capacity *= 2;
+    char *queue = taco_realloc_at_(push->alloc, push->queue, capacity,
+                                   TACO_ALLOC_SITE_IO);
+    if (!queue)
+      return -1;
+    push->queue = queue;
+    push->capacity = capacity;
+  }
+  memcpy(push->queue + push->size, bytes, size);
+  push->size += size;
+
+  find_lines_(push);
+  return 0;
+}
+
+int tja_parser_step_(tja_parser *parser, uint64_t budget) {
+  tja_push *push = parser->push;
+  if (!push)
+    return 0;
+
+  // a step does at least one pass or a few tokens, however small the budget
+  uint64_t deadline = taco_clock_ns_() + budget;
+  do {
+    if (push->status != YYPUSH_MORE)
+      return -1;
+
+    // finishing courses first keeps few of them waiting
+    if (!process_(parser)) {
+      if (!lexing_(push))
+        return 0;
+      lex_(parser, false, deadline);
+    }
+  } while (taco_clock_ns_() < deadline);
+
+  bool more = push->job_head < push->job_count || lexing_(push);
+  return more ? TACO_STEP_MORE : 0;
+}
+
+taco_courseset *tja_parser_finish_(tja_parser *parser) {
+  if (!parser->push && start_push_(parser) != 0)
+    return NULL;
+  tja_push *push = parser->push;
+
+  // the last line needs no line feed
+  push->ready = push->size;
+  if (push->status == YYPUSH_MORE)
+    lex_(parser, true, 0);
+  if (push->status == 0) {
+    while (process_(parser))
+      continue;
+  }
+
+  taco_courseset *set = end_parse_(parser, push->status, push->encoding);
+  if (set)
+    taco_courseset_set_filename_(set, taco_file_name_(push->filter));
+  parser->push = NULL;
+  tja_push_free_(push);
   return set;
 }
 
@@ -161,30 +580,131 @@ int tja_parser_set_error_(tja_parser *parser, taco_file *file) {
   return 0;
 }
 
-void tja_parser_diagnose_(tja_parser *parser, int line, int level,
-                          const char *format, ...) {
-  const char *const templates[] = {
+int tja_parser_set_timing_(tja_parser *parser, int timing) {
+  if (timing != TACO_TIMING_TICKS && timing != TACO_TIMING_RATIONAL)
+    return -1;
+  parser->timing = timing;
+  return 0;
+}
+
+int tja_parser_timing_(tja_parser *parser) { return parser->timing; }
+
+void tja_parser_set_pass_hook_(tja_parser *parser, tja_pass_hook_fn *hook,
+                               void *data) {
+  parser->pass_hook = hook;
+  parser->pass_hook_data = data;
+}
+
+int tja_parser_set_diagnostics_(tja_parser *parser,
+                                taco_diagnostic_fn *callback, void *data) {
+  parser->diagnostic_fn = callback;
+  parser->diagnostic_data = data;
+  return 0;
+}
+
+int tja_parser_set_severity_(tja_parser *parser, int severity) {
+  if (severity < TACO_SEVERITY_FATAL || severity > TACO_SEVERITY_NOTE)
+    return -1;
+  parser->severity = severity;
+  return 0;
+}
+
+int tja_parser_set_sources_(tja_parser *parser, int track) {
+  for (int i = 0; i < PURPOSE_MAX; ++i) {
+    if (taco_section_track_sources_(parser->tmpsections[i], track) != 0)
+      return -1;
+  }
+  parser->sources = track != 0;
+  return 0;
+}
+
+void tja_parser_locate_(tja_parser *parser, tja_location *loc,
+                        const char *text, size_t size, int line) {
+  loc->first_line = line;
+  loc->last_line = line;
+  loc->offset = parser->offset;
+  parser->offset += size;
+
+  // only tokens ending a line have line feeds, as the last character
+  if (size != 0 && text[size - 1] == '\n') {
+    parser->line_start = parser->offset;
+    loc->first_column = 1;
+  } else {
+    loc->first_column = (int)(loc->offset - parser->line_start) + 1;
+  }
+  loc->last_column = loc->first_column;
+}
+
+void tja_set_source_(taco_section *section, const tja_location *loc) {
+  taco_source source = {
+      .offset = loc->offset,
+      .line = loc->first_line,
+      .column = loc->first_column,
+  };
+  taco_section_set_last_source_(section, &source);
+}
+
+// Diagnostics dropped cost no more than this check.
+static bool wanted_(tja_parser *parser, int code) {
+  return taco_diagnostic_severity_of_(code) <= parser->severity &&
+         (parser->diagnostic_fn || parser->error_stream);
+}
+
+static void report_(tja_parser *parser, const taco_diagnostic *diag) {
+  static const char *const templates[] = {
       "%s:%d: fatal error: %s\n",
       "%s:%d: error: %s\n",
       "%s:%d: warning: %s\n",
       "%s:%d: info: %s\n",
   };
+
+  if (parser->diagnostic_fn) {
+    parser->diagnostic_fn(diag, parser->diagnostic_data);
+    return;
+  }
+
+  // forward to error output; long messages only come from long names
+  char buf[256];
+  char *formatted = buf;
+  size_t size = taco_diagnostic_format(diag, buf, sizeof(buf)) + 1;
+  if (size > sizeof(buf)) {
+    formatted =
+        taco_malloc_at_(parser->alloc, size, TACO_ALLOC_SITE_DIAGNOSTIC);
+    if (!formatted)
+      return;
+    taco_diagnostic_format(diag, formatted, size);
+  }
+
+  taco_file_printf_(parser->error_stream, templates[diag->severity],
+                    diag->file, diag->line, formatted);
+  if (formatted != buf)
+    taco_free_(parser->alloc, formatted);
+}
+
+void tja_parser_diagnose_(tja_parser *parser, int line, int code, ...) {
+  if (!wanted_(parser, code))
+    return;
+
+  taco_diagnostic diag;
   va_list ap;
+  va_start(ap, code);
+  taco_diagnostic_init_(&diag, code, taco_file_name_(parser->input), line, ap);
+  va_end(ap);
+  report_(parser, &diag);
+}
+
+void tja_parser_diagnose_at_(tja_parser *parser, const tja_location *loc,
+                             int code, ...) {
+  if (!wanted_(parser, code))
+    return;
 
-  // format input
-  va_start(ap, format);
-  int size = vsnprintf(NULL, 0, format, ap) + 1;
+  taco_diagnostic diag;
+  va_list ap;
+  va_start(ap, code);
+  taco_diagnostic_init_(&diag, code, taco_file_name_(parser->input),
+                        loc->first_line, ap);
   va_end(ap);
-  char *formatted = taco_malloc_(parser->alloc, size);
-  if (formatted) {
-    va_start(ap, format);
-    vsnprintf(formatted, size, format, ap);
-    va_end(ap);
-  }
-
-  // forward to error output
-  if (formatted)
-    taco_file_printf_(parser->error_stream, templates[level],
-                      taco_file_name_(parser->input), line, formatted);
-  taco_free_(parser->alloc, formatted);
+  diag.column = loc->first_column;
+  diag.offset = loc->offset;
+  report_(parser, &diag);
 }
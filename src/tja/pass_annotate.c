@@ -132,6 +132,8 @@ static void process_event_(taco_section *branch, size_t i,
       state->next_bpm = e->detail_float.value;
     else if (e->type == TACO_EVENT_SCROLL)
       state->hi_speed = e->detail_float.value;
+    else if (e->type == TACO_EVENT_SCROLL_COMPLEX)
+      state->hi_speed = hypot(e->scroll_complex.x, e->scroll_complex.y);
     return;
   } else if (e->type != TACO_EVENT_DON && e->type != TACO_EVENT_KAT) {
     // non-annotatable notes.
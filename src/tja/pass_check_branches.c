@@ -45,12 +45,10 @@ int tja_pass_check_branches_(tja_parser *parser, taco_course *course) {
         if (j == taco_section_end(timing) || i->time != j->time ||
             i->type != j->type ||
             i->detail_float.value != j->detail_float.value) {
-          tja_parser_diagnose_(parser, i->line, TJA_DIAG_ERROR,
-                               "timing of branch %s diverges from master",
-                               branch_names_[b]);
+          tja_parser_diagnose_(parser, i->line, TACO_DIAG_BRANCH_DIVERGES,
+                               branch_names_[b], "master");
           if (j != taco_section_end(timing))
-            tja_parser_diagnose_(parser, j->line, TJA_DIAG_NOTE,
-                                 "last timing event in master here");
+            tja_parser_diagnose_(parser, j->line, TACO_DIAG_LAST_TIMING);
           error = -1;
           goto check_loop_end;
         }
@@ -59,12 +57,10 @@ int tja_pass_check_branches_(tja_parser *parser, taco_course *course) {
       case TACO_EVENT_MEASURE:
         if (j == taco_section_end(timing) || i->time != j->time ||
             i->type != j->type || !i->measure.real) {
-          tja_parser_diagnose_(parser, i->line, TJA_DIAG_ERROR,
-                               "timing of branch %s diverges from master",
-                               branch_names_[b]);
+          tja_parser_diagnose_(parser, i->line, TACO_DIAG_BRANCH_DIVERGES,
+                               branch_names_[b], "master");
           if (j != taco_section_end(timing))
-            tja_parser_diagnose_(parser, j->line, TJA_DIAG_NOTE,
-                                 "last timing event in master here");
+            tja_parser_diagnose_(parser, j->line, TACO_DIAG_LAST_TIMING);
           error = -1;
           goto check_loop_end;
         }
@@ -74,9 +70,8 @@ int tja_pass_check_branches_(tja_parser *parser, taco_course *course) {
     }
   check_loop_end:
     if (j != taco_section_end(timing)) {
-      tja_parser_diagnose_(parser, j->line, TJA_DIAG_ERROR,
-                           "timing of branch master diverges from %s",
-                           branch_names_[b]);
+      tja_parser_diagnose_(parser, j->line, TACO_DIAG_BRANCH_DIVERGES,
+                           "master", branch_names_[b]);
       error = -1;
     }
   }
@@ -32,8 +32,8 @@ int tja_pass_checkpoint_rolls_(tja_parser *parser, taco_section *branch) {
         break;
       default:
         // warn and delete the drum roll head
-        tja_parser_diagnose_(parser, head->line, TJA_DIAG_WARN,
-                             "drum roll does not terminate");
+        tja_parser_diagnose_(parser, head->line,
+                             TACO_DIAG_UNTERMINATED_ROLL);
         head->type = TACO_EVENT_NONE;
         head = NULL;
         break;
@@ -55,8 +55,7 @@ int tja_pass_checkpoint_rolls_(tja_parser *parser, taco_section *branch) {
 
   if (head) {
     // warn and delete the drum roll head
-    tja_parser_diagnose_(parser, head->line, TJA_DIAG_WARN,
-                         "drum roll does not terminate");
+    tja_parser_diagnose_(parser, head->line, TACO_DIAG_UNTERMINATED_ROLL);
     head->type = TACO_EVENT_NONE;
   }
 
@@ -4,32 +4,19 @@
 #include "note.h"
 #include "section.h"
 #include "taco.h"
-#include <stdlib.h>
-
-// Compare two events, but none events always compare greater than others.
-// At the end of sorting, this should cause none events to be all moved to
-// the back.
-static int cmp(taco_event *a, taco_event *b) {
-  int result = (a->type == TACO_EVENT_NONE) - (b->type == TACO_EVENT_NONE);
-  if (result == 0)
-    result = taco_event_compare(a, b);
-  return result;
-}
 
 int tja_pass_cleanup_(tja_parser *parser, taco_section *branch) {
-  // sort events
-  qsort(taco_section_begin_mut_(branch), taco_section_size(branch),
-        sizeof(taco_event), (int (*)(const void *, const void *))cmp);
+  // sort events; none events are moved to the back
+  if (taco_section_sort_(branch) != 0)
+    return -1;
 
   // pop none events
   int none_count = 0;
   const taco_event *i = taco_section_end(branch);
-  while ((--i)->type == TACO_EVENT_NONE)
+  while (i != taco_section_begin(branch) && (--i)->type == TACO_EVENT_NONE)
     none_count += 1;
   taco_section_pop_(branch, none_count);
 
-  // set up data to allow lookup of time in seconds
-  taco_section_cache_seconds_(branch);
-
+  // caches are built by taco_course_cache_ once the course is complete
   return 0;
 }
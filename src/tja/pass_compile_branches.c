@@ -83,7 +83,8 @@ static void calculate_stats(threshold_stats *stats,
 }
 
 static void compile_branch(taco_section *new_events,
-                           const threshold_stats *stats, int line) {
+                           const threshold_stats *stats, int line,
+                           const taco_source *source) {
   int threshold_a = 0;
   int threshold_m = 0;
   threshold_calc[stats->branch_type](stats, &threshold_a, &threshold_m);
@@ -109,6 +110,14 @@ static void compile_branch(taco_section *new_events,
       },
   };
   taco_section_push_many_(new_events, branch_events, 3);
+
+  // the branch comes from its #BRANCHSTART
+  taco_source *sources = taco_section_sources_mut_(new_events);
+  if (sources && source) {
+    size_t size = taco_section_size(new_events);
+    for (size_t n = size - 3; n < size; ++n)
+      sources[n] = *source;
+  }
 }
 
 int tja_pass_compile_branches_(tja_parser *parser, taco_section *branch) {
@@ -118,6 +127,9 @@ int tja_pass_compile_branches_(tja_parser *parser, taco_section *branch) {
 
   taco_section *new_events =
       taco_section_create2_(tja_parser_allocator_(parser));
+  taco_source *sources = taco_section_sources_mut_(branch);
+  if (sources)
+    taco_section_track_sources_(new_events, true);
 
   taco_section_foreach_mut_(i, branch) {
     switch (taco_event_type(i)) {
@@ -146,8 +158,7 @@ int tja_pass_compile_branches_(tja_parser *parser, taco_section *branch) {
 
       if (stats.check_time <= stats.start->time) {
         // not enough time for a proper check time. diagnosing.
-        tja_parser_diagnose_(parser, i->line, TJA_DIAG_WARN,
-                             "not enough time before #BRANCHSTART");
+        tja_parser_diagnose_(parser, i->line, TACO_DIAG_BRANCH_TOO_EARLY);
         // fallback to a sane time; end time is later because the internal
         // representation sorts branch checks before branch starts
         stats.check_time = stats.start->time + 1;
@@ -156,7 +167,9 @@ int tja_pass_compile_branches_(tja_parser *parser, taco_section *branch) {
       // calculate number of notes from start time to check time
       calculate_stats(&stats, branch);
       // compile branch
-      compile_branch(new_events, &stats, i->line);
+      compile_branch(new_events, &stats, i->line,
+                     sources ? &sources[i - taco_section_begin(branch)]
+                             : NULL);
 
       i->type = TACO_EVENT_NONE;
       memset(&stats, 0, sizeof(stats));
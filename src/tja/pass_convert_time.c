@@ -6,35 +6,91 @@
 #include "taco.h"
 #include "tja/timestamp.h"
 #include <assert.h>
-
-static int pass_extract_tickrate(tja_parser *parser, taco_section *branch);
-static void pass_convert(taco_section *branch);
+#include <limits.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Highly composite tickrate used when exact timing does not fit. Keeps
+// subdivisions up to 128ths and most tuplets exact.
+#define FALLBACK_TICKRATE (128 * 9 * 5 * 7 * 11 * 13)
+#define MIN_TICKRATE 96
+
+// Factors dropped in turn from the fallback tickrate while the course is
+// too long for it. Rarer tuplets go first, and every step divides the last
+// exactly, down to 96 ticks for 32nds and triplets.
+static const int fallback_steps[] = {13, 11, 7, 5, 3, 2, 2};
+
+static int pass_extract_tickrate(tja_parser *parser, taco_section *branch,
+                                 int64_t *tickrate, int *line);
+static int64_t timeline_length(taco_section *branch, int64_t tickrate);
+static void pass_convert(taco_section *branch, taco_position *positions);
 static void pass_remove_excess_factors(taco_section *branch);
 
-static int gcd(int x, int y);
-static int lcm(int x, int y);
+static int64_t gcd(int64_t x, int64_t y);
+static int64_t lcm(int64_t x, int64_t y);
 
 int tja_pass_convert_time_(tja_parser *parser, taco_section *branch) {
-  if (pass_extract_tickrate(parser, branch) != 0)
+  // rational timing keeps exact positions; ticks need not be exact, so
+  // the tickrate is not searched for
+  bool rational = tja_parser_timing_(parser) == TACO_TIMING_RATIONAL;
+  int64_t tickrate = 0;
+  int line = 0;
+  if (pass_extract_tickrate(parser, branch, rational ? NULL : &tickrate,
+                            &line) != 0)
     return -1;
 
-  pass_convert(branch);
-  pass_remove_excess_factors(branch);
+  taco_position *positions = NULL;
+  if (rational) {
+    if (taco_section_track_positions_(branch) != 0)
+      return -1;
+    positions = taco_section_positions_mut_(branch);
+  }
+
+  if (tickrate == 0 || timeline_length(branch, tickrate) > INT_MAX) {
+    // no exact tickrate fits; round to a fixed one instead
+    tickrate = FALLBACK_TICKRATE;
+    size_t step = 0;
+    while (timeline_length(branch, tickrate) > INT_MAX &&
+           step < sizeof(fallback_steps) / sizeof(*fallback_steps))
+      tickrate /= fallback_steps[step++];
+
+    if (timeline_length(branch, tickrate) > INT_MAX) {
+      tja_parser_diagnose_(parser, line, TACO_DIAG_TOO_LONG);
+      return -1;
+    }
+
+    if (!rational)
+      tja_parser_diagnose_(parser, line, TACO_DIAG_ROUNDED, (int)tickrate);
+  }
+
+  taco_section_set_tickrate_(branch, tickrate);
+  pass_convert(branch, positions);
+
+  // keep the tickrate fixed across branches under rational timing
+  if (!rational)
+    pass_remove_excess_factors(branch);
   return 0;
 }
 
-static int pass_extract_tickrate(tja_parser *parser, taco_section *branch) {
-  // ticks per 4/4 measure
-  int tickrate = 96;
-  int dividend = 4;
-  int divisor = 4;
+// Gets the tickrate representing all events exactly, or 0 if it does not
+// fit in an int. The line of the measure causing the overflow is stored.
+// Only checks measure lengths if result is NULL.
+static int pass_extract_tickrate(tja_parser *parser, taco_section *branch,
+                                 int64_t *result, int *line) {
+  // ticks per 4/4 measure; 0 stops the search
+  int64_t tickrate = result ? 96 : 0;
+  int64_t dividend = 4;
+  int64_t divisor = 4;
 
   taco_section_foreach(i, branch) {
-    if (i->type == TACO_EVENT_MEASURE && i->measure.tja_units != 0) {
+    if (tickrate != 0 && i->type == TACO_EVENT_MEASURE &&
+        i->measure.tja_units != 0 && dividend > 0 && divisor > 0) {
       // calculate units required for 4/4 signature
-      int units = lcm(i->measure.tja_units * divisor, dividend);
+      int64_t units = lcm(i->measure.tja_units * divisor, dividend);
       // multiply tickrate with missing factors
       tickrate = lcm(tickrate, units);
+      if (tickrate == 0)
+        *line = i->line;
     }
 
     if (i->type == TACO_EVENT_TJA_MEASURE_LENGTH) {
@@ -43,76 +99,140 @@ static int pass_extract_tickrate(tja_parser *parser, taco_section *branch) {
         dividend = i->tja_measure_length.dividend;
         divisor = i->tja_measure_length.divisor;
       } else {
-        tja_parser_diagnose_(parser, i->line, TJA_DIAG_ERROR,
-                             "division by zero in #MEASURE");
+        tja_parser_diagnose_(parser, i->line, TACO_DIAG_DIVISION_BY_ZERO);
         return -1;
       }
     }
   }
 
-  taco_section_set_tickrate_(branch, tickrate);
+  if (result)
+    *result = tickrate;
   return 0;
 }
 
-static void pass_convert(taco_section *branch) {
-  int start = 0;
-  int measure_ticks = taco_section_tickrate(branch);
+static int64_t measure_ticks(int64_t tickrate, const taco_event *e) {
+  return tickrate * e->tja_measure_length.dividend /
+         e->tja_measure_length.divisor;
+}
+
+// Gets the number of ticks required for the entire branch.
+static int64_t timeline_length(taco_section *branch, int64_t tickrate) {
+  int64_t start = 0;
+  int64_t length = tickrate;
   int current_measure = 0;
-  int units = 4;
+
+  taco_section_foreach(i, branch) {
+    if (tja_event_measure_(i) != current_measure) {
+      start += length;
+      current_measure = tja_event_measure_(i);
+      if (start > INT_MAX)
+        return start;
+    }
+
+    if (i->type == TACO_EVENT_TJA_MEASURE_LENGTH) {
+      length = measure_ticks(tickrate, i);
+      if (length < 0)
+        length = 0;
+    }
+  }
+
+  return start + length;
+}
+
+static void pass_convert(taco_section *branch, taco_position *positions) {
+  int64_t start = 0;
+  int64_t tickrate = taco_section_tickrate(branch);
+  int64_t length = tickrate;
+  int current_measure = 0;
+  int64_t units = 4;
+  // exact length in whole notes
+  int64_t dividend = 1;
+  int64_t divisor = 1;
 
   taco_section_foreach_mut_(i, branch) {
     // new measure
     if (tja_event_measure_(i) != current_measure) {
-      start = start + measure_ticks;
+      start = start + length;
       current_measure = tja_event_measure_(i);
       units = 1;
     }
 
-    // barline
+    int64_t u = tja_event_unit_(i);
+
+    if (i->type == TACO_EVENT_TJA_MEASURE_LENGTH) {
+      assert((u == 0));
+      length = measure_ticks(tickrate, i);
+      if (length < 0)
+        length = 0;
+      dividend = i->tja_measure_length.dividend;
+      divisor = i->tja_measure_length.divisor;
+      if (divisor < 0) {
+        dividend = -dividend;
+        divisor = -divisor;
+      }
+      if (dividend < 0)
+        dividend = 0;
+      i->type = TACO_EVENT_NONE;
+    }
+
+    // barline; measure length events come before it in a measure
     if (i->type == TACO_EVENT_MEASURE) {
       if (i->measure.tja_units)
         units = i->measure.tja_units;
-      i->measure.tja_units = 0;
+      i->measure.ticks = length;
     }
 
-    int u = tja_event_unit_(i);
+    // exact unless the fallback tickrate is in use; round to nearest then
+    i->time = start + (2 * length * u + units) / (2 * units);
 
-    if (i->type == TACO_EVENT_TJA_MEASURE_LENGTH) {
-      assert((u == 0));
-      measure_ticks =
-          (taco_section_tickrate(branch) / i->tja_measure_length.divisor) *
-          i->tja_measure_length.dividend;
-      i->type = TACO_EVENT_NONE;
-    }
+    if (positions) {
+      int64_t g = gcd(u, units);
+      taco_position *p = &positions[i - taco_section_begin(branch)];
+      p->measure = current_measure;
+      p->num = u / g;
+      p->den = units / g;
 
-    i->time = start + (measure_ticks / units) * u;
+      if (i->type == TACO_EVENT_MEASURE) {
+        g = gcd(dividend, divisor);
+        p->length_num = dividend / g;
+        p->length_den = divisor / g;
+      }
+    }
   }
 }
 
 static void pass_remove_excess_factors(taco_section *branch) {
   int divisor = 0;
 
-  taco_section_foreach(i, branch) divisor =
-      gcd(i->time, divisor); // impl detail: gcd(x, 0) = x
+  taco_section_foreach(i, branch) {
+    divisor = gcd(i->time, divisor); // impl detail: gcd(x, 0) = x
+    if (i->type == TACO_EVENT_MEASURE)
+      divisor = gcd(i->measure.ticks, divisor);
+  }
 
   // ensure a minimum tickrate of 96
   if (divisor == 0) {
     // there are no objects other than on time 0
-    taco_section_set_tickrate_(branch, 96);
+    taco_section_set_tickrate_(branch, MIN_TICKRATE);
     return;
-  } else if (taco_section_tickrate(branch) / divisor < 96) {
-    divisor = taco_section_tickrate(branch) / lcm(divisor, 96);
+  } else if (taco_section_tickrate(branch) / divisor < MIN_TICKRATE) {
+    int64_t l = lcm(divisor, MIN_TICKRATE);
+    divisor = l ? taco_section_tickrate(branch) / l : 1;
   }
 
   if (divisor > 1) {
     taco_section_set_tickrate_(branch, taco_section_tickrate(branch) / divisor);
-    taco_section_foreach_mut_(i, branch) i->time /= divisor;
+    taco_section_foreach_mut_(i, branch) {
+      i->time /= divisor;
+      if (i->type == TACO_EVENT_MEASURE)
+        i->measure.ticks /= divisor;
+    }
   }
 }
 
-static int gcd(int x, int y) {
+static int64_t gcd(int64_t x, int64_t y) {
   while (y != 0) {
-    int z = y;
+    int64_t z = y;
     y = x % y;
     x = z;
   }
@@ -120,4 +240,12 @@ static int gcd(int x, int y) {
   return x;
 }
 
-static int lcm(int x, int y) { return (x * y) / gcd(x, y); }
+// Gets the least common multiple of two positive numbers, or 0 if it
+// exceeds INT_MAX.
+static int64_t lcm(int64_t x, int64_t y) {
+  if (x <= 0 || y <= 0 || x > INT_MAX || y > INT_MAX)
+    return 0;
+
+  int64_t result = x / gcd(x, y) * y;
+  return result <= INT_MAX ? result : 0;
+}
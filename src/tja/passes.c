@@ -0,0 +1,31 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "tja/postproc.h"
+
+#include "taco.h"
+#include "tja/parser.h"
+
+const tja_pass tja_branch_passes_[] = {
+    {"convert_time", tja_pass_convert_time_, NULL},
+    {"checkpoint_rolls", tja_pass_checkpoint_rolls_, NULL},
+    {"barlines", tja_pass_barlines_, NULL},
+    {"compile_branches", tja_pass_compile_branches_, NULL},
+    {"prepend_bgm", tja_pass_prepend_bgm_, NULL},
+    {"cleanup", tja_pass_cleanup_, NULL},
+    {"annotate", tja_pass_annotate_, NULL},
+};
+
+const size_t tja_branch_pass_count_ =
+    sizeof(tja_branch_passes_) / sizeof(tja_pass);
+
+const tja_pass tja_course_passes_[] = {
+    {"check_branches", NULL, tja_pass_check_branches_},
+};
+
+const size_t tja_course_pass_count_ =
+    sizeof(tja_course_passes_) / sizeof(tja_pass);
+
+int tja_pass_run_(const tja_pass *pass, tja_parser *parser, void *target) {
+  if (pass->branch)
+    return pass->branch(parser, target);
+  return pass->course(parser, target);
+}
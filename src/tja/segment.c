@@ -5,6 +5,7 @@
 #include "section.h"
 #include "taco.h"
 #include "tja/events.h"
+#include "tja/parser.h"
 #include "tja/timestamp.h"
 #include <stddef.h>
 
@@ -15,12 +16,13 @@ int tja_segment_init_(tja_segment *segment, taco_section *buf) {
   return buf != NULL;
 }
 
-int tja_segment_push_barline_(tja_segment *segment, int units, int line) {
+int tja_segment_push_barline_(tja_segment *segment, int units,
+                              const tja_location *loc) {
   int retval = 0;
   taco_event barline = {
       .time = 0,
       .type = TACO_EVENT_MEASURE,
-      .line = line,
+      .line = loc->first_line,
       .measure =
           {
               .real = true,
@@ -31,6 +33,8 @@ int tja_segment_push_barline_(tja_segment *segment, int units, int line) {
   tja_event_set_measure_(&barline, segment->measures);
 
   retval = taco_section_push_(segment->segment, &barline);
+  if (retval == 0)
+    tja_set_source_(segment->segment, loc);
   return retval;
 }
 
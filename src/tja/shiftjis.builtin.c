@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "tja/shiftjis.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+// Validates UTF-8 per RFC 3629.
+size_t tja_utf8_prefix_(const char *buf, size_t size,
+                        bool *restrict truncated) {
+  const unsigned char *s = (const unsigned char *)buf;
+  *truncated = false;
+  size_t i = 0;
+  while (i < size) {
+    // skip over ASCII eight bytes at a time
+    while (size - i >= 8) {
+      uint64_t word;
+      memcpy(&word, s + i, 8);
+      if (word & UINT64_C(0x8080808080808080))
+        break;
+      i += 8;
+    }
+    if (i == size)
+      break;
+
+    unsigned c = s[i];
+    size_t len;
+    unsigned min = 0x80, max = 0xbf; // range of the second byte
+    if (c < 0x80) {
+      i += 1;
+      continue;
+    } else if (c >= 0xc2 && c <= 0xdf) {
+      len = 2;
+    } else if (c >= 0xe0 && c <= 0xef) {
+      len = 3;
+      if (c == 0xe0)
+        min = 0xa0; // overlong
+      else if (c == 0xed)
+        max = 0x9f; // surrogates
+    } else if (c >= 0xf0 && c <= 0xf4) {
+      len = 4;
+      if (c == 0xf0)
+        min = 0x90; // overlong
+      else if (c == 0xf4)
+        max = 0x8f; // beyond U+10FFFF
+    } else {
+      return i;
+    }
+
+    for (size_t k = 1; k < len; ++k) {
+      if (i + k == size) {
+        *truncated = true;
+        return i;
+      }
+      unsigned b = s[i + k];
+      if (k == 1 ? b < min || b > max : (b & 0xc0) != 0x80)
+        return i;
+    }
+    i += len;
+  }
+  return i;
+}
@@ -10,6 +10,7 @@
 #include "tja/coursebody.h"
 #include "tja/events.h"
 #include "tja/metadata.h"
+#include "tja/postproc.h"
 #include "tja/segment.h"
 #include "taco.h"
 
@@ -32,6 +33,7 @@ struct branch_info_ {
 #include "tja/branchtype.h"
 #include "tja/metadata.h"
 #include "tja/postproc.h"
+#include "tja/timestamp.h"
 #include "alloc.h"
 #include "course.h"
 #include "courseset.h"
@@ -46,6 +48,23 @@ typedef void *yyscan_t;
 
 static taco_section *get_section_(tja_parser *parser, int purpose);
 static void put_section_(tja_parser *parser, taco_section *section);
+
+// as the default, but also with the offset
+#define YYLLOC_DEFAULT(Current, Rhs, N)                                       \
+  do {                                                                        \
+    if (N) {                                                                  \
+      (Current).first_line = YYRHSLOC(Rhs, 1).first_line;                     \
+      (Current).first_column = YYRHSLOC(Rhs, 1).first_column;                 \
+      (Current).last_line = YYRHSLOC(Rhs, N).last_line;                       \
+      (Current).last_column = YYRHSLOC(Rhs, N).last_column;                   \
+      (Current).offset = YYRHSLOC(Rhs, 1).offset;                             \
+    } else {                                                                  \
+      (Current).first_line = (Current).last_line = YYRHSLOC(Rhs, 0).last_line;\
+      (Current).first_column = (Current).last_column =                        \
+          YYRHSLOC(Rhs, 0).last_column;                                       \
+      (Current).offset = YYRHSLOC(Rhs, 0).offset;                             \
+    }                                                                         \
+  } while (0)
 %}
 
 %code provides {
@@ -64,8 +83,26 @@ struct tja_parser_ {
   yyscan_t lexer;
   taco_file *input;
   taco_file *error_stream;
+  taco_diagnostic_fn *diagnostic_fn;
+  void *diagnostic_data;
+  int severity; // least severe diagnostic reported
+  bool sources;  // whether to record where events are in the input
+
+  // for locating tokens; in the input as decoded
+  uint64_t offset;     // of the next token
+  uint64_t line_start; // offset of the current line
   taco_courseset *set;
   tja_metadata *metadata;
+  int timing;
+
+  // set if the current course exceeds limits of packed timestamps
+  bool timestamp_overflow;
+
+  tja_pass_hook_fn *pass_hook;
+  void *pass_hook_data;
+
+  // input fed so far, if parsing pushed input
+  tja_push *push;
 
   taco_section *tmpsections[PURPOSE_MAX];
 };
@@ -76,7 +113,9 @@ extern void tja_yyerror(TJA_YYLTYPE *llocp, tja_parser *parser, yyscan_t lexer,
 }
 
 %define api.pure full
+%define api.push-pull both
 %define api.prefix {tja_yy}
+%define api.location.type {tja_location}
 %locations
 
 %parse-param {tja_parser *parser}
@@ -143,6 +182,7 @@ extern void tja_yyerror(TJA_YYLTYPE *llocp, tja_parser *parser, yyscan_t lexer,
 %type <field> scoreinit_header
 %type <field> scorediff_header
 %type <field> papamama_command
+%type <field> scrollmode_command
 %type <field> unrecognized_header
 
 %type <integer> balloon_branch
@@ -170,6 +210,9 @@ extern void tja_yyerror(TJA_YYLTYPE *llocp, tja_parser *parser, yyscan_t lexer,
 %type <note> gogostart_command
 %type <note> gogoend_command
 %type <note> scroll_command
+%type <note> sudden_command
+%type <note> direction_command
+%type <note> jposscroll_command
 %type <note> bpmchange_command
 %type <note> delay_command
 %type <note> unrecognized_command
@@ -215,6 +258,9 @@ extern void tja_yyerror(TJA_YYLTYPE *llocp, tja_parser *parser, yyscan_t lexer,
 %token SCOREDIFF
 
 %token PAPAMAMA_CMD
+%token NMSCROLL_CMD
+%token BMSCROLL_CMD
+%token HBSCROLL_CMD
 
 %token START_CMD
 %token END_CMD
@@ -234,6 +280,9 @@ extern void tja_yyerror(TJA_YYLTYPE *llocp, tja_parser *parser, yyscan_t lexer,
 %token BARLINEON_CMD
 %token BARLINEOFF_CMD
 %token BARLINE_CMD
+%token SUDDEN_CMD
+%token DIRECTION_CMD
+%token JPOSSCROLL_CMD
 
 %start set
 
@@ -243,47 +292,16 @@ set:
   %empty {
     parser->set = taco_courseset_create2_(parser->alloc);
     parser->metadata = tja_metadata_create2_(parser->alloc);
+    parser->timestamp_overflow = false;
     $$ = parser->set;
   }
   | set headers body {
     tja_metadata_update_(parser->metadata, $2);
     tja_metadata_free_($2);
 
-    int error = $3 ? 0 : -1;
-
-    if (error == 0) {
-      // run post processing filters
-      int branches = taco_course_branched($3) ? 3 : 1;
-
-      // per-branch post processing
-      for (int i = 0; i < branches; ++i) {
-        taco_section *branch =
-            taco_course_get_branch_mut_($3, TACO_SIDE_LEFT, i);
-
-        int branch_err = 0;
-
-        branch_err = branch_err || tja_pass_convert_time_(parser, branch);
-        branch_err = branch_err || tja_pass_checkpoint_rolls_(parser, branch);
-        branch_err = branch_err || tja_pass_barlines_(parser, branch);
-        branch_err = branch_err || tja_pass_compile_branches_(parser, branch);
-        branch_err = branch_err || tja_pass_prepend_bgm_(parser, branch);
-        branch_err = branch_err || tja_pass_cleanup_(parser, branch);
-        branch_err = branch_err || tja_pass_annotate_(parser, branch);
-
-        error = error || branch_err;
-      }
-
-      // course post processing
-      error = error || tja_pass_check_branches_(parser, $3);
-    }
-
-    // only adding course if no errors are found
-    if (error == 0) {
-      tja_course_apply_metadata_($3, parser->metadata);
-      taco_courseset_add_course_($1, $3);
-    } else {
-      taco_course_free_($3);
-    }
+    // post processing the course, then adding it if no errors are found
+    if ($3)
+      tja_parser_add_course_(parser, $3);
 
     // apply set metadata
     tja_courseset_apply_metadata_($1, parser->metadata);
@@ -324,6 +342,7 @@ header:
   | scorediff_header
   | balloon_header
   | papamama_command
+  | scrollmode_command
   | unrecognized_header;
 
 title_header:
@@ -484,10 +503,23 @@ papamama_command:
     $$.integer = true;
   }
 
+scrollmode_command:
+  NMSCROLL_CMD '\n' {
+    $$.key = TJA_METADATA_SCROLLMODE;
+    $$.integer = TACO_SCROLLMODE_TAIKO;
+  }
+  | BMSCROLL_CMD '\n' {
+    $$.key = TJA_METADATA_SCROLLMODE;
+    $$.integer = TACO_SCROLLMODE_BM;
+  }
+  | HBSCROLL_CMD '\n' {
+    $$.key = TJA_METADATA_SCROLLMODE;
+    $$.integer = TACO_SCROLLMODE_HB;
+  };
+
 unrecognized_header:
   HEADER text '\n' {
-    tja_parser_diagnose_(parser, @1.first_line, TJA_DIAG_WARN,
-                         "unrecognized header: %s", $1);
+    tja_parser_diagnose_at_(parser, &@1, TACO_DIAG_UNKNOWN_HEADER, $1);
     taco_free_(parser->alloc, $1);
     taco_free_(parser->alloc, $2);
     $$.key = TJA_METADATA_UNRECOGNIZED;
@@ -498,11 +530,23 @@ unrecognized_header:
 
 body:
   start_command sections end_command {
-    taco_course_set_style_($2.course, $1);
-    $$ = $2.course;
+    if ($2.measures > TJA_TIMESTAMP_MAX) {
+      tja_parser_diagnose_at_(parser, &@3, TACO_DIAG_TOO_MANY_MEASURES);
+      parser->timestamp_overflow = true;
+    }
+
+    if (parser->timestamp_overflow) {
+      taco_course_free_($2.course);
+      parser->timestamp_overflow = false;
+      $$ = NULL;
+    } else {
+      taco_course_set_style_($2.course, $1);
+      $$ = $2.course;
+    }
   }
   | start_command error end_command {
     // courses are discarded when syntax errors happen
+    parser->timestamp_overflow = false;
     $$ = NULL;
   };
 
@@ -522,6 +566,11 @@ end_command:
 sections:
   measures {
     tja_coursebody_init_(&$$, parser->alloc);
+    if (parser->sources)
+      taco_section_track_sources_(
+          taco_course_get_branch_mut_($$.course, TACO_SIDE_LEFT,
+                                      TACO_BRANCH_NORMAL),
+          true);
     tja_coursebody_append_common_(&$$, &$1);
     put_section_(parser, $1.segment);
   }
@@ -544,7 +593,7 @@ branched_section:
 
     // record branch info
     $$.branchtype = $1.type;
-    $$.line = @1.first_line;
+    $$.location = @1;
     $$.threshold_advanced = $1.advanced;
     $$.threshold_master = $1.master;
   }
@@ -591,14 +640,19 @@ measures:
     put_section_(parser, $1.events);
   }
   | measures ',' measurestart_events {
-    tja_segment_push_barline_(&$1, 0, @1.first_line);
+    tja_segment_push_barline_(&$1, 0, &@2);
     tja_segment_finish_measure_(&$1);
     tja_segment_push_events_(&$1, &$3);
     put_section_(parser, $3.events);
     $$ = $1;
   }
   | measures note_events ',' measurestart_events {
-    tja_segment_push_barline_(&$1, $2.units, @1.first_line);
+    if ($2.units > TJA_TIMESTAMP_MAX) {
+      tja_parser_diagnose_at_(parser, &@2, TACO_DIAG_TOO_MANY_NOTES);
+      parser->timestamp_overflow = true;
+    }
+
+    tja_segment_push_barline_(&$1, $2.units, &@2);
     tja_segment_push_events_(&$1, &$2);
     put_section_(parser, $2.events);
     tja_segment_finish_measure_(&$1);
@@ -613,15 +667,14 @@ note_events:
     $$.units = 0;
     $$.levelhold = false;
 
-    tja_events_push_note_(parser, &$$, $1, @1.first_line);
+    tja_events_push_note_(parser, &$$, $1, &@1);
   }
   | note_events NOTE {
-    tja_events_push_note_(parser, &$1, $2, @1.first_line);
+    tja_events_push_note_(parser, &$1, $2, &@2);
     $$ = $1;
   }
   | note_events note_command {
-    $2.line = @2.first_line;
-    tja_events_push_event_(parser, &$1, &$2);
+    tja_events_push_event_(parser, &$1, &$2, &@2);
     $$ = $1;
   };
 
@@ -632,8 +685,7 @@ measurestart_events:
     $$.levelhold = false;
   }
   | measurestart_events measurestart_command {
-    $2.line = @2.first_line;
-    tja_events_push_event_(parser, &$1, &$2);
+    tja_events_push_event_(parser, &$1, &$2, &@2);
     $$ = $1;
   };
 
@@ -646,6 +698,9 @@ note_command:
   gogostart_command
   | gogoend_command
   | scroll_command
+  | sudden_command
+  | direction_command
+  | jposscroll_command
   | bpmchange_command
   | levelhold_command
   | delay_command
@@ -691,6 +746,54 @@ scroll_command:
     memset(&$$, 0, sizeof(taco_event));
     $$.type = TACO_EVENT_SCROLL;
     $$.detail_float.value = $2;
+  }
+  | SCROLL_CMD real real IDENTIFIER '\n' {
+    // complex scroll speed, as in a+bi
+    memset(&$$, 0, sizeof(taco_event));
+    $$.type = TACO_EVENT_SCROLL_COMPLEX;
+    $$.scroll_complex.x = $2;
+    $$.scroll_complex.y = $3;
+    if (strcmp($4, "i") != 0) {
+      tja_parser_diagnose_at_(parser, &@4, TACO_DIAG_SYNTAX,
+                              "expected a complex number");
+      $$.type = TACO_EVENT_NONE;
+    }
+    taco_free_(parser->alloc, $4);
+  }
+  | SCROLL_CMD real IDENTIFIER '\n' {
+    memset(&$$, 0, sizeof(taco_event));
+    $$.type = TACO_EVENT_SCROLL_COMPLEX;
+    $$.scroll_complex.y = $2;
+    if (strcmp($3, "i") != 0) {
+      tja_parser_diagnose_at_(parser, &@3, TACO_DIAG_SYNTAX,
+                              "expected a complex number");
+      $$.type = TACO_EVENT_NONE;
+    }
+    taco_free_(parser->alloc, $3);
+  };
+
+sudden_command:
+  SUDDEN_CMD real real '\n' {
+    memset(&$$, 0, sizeof(taco_event));
+    $$.type = TACO_EVENT_SUDDEN;
+    $$.sudden.appear = $2;
+    $$.sudden.move = $3;
+  };
+
+direction_command:
+  DIRECTION_CMD INTEGER '\n' {
+    memset(&$$, 0, sizeof(taco_event));
+    $$.type = TACO_EVENT_DIRECTION;
+    $$.detail_int.value = $2 >= 0 && $2 < 8 ? $2 : TACO_DIRECTION_RIGHT;
+  };
+
+jposscroll_command:
+  JPOSSCROLL_CMD real real INTEGER '\n' {
+    // moves left unless the last argument is 1
+    memset(&$$, 0, sizeof(taco_event));
+    $$.type = TACO_EVENT_JPOSSCROLL;
+    $$.jposscroll.seconds = $2;
+    $$.jposscroll.distance = $4 == 1 ? $3 : -$3;
   };
 
 bpmchange_command:
@@ -728,8 +831,7 @@ barline_command:
 
 unrecognized_command:
   COMMAND text '\n' {
-    tja_parser_diagnose_(parser, @1.first_line, TJA_DIAG_WARN,
-                         "unrecognized command: %s", $1);
+    tja_parser_diagnose_at_(parser, &@1, TACO_DIAG_UNKNOWN_COMMAND, $1);
     $$.type = TACO_EVENT_NONE;
     taco_free_(parser->alloc, $1);
     taco_free_(parser->alloc, $2);
@@ -751,7 +853,7 @@ text:
 
 void tja_yyerror(TJA_YYLTYPE *lloc, tja_parser *parser, yyscan_t lexer,
                  const char *msg) {
-  tja_parser_diagnose_(parser, lloc->first_line, TJA_DIAG_ERROR, "%s", msg);
+  tja_parser_diagnose_at_(parser, lloc, TACO_DIAG_SYNTAX, msg);
 }
 
 static taco_section *get_section_(tja_parser *parser, int purpose) {
@@ -0,0 +1,13 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#define _POSIX_C_SOURCE 199309L
+
+#include "clock.h"
+
+#include <stdint.h>
+#include <time.h>
+
+uint64_t taco_clock_ns_(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#define _XOPEN_SOURCE 700
+
+#include "thread.h"
+
+#include "alloc.h"
+#include <pthread.h>
+#include <unistd.h>
+
+int taco_cpu_count_(void) {
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (int)n : 1;
+}
+
+typedef struct worker_ {
+  taco_worker_fn_ *fn;
+  void *data;
+} worker;
+
+static void *start_worker(void *arg) {
+  worker *w = arg;
+  w->fn(w->data);
+  return NULL;
+}
+
+int taco_run_workers_(taco_allocator *alloc, int count, taco_worker_fn_ *fn,
+                      void *data) {
+  pthread_t *threads = taco_malloc_(alloc, count * sizeof(pthread_t));
+  if (!threads)
+    return -1;
+
+  worker w = {fn, data};
+  int started = 0;
+  for (; started < count; ++started) {
+    if (pthread_create(&threads[started], NULL, start_worker, &w) != 0)
+      break;
+  }
+
+  if (started == 0)
+    fn(data);
+
+  for (int i = 0; i < started; ++i)
+    pthread_join(threads[i], NULL);
+  taco_free_(alloc, threads);
+  return 0;
+}
+
+size_t taco_claim_job_(atomic_size_t *next) {
+  return atomic_fetch_add_explicit(next, 1, memory_order_relaxed);
+}
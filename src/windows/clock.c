@@ -0,0 +1,18 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#define WIN32_LEAN_AND_MEAN
+
+#include "clock.h"
+
+#include <stdint.h>
+#include <windows.h>
+
+uint64_t taco_clock_ns_(void) {
+  LARGE_INTEGER frequency, count;
+  QueryPerformanceFrequency(&frequency);
+  QueryPerformanceCounter(&count);
+
+  // split to keep the product from overflowing
+  uint64_t seconds = count.QuadPart / frequency.QuadPart;
+  uint64_t rest = count.QuadPart % frequency.QuadPart;
+  return seconds * 1000000000 + rest * 1000000000 / frequency.QuadPart;
+}
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#define WIN32_LEAN_AND_MEAN
+
+#include "thread.h"
+
+#include "alloc.h"
+#include <windows.h>
+
+int taco_cpu_count_(void) {
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+}
+
+typedef struct worker_ {
+  taco_worker_fn_ *fn;
+  void *data;
+} worker;
+
+static DWORD WINAPI start_worker(LPVOID arg) {
+  worker *w = arg;
+  w->fn(w->data);
+  return 0;
+}
+
+int taco_run_workers_(taco_allocator *alloc, int count, taco_worker_fn_ *fn,
+                      void *data) {
+  if (count > MAXIMUM_WAIT_OBJECTS)
+    count = MAXIMUM_WAIT_OBJECTS;
+
+  HANDLE *threads = taco_malloc_(alloc, count * sizeof(HANDLE));
+  if (!threads)
+    return -1;
+
+  worker w = {fn, data};
+  int started = 0;
+  for (; started < count; ++started) {
+    threads[started] = CreateThread(NULL, 0, start_worker, &w, 0, NULL);
+    if (!threads[started])
+      break;
+  }
+
+  if (started == 0)
+    fn(data);
+
+  WaitForMultipleObjects(started, threads, TRUE, INFINITE);
+  for (int i = 0; i < started; ++i)
+    CloseHandle(threads[i]);
+  taco_free_(alloc, threads);
+  return 0;
+}
+
+size_t taco_claim_job_(atomic_size_t *next) {
+  return atomic_fetch_add_explicit(next, 1, memory_order_relaxed);
+}
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include <check.h>
+
+#include "alloc.h"
+#include "section.h"
+#include "taco.h"
+
+START_TEST(test_stats) {
+  taco_alloc_stats *stats = taco_alloc_stats_create(NULL);
+  taco_allocator *a = taco_alloc_stats_allocator(stats);
+
+  void *p = taco_malloc_(a, 100);
+  void *q = taco_malloc_(a, 50);
+  ck_assert_int_eq(taco_alloc_stats_live_bytes(stats), 150);
+
+  taco_free_(a, q);
+  p = taco_realloc_(a, p, 200);
+  ck_assert_int_eq(taco_alloc_stats_count(stats), 3);
+  ck_assert_int_eq(taco_alloc_stats_frees(stats), 1);
+  ck_assert_int_eq(taco_alloc_stats_bytes(stats), 350);
+  ck_assert_int_eq(taco_alloc_stats_live_bytes(stats), 200);
+  ck_assert_int_eq(taco_alloc_stats_peak_bytes(stats), 200);
+
+  taco_alloc_stats_reset(stats);
+  ck_assert_int_eq(taco_alloc_stats_count(stats), 0);
+  ck_assert_int_eq(taco_alloc_stats_peak_bytes(stats), 200);
+
+  taco_free_(a, p);
+  ck_assert_int_eq(taco_alloc_stats_live_bytes(stats), 0);
+  taco_alloc_stats_free(stats);
+}
+END_TEST
+
+START_TEST(test_sites) {
+  static const taco_event e = {0, TACO_EVENT_DON, .detail_int = {0}};
+  taco_alloc_stats *stats = taco_alloc_stats_create(NULL);
+  taco_allocator *a = taco_alloc_stats_allocator(stats);
+
+  taco_section *s = taco_section_create2_(a);
+  for (int i = 0; i < 1000; ++i)
+    taco_section_push_(s, &e);
+  char *str = taco_strdup_(a, "don");
+
+  // section growth is attributed; the section object itself is not
+  ck_assert_int_gt(taco_alloc_stats_site_count(stats, TACO_ALLOC_SITE_SECTION),
+                   1);
+  ck_assert_int_eq(taco_alloc_stats_site_count(stats, TACO_ALLOC_SITE_OTHER),
+                   1);
+  ck_assert_int_eq(taco_alloc_stats_site_count(stats, TACO_ALLOC_SITE_STRING),
+                   1);
+  ck_assert_int_eq(taco_alloc_stats_site_bytes(stats, TACO_ALLOC_SITE_STRING),
+                   4);
+  ck_assert_int_eq(taco_alloc_stats_site_count(stats, TACO_ALLOC_SITE_MAX), 0);
+
+  taco_free_(a, str);
+  taco_section_free_(s);
+  ck_assert_int_eq(taco_alloc_stats_live_bytes(stats), 0);
+  taco_alloc_stats_free(stats);
+}
+END_TEST
+
+TCase *case_alloc(void) {
+  TCase *c = tcase_create("alloc");
+  tcase_add_test(c, test_stats);
+  tcase_add_test(c, test_sites);
+  return c;
+}
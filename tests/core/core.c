@@ -3,12 +3,16 @@
 
 const char suite_name[] = "libtaco";
 
+extern TCase *case_alloc();
 extern TCase *case_course();
+extern TCase *case_io();
 extern TCase *case_note();
 extern TCase *case_section();
 
 TCase *(*const cases[])(void) = {
+    case_alloc,
     case_course,
+    case_io,
     case_note,
     case_section,
     NULL,
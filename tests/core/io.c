@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include <check.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc.h"
+#include "io.h"
+#include "taco.h"
+
+typedef struct counted_ counted;
+
+// An in-memory stream counting how often it is read.
+struct counted_ {
+  char data[1000];
+  size_t pos;
+  int reads;
+};
+
+static size_t counted_read(void *restrict dst, size_t size, size_t count,
+                           void *restrict stream) {
+  counted *c = stream;
+  size_t n = size * count;
+  if (n > sizeof(c->data) - c->pos)
+    n = sizeof(c->data) - c->pos;
+  memcpy(dst, c->data + c->pos, n);
+  c->pos += n;
+  c->reads += 1;
+  return n;
+}
+
+static int counted_seek(void *restrict stream, uint64_t offset, int whence) {
+  counted *c = stream;
+  c->pos = whence == SEEK_SET ? offset : c->pos + offset;
+  return 0;
+}
+
+static const taco_io counted_io = {
+    .version = sizeof(taco_io),
+    .read = counted_read,
+    .seek = counted_seek,
+};
+
+static taco_file *open_counted(counted *c, taco_allocator *alloc) {
+  for (size_t i = 0; i < sizeof(c->data); ++i)
+    c->data[i] = i % 251;
+  c->pos = 0;
+  c->reads = 0;
+  return taco_file_open_(alloc, c, "<counted>", &counted_io);
+}
+
+START_TEST(test_read) {
+  counted c;
+  taco_file *f = open_counted(&c, &taco_default_allocator_);
+
+  // small reads are served a block at a time
+  char buf[10];
+  for (int i = 0; i < 50; ++i) {
+    ck_assert_uint_eq(taco_file_read_(f, buf, sizeof(buf)), sizeof(buf));
+    ck_assert_int_eq((unsigned char)buf[0], (i * 10) % 251);
+  }
+  ck_assert_int_eq(c.reads, 1);
+
+  // the rest, then end of file
+  char rest[600];
+  ck_assert_uint_eq(taco_file_read_(f, rest, sizeof(rest)), 500);
+  ck_assert_int_eq((unsigned char)rest[0], 500 % 251);
+  ck_assert_uint_eq(taco_file_read_(f, rest, sizeof(rest)), 0);
+  ck_assert_int_eq(c.reads, 2);
+
+  taco_file_close_(f);
+}
+END_TEST
+
+START_TEST(test_peek) {
+  counted c;
+  taco_file *f = open_counted(&c, &taco_default_allocator_);
+  taco_file_set_block_size_(f, 64);
+
+  size_t size;
+  const char *p = taco_file_peek_(f, 1, &size);
+  ck_assert_uint_eq(size, 64);
+  ck_assert_int_eq(p[63], 63);
+  taco_file_consume_(f, 60);
+
+  // asking for more than a block gets as much
+  p = taco_file_peek_(f, 100, &size);
+  ck_assert_uint_ge(size, 100);
+  ck_assert_int_eq(p[0], 60);
+
+  // reads pick up after what was consumed
+  taco_file_consume_(f, 40);
+  char buf[4];
+  ck_assert_uint_eq(taco_file_read_(f, buf, sizeof(buf)), sizeof(buf));
+  ck_assert_int_eq(buf[0], 100);
+
+  // seeking drops what is buffered
+  taco_file_seek_(f, 990, SEEK_SET);
+  p = taco_file_peek_(f, 20, &size);
+  ck_assert_uint_eq(size, 10);
+  ck_assert_int_eq((unsigned char)p[0], 990 % 251);
+
+  taco_file_close_(f);
+}
+END_TEST
+
+static void *plain_malloc(size_t size, void *restrict heap) {
+  return malloc(size);
+}
+
+static void plain_free(void *ptr, void *restrict heap) { free(ptr); }
+
+static void *failing_realloc(void *ptr, size_t size, void *restrict heap) {
+  return NULL;
+}
+
+START_TEST(test_buffer_error) {
+  taco_allocator alloc = {plain_malloc, plain_free, failing_realloc, NULL};
+  counted c;
+  taco_file *f = open_counted(&c, &alloc);
+
+  // input cut short for want of memory is an error, not the end
+  char buf[10];
+  ck_assert_uint_eq(taco_file_read_(f, buf, sizeof(buf)), 0);
+  ck_assert(taco_file_error_(f));
+
+  taco_file_close_(f);
+}
+END_TEST
+
+TCase *case_io(void) {
+  TCase *c = tcase_create("io");
+  tcase_add_test(c, test_read);
+  tcase_add_test(c, test_peek);
+  tcase_add_test(c, test_buffer_error);
+  return c;
+}
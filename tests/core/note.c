@@ -82,6 +82,32 @@ START_TEST(test_branchcond) {
 }
 END_TEST
 
+START_TEST(test_scroll) {
+  static const taco_event scroll = {
+      .time = 0,
+      .type = TACO_EVENT_SCROLL_COMPLEX,
+      .scroll_complex = {1.5, -0.5},
+  };
+  static const taco_event sudden = {
+      .time = 0,
+      .type = TACO_EVENT_SUDDEN,
+      .sudden = {0, 0},
+  };
+
+  double x, y;
+  ck_assert_int_eq(taco_event_scroll(&scroll, &x, &y), 0);
+  ck_assert_double_eq(x, 1.5);
+  ck_assert_double_eq(y, -0.5);
+  ck_assert_float_nan(taco_event_detail_float(&scroll));
+
+  // #SUDDEN 0 0 shows notes all the time
+  ck_assert_int_eq(taco_event_sudden(&sudden, &x, &y), 0);
+  ck_assert(isinf(x) && isinf(y));
+  ck_assert_int_eq(taco_event_sudden(&scroll, &x, &y), -1);
+  ck_assert_int_eq(taco_event_jposscroll(&sudden, &x, &y), -1);
+}
+END_TEST
+
 START_TEST(test_null) {
   static const taco_event branchstart = {
       .time = 0,
@@ -117,6 +143,7 @@ TCase *case_note() {
   tcase_add_test(c, test_float);
   tcase_add_test(c, test_branchstart);
   tcase_add_test(c, test_branchcond);
+  tcase_add_test(c, test_scroll);
   tcase_add_test(c, test_null);
   return c;
 }
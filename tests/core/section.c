@@ -1,5 +1,6 @@
 // SPDX-License-Identifier: BSD-2-Clause
 #include <check.h>
+#include <math.h>
 
 #include "note.h" // IWYU pragma: keep; for definition of taco_event
 #include "section.h"
@@ -209,6 +210,184 @@ START_TEST(test_delay) {
 }
 END_TEST
 
+START_TEST(test_time_cursor) {
+  static const taco_event events[] = {
+      {0, TACO_EVENT_BPM, .detail_float = {120.0}},
+      {0, TACO_EVENT_MEASURE},
+      {96, TACO_EVENT_MEASURE},
+      {192, TACO_EVENT_DELAY, .detail_float = {1.0}},
+      {192, TACO_EVENT_BPM, .detail_float = {180.0}},
+      {192, TACO_EVENT_MEASURE},
+      {288, TACO_EVENT_MEASURE},
+      {336, TACO_EVENT_BPM, .detail_float = {90.0}},
+      {384, TACO_EVENT_MEASURE},
+  };
+
+  taco_section *s = taco_section_create_();
+  taco_section_push_many_(s, events, 9);
+  taco_section_cache_seconds_(s);
+
+  taco_time_cursor cursor;
+  taco_time_cursor_init_(&cursor, s);
+  taco_section_foreach(i, s) {
+    ck_assert_double_eq(taco_time_cursor_seconds_(&cursor, i),
+                        taco_event_seconds(i, s));
+  }
+
+  taco_section_free_(s);
+}
+END_TEST
+
+START_TEST(test_measures) {
+  static const taco_event events[] = {
+      {0, TACO_EVENT_BPM, .detail_float = {120.0}},
+      {0, TACO_EVENT_MEASURE, .measure = {.real = true, .ticks = 96}},
+      {0, TACO_EVENT_DON, .detail_int = {0}},
+      {96, TACO_EVENT_SCROLL, .detail_float = {2.0}},
+      {96, TACO_EVENT_MEASURE, .measure = {.real = true, .ticks = 72}},
+      {144, TACO_EVENT_MEASURE, .measure = {.real = false}},
+      {168, TACO_EVENT_BPM, .detail_float = {180.0}},
+      {168, TACO_EVENT_MEASURE, .measure = {.real = true, .ticks = 96}},
+      {216, TACO_EVENT_KAT, .detail_int = {0}},
+  };
+
+  taco_section *s = taco_section_create_();
+  taco_section_push_many_(s, events, 9);
+  taco_section_cache_seconds_(s);
+  taco_section_cache_measures_(s);
+
+  ck_assert_int_eq(taco_section_measure_count(s), 3);
+  ck_assert_ptr_null(taco_section_measure(s, 3));
+
+  const taco_measure *m = taco_section_measure(s, 1);
+  ck_assert_int_eq(taco_measure_time(m), 96);
+  ck_assert_int_eq(taco_measure_length(m), 72);
+  ck_assert_double_eq(taco_measure_seconds(m), 2.0);
+  ck_assert_int_eq(taco_measure_first_event(m), 3);
+  ck_assert_double_eq(taco_measure_bpm(m), 120.0);
+  double x, y;
+  ck_assert_int_eq(taco_measure_scroll(m, &x, &y), 0);
+  ck_assert_double_eq(x, 2.0);
+  ck_assert_double_eq(y, 0.0);
+
+  m = taco_section_measure_at_tick(s, 150);
+  ck_assert_int_eq(taco_measure_index(m, s), 1);
+  m = taco_section_measure_at_time(s, 3.5);
+  ck_assert_int_eq(taco_measure_index(m, s), 2);
+  ck_assert_int_eq(taco_measure_first_event(m), 6);
+  ck_assert_double_eq(taco_measure_bpm(m), 180.0);
+  size_t measure;
+  int num, den;
+  const taco_event *e = taco_section_locate(s, 8);
+  ck_assert_int_eq(taco_event_position(e, s, &measure, &num, &den), 0);
+  ck_assert_int_eq(measure, 2);
+  ck_assert_int_eq(num, 1);
+  ck_assert_int_eq(den, 2);
+  ck_assert_int_eq(taco_event_time_at(e, s, 48), 108);
+
+  m = taco_section_measure_at_time(s, 100.0);
+  ck_assert_int_eq(taco_measure_index(m, s), 2);
+  ck_assert_ptr_null(taco_section_measure_at_time(s, -1.0));
+
+  // structural changes drop the table
+  taco_section_pop_(s, 1);
+  ck_assert_int_eq(taco_section_measure_count(s), 0);
+
+  taco_section_free_(s);
+}
+END_TEST
+
+START_TEST(test_stale) {
+  static const taco_event events[] = {
+      {0, TACO_EVENT_BPM, .detail_float = {120.0}},
+      {0, TACO_EVENT_MEASURE, .measure = {.real = true, .ticks = 96}},
+      {96, TACO_EVENT_MEASURE, .measure = {.real = true, .ticks = 96}},
+  };
+
+  taco_section *s = taco_section_create_();
+  taco_section_push_many_(s, events, 3);
+  taco_section_cache_measures_(s);
+  taco_section_cache_seconds_(s);
+  taco_section_cache_fingerprint_(s);
+  const taco_event *e = taco_section_locate(s, 2);
+  ck_assert_double_eq(taco_event_seconds(e, s), 2.0);
+
+  // edits in place make every cache stale until rebuilt
+  taco_section_locate_mut_(s, 0)->detail_float.value = 240.0;
+  uint64_t fingerprint;
+  ck_assert(isnan(taco_event_seconds(e, s)));
+  ck_assert_int_eq(taco_section_measure_count(s), 0);
+  ck_assert_int_eq(taco_section_fingerprint(s, &fingerprint), -1);
+
+  taco_section_cache_measures_(s);
+  taco_section_cache_seconds_(s);
+  ck_assert_double_eq(taco_event_seconds(e, s), 1.0);
+  ck_assert_int_eq(taco_section_measure_count(s), 2);
+  ck_assert_double_eq(taco_measure_seconds(taco_section_measure(s, 1)), 1.0);
+  ck_assert_int_eq(taco_section_fingerprint(s, &fingerprint), -1);
+
+  taco_section_free_(s);
+}
+END_TEST
+
+START_TEST(test_difficulty) {
+  // quarter notes changing color for a measure, then eighth notes of don
+  taco_event events[25] = {{0, TACO_EVENT_BPM, .detail_float = {120.0}}};
+  for (int n = 0; n < 8; ++n) {
+    events[1 + n].time = 24 * n;
+    events[1 + n].type = n % 2 ? TACO_EVENT_KAT : TACO_EVENT_DON;
+  }
+  for (int n = 0; n < 16; ++n) {
+    events[9 + n].time = 192 + 12 * n;
+    events[9 + n].type = TACO_EVENT_DON;
+  }
+
+  taco_section *s = taco_section_create_();
+  taco_section_push_many_(s, events, 25);
+  taco_section_cache_seconds_(s);
+
+  taco_difficulty d;
+  ck_assert_int_eq(taco_section_difficulty(s, 1.0, &d), 0);
+  ck_assert_int_eq(d.notes, 24);
+  ck_assert_double_eq(d.duration, 7.75);
+  ck_assert_double_eq_tol(d.density, 24 / 7.75, 1e-9);
+  ck_assert_double_eq(d.peak_density, 4);
+  ck_assert_double_eq(d.stamina, 2);
+  ck_assert_double_eq_tol(d.alternation, 8.0 / 23, 1e-9);
+  double p = 8.0 / 23;
+  ck_assert_double_eq_tol(d.complexity,
+                          -p * log2(p) - (1 - p) * log2(1 - p), 1e-9);
+  ck_assert_int_eq(taco_section_difficulty(s, 0, &d), -1);
+
+  // batches give the same results
+  taco_section *empty = taco_section_create_();
+  const taco_section *sections[] = {empty, s};
+  taco_difficulty many[2];
+  ck_assert_int_eq(taco_section_difficulty_many(sections, 2, 1.0, many), 0);
+  ck_assert_int_eq(many[0].notes, 0);
+  ck_assert_double_eq(many[0].peak_density, 0);
+  ck_assert_double_eq(many[1].stamina, d.stamina);
+  ck_assert_double_eq(many[1].complexity, d.complexity);
+
+  // working memory comes from the allocator of the sections
+  taco_alloc_stats *stats = taco_alloc_stats_create(NULL);
+  taco_section *counted =
+      taco_section_create2_(taco_alloc_stats_allocator(stats));
+  taco_section_push_many_(counted, events, 25);
+  taco_section_cache_seconds_(counted);
+  size_t before = taco_alloc_stats_site_count(stats, TACO_ALLOC_SITE_OTHER);
+  ck_assert_int_eq(taco_section_difficulty(counted, 1.0, &d), 0);
+  ck_assert_uint_gt(taco_alloc_stats_site_count(stats, TACO_ALLOC_SITE_OTHER),
+                    before);
+  taco_section_free_(counted);
+  ck_assert_uint_eq(taco_alloc_stats_live_bytes(stats), 0);
+  taco_alloc_stats_free(stats);
+
+  taco_section_free_(empty);
+  taco_section_free_(s);
+}
+END_TEST
+
 TCase *case_section(void) {
   TCase *c = tcase_create("section");
   tcase_add_test(c, test_create);
@@ -221,5 +400,9 @@ TCase *case_section(void) {
   tcase_add_test(c, test_balloons);
   tcase_add_test(c, test_time);
   tcase_add_test(c, test_delay);
+  tcase_add_test(c, test_time_cursor);
+  tcase_add_test(c, test_measures);
+  tcase_add_test(c, test_stale);
+  tcase_add_test(c, test_difficulty);
   return c;
 }
@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include <check.h>
+
+#include "taco.h"
+
+START_TEST(test_alloc_stats) {
+  taco_alloc_stats *stats = taco_alloc_stats_create(NULL);
+  taco_parser *p = taco_parser_tja_create2(taco_alloc_stats_allocator(stats));
+
+  taco_courseset *set = taco_parser_parse_file(p, "assets/basic.tja");
+  ck_assert_ptr_nonnull(set);
+  ck_assert_int_gt(taco_alloc_stats_site_count(stats, TACO_ALLOC_SITE_SECTION),
+                   0);
+  ck_assert_int_gt(taco_alloc_stats_site_count(stats, TACO_ALLOC_SITE_CACHE),
+                   0);
+  ck_assert_int_gt(taco_alloc_stats_site_count(stats, TACO_ALLOC_SITE_STRING),
+                   0);
+
+  taco_courseset_free(set);
+  taco_parser_free(p);
+  ck_assert_int_eq(taco_alloc_stats_live_bytes(stats), 0);
+  taco_alloc_stats_free(stats);
+}
+END_TEST
+
+static int count_path(const unsigned char *branches, size_t count,
+                      const taco_score *score, void *data) {
+  *(int *)data += 1;
+  return 0;
+}
+
+START_TEST(test_alloc_paths) {
+  taco_alloc_stats *stats = taco_alloc_stats_create(NULL);
+  taco_parser *p = taco_parser_tja_create2(taco_alloc_stats_allocator(stats));
+  taco_courseset *set = taco_parser_parse_file(p, "assets/branch.tja");
+  ck_assert_ptr_nonnull(set);
+  const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  size_t live = taco_alloc_stats_live_bytes(stats);
+
+  // paths and their scratch memory come from the allocator of the course
+  taco_alloc_stats_reset(stats);
+  taco_path *path = taco_path_create(c, TACO_SIDE_LEFT, NULL, 0);
+  ck_assert_ptr_nonnull(path);
+  ck_assert_int_gt(taco_alloc_stats_count(stats), 0);
+  taco_path_free(path);
+
+  taco_alloc_stats_reset(stats);
+  int paths = 0;
+  ck_assert_int_eq(taco_course_foreach_path(c, TACO_SIDE_LEFT,
+                                            TACO_RULES_AC15, count_path,
+                                            &paths),
+                   0);
+  ck_assert_int_eq(paths, 3);
+  ck_assert_int_gt(taco_alloc_stats_count(stats), 0);
+  ck_assert_int_eq(taco_alloc_stats_live_bytes(stats), live);
+
+  taco_courseset_free(set);
+  taco_parser_free(p);
+  taco_alloc_stats_free(stats);
+}
+END_TEST
+
+TCase *case_alloc(void) {
+  TCase *c = tcase_create("alloc");
+  tcase_add_test(c, test_alloc_stats);
+  tcase_add_test(c, test_alloc_paths);
+  return c;
+}
@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include <check.h>
+
+#include "taco.h"
+#include "tacoassert.h"
+
+static taco_parser *parser;
+static assert_section_state *assert_section;
+
+static void setup(void) {
+  parser = taco_parser_tja_create();
+  assert_section = assert_section_setup();
+}
+
+static void teardown(void) {
+  taco_parser_free(parser);
+  assert_section_teardown(assert_section);
+}
+
+static void read_failed_diagnostic(const taco_diagnostic *restrict diag,
+                                   void *data) {
+  if (taco_diagnostic_code(diag) == TACO_DIAG_READ_FAILED)
+    *(int *)data += 1;
+}
+
+START_TEST(test_archive) {
+  taco_archive *a = taco_archive_open("assets/pack.zip");
+  ck_assert_ptr_nonnull(a);
+  ck_assert_uint_eq(taco_archive_count(a), 4);
+  ck_assert_str_eq(taco_archive_name(a, 1), "pack/basic/basic.tja");
+  ck_assert_uint_eq(taco_archive_size(a, 2), 1024);
+  ck_assert_ptr_null(taco_archive_name(a, 4));
+
+  // stored
+  taco_courseset *set = taco_parser_parse_archive(parser, a, 1);
+  ck_assert_ptr_nonnull(set);
+  ck_assert_str_eq(taco_courseset_filename(set), "pack/basic/basic.tja");
+  const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  assert_section_eq(taco_course_get_branch(c, 0, 0), "assets/basic.txt",
+                    assert_section);
+  taco_courseset_free(set);
+
+  // deflated, with Zip64 sizes in the local header
+  set = taco_parser_parse_archive(parser, a, 3);
+  ck_assert_ptr_nonnull(set);
+  ck_assert_str_eq(taco_courseset_title(set), "東京テディベア");
+  ck_assert_int_eq(taco_courseset_encoding(set), TACO_ENCODING_SHIFT_JIS);
+  taco_courseset_free(set);
+
+  ck_assert_ptr_null(taco_parser_parse_archive(parser, a, 4));
+  taco_archive_close(a);
+  ck_assert_ptr_null(taco_archive_open("assets/basic.tja"));
+
+  // sync flushed, with stored blocks after compressed ones
+  a = taco_archive_open("assets/flushed.zip");
+  ck_assert_ptr_nonnull(a);
+  set = taco_parser_parse_archive(parser, a, 0);
+  ck_assert_ptr_nonnull(set);
+  ck_assert_str_eq(taco_courseset_title(set), "Flushed");
+  c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  ck_assert_ptr_nonnull(c);
+  ck_assert_uint_gt(taco_section_size(taco_course_get_branch(c, 0, 0)), 60);
+  taco_courseset_free(set);
+
+  // a CRC-32 mismatch, truncated data, then a stored CRC-32 mismatch
+  int failed = 0;
+  taco_parser_set_diagnostics(parser, read_failed_diagnostic, &failed);
+  ck_assert_ptr_null(taco_parser_parse_archive(parser, a, 1));
+  ck_assert_int_eq(failed, 1);
+  ck_assert_ptr_null(taco_parser_parse_archive(parser, a, 2));
+  ck_assert_int_eq(failed, 2);
+  ck_assert_ptr_null(taco_parser_parse_archive(parser, a, 3));
+  ck_assert_int_eq(failed, 3);
+  taco_archive_close(a);
+}
+END_TEST
+
+TCase *case_archive(void) {
+  TCase *c = tcase_create("archive");
+  tcase_add_checked_fixture(c, setup, teardown);
+  tcase_add_test(c, test_archive);
+  return c;
+}
@@ -0,0 +1,88 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include <check.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "taco.h"
+
+// Parses a chart of one Oni course, getting its hashes.
+static void fingerprint_chart(const char *header, const char *body,
+                              uint64_t *fingerprint, taco_sketch *sketch) {
+  char chart[1024];
+  snprintf(chart, sizeof(chart),
+           "%sBPM:150\nCOURSE:Oni\n#START\n%s#END\n", header, body);
+  taco_parser *p = taco_parser_tja_create();
+  ck_assert_int_eq(taco_parser_feed(p, chart, strlen(chart)), 0);
+  taco_courseset *set = taco_parser_finish(p);
+  taco_parser_free(p);
+
+  const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  ck_assert_int_eq(taco_course_fingerprint(c, fingerprint), 0);
+  ck_assert_int_eq(taco_course_sketch(c, sketch), 0);
+  taco_courseset_free(set);
+}
+
+START_TEST(test_fingerprint) {
+  static const char body[] = "1011201020112010,\n1020102022102010,\n"
+                             "3000102010201120,\n1012101210221011,\n"
+                             "2010201110201022,\n1110222011102220,\n"
+                             "1020112010201120,\n4000100020001000,\n";
+  // one note changed
+  static const char edited[] = "1011201020112010,\n1020102022102010,\n"
+                               "3000102010201120,\n1012101210221011,\n"
+                               "2010201110201022,\n1110222011102220,\n"
+                               "1020112010201110,\n4000100020001000,\n";
+  static const char other[] = "3,\n1111,\n22,\n10201020,\n4,\n";
+
+  uint64_t f, g;
+  taco_sketch a, b;
+  fingerprint_chart("TITLE:Song\nOFFSET:-1.5\n", body, &f, &a);
+
+  // headers and leading silence do not matter
+  char delayed[sizeof(body) + 8];
+  snprintf(delayed, sizeof(delayed), "0,\n%s", body);
+  fingerprint_chart("TITLE:Song (copy)\n", delayed, &g, &b);
+  ck_assert_uint_eq(f, g);
+  ck_assert_double_eq(taco_sketch_similarity(&a, &b), 1);
+
+  fingerprint_chart("", edited, &g, &b);
+  ck_assert_uint_ne(f, g);
+  ck_assert_double_gt(taco_sketch_similarity(&a, &b), 0.5);
+  int shared = 0;
+  for (int band = 0; band < TACO_SKETCH_BANDS; ++band)
+    shared += taco_sketch_band(&a, band) == taco_sketch_band(&b, band);
+  ck_assert_int_gt(shared, 0);
+
+  fingerprint_chart("", other, &g, &b);
+  ck_assert_uint_ne(f, g);
+  ck_assert_double_lt(taco_sketch_similarity(&a, &b), 0.5);
+}
+END_TEST
+
+START_TEST(test_empty_sketch) {
+  uint64_t f, g;
+  taco_sketch a, b;
+
+  // too few notes for a run, so nothing to compare
+  fingerprint_chart("", "1,\n", &f, &a);
+  fingerprint_chart("", "2,\n2,\n", &g, &b);
+  ck_assert_uint_ne(f, g);
+  ck_assert_double_eq(taco_sketch_similarity(&a, &b), 0);
+  ck_assert_double_eq(taco_sketch_similarity(&a, &a), 0);
+  for (int band = 0; band < TACO_SKETCH_BANDS; ++band)
+    ck_assert_uint_eq(taco_sketch_band(&a, band), 0);
+
+  fingerprint_chart("", "1111,\n", &g, &b);
+  ck_assert_double_eq(taco_sketch_similarity(&a, &b), 0);
+  ck_assert_double_eq(taco_sketch_similarity(&b, &b), 1);
+  ck_assert_uint_ne(taco_sketch_band(&b, 0), 0);
+}
+END_TEST
+
+TCase *case_fingerprint(void) {
+  TCase *c = tcase_create("fingerprint");
+  tcase_add_test(c, test_fingerprint);
+  tcase_add_test(c, test_empty_sketch);
+  return c;
+}
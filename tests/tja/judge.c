@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include <check.h>
+
+#include "taco.h"
+
+static taco_parser *parser;
+
+static void setup(void) { parser = taco_parser_tja_create(); }
+
+static void teardown(void) { taco_parser_free(parser); }
+
+START_TEST(test_judge) {
+  taco_courseset *set = taco_parser_parse_file(parser, "assets/branch.tja");
+  ck_assert_ptr_nonnull(set);
+  const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  taco_judge *j = taco_judge_create(c, TACO_SIDE_LEFT);
+  ck_assert_ptr_nonnull(j);
+
+  // a full combo reaches the master branch and its score ceiling
+  static const double master[] = {0, 1, 2, 4, 4.5, 5, 6};
+  static const int master_inputs[] = {1, 1, 2, 1, 1, 2, 1};
+  for (int i = 0; i < 7; ++i)
+    ck_assert_int_eq(taco_judge_hit(j, master[i] + 0.01, master_inputs[i]),
+                     TACO_JUDGE_GOOD);
+  taco_judge_finish(j);
+
+  taco_score score;
+  taco_section_score(
+      taco_course_get_branch(c, TACO_SIDE_LEFT, TACO_BRANCH_MASTER), c,
+      TACO_RULES_DEFAULT, &score);
+  ck_assert_int_eq(taco_judge_branch(j), TACO_BRANCH_MASTER);
+  ck_assert_int_eq(taco_judge_max_combo(j), 7);
+  ck_assert_int_eq(taco_judge_score(j), score.ceiling);
+
+  // OKs only reach the advanced branch; wrong colors are bad
+  taco_judge_reset(j);
+  ck_assert_int_eq(taco_judge_hit(j, -0.2, TACO_INPUT_DON), TACO_JUDGE_NONE);
+  ck_assert_int_eq(taco_judge_hit(j, 0.05, TACO_INPUT_DON), TACO_JUDGE_OK);
+  ck_assert_int_eq(taco_judge_hit(j, 0.95, TACO_INPUT_DON), TACO_JUDGE_OK);
+  ck_assert_int_eq(taco_judge_hit(j, 2, TACO_INPUT_DON), TACO_JUDGE_BAD);
+  ck_assert_int_eq(taco_judge_hit(j, 4, TACO_INPUT_DON), TACO_JUDGE_GOOD);
+  ck_assert_int_eq(taco_judge_branch(j), TACO_BRANCH_ADVANCED);
+  ck_assert_int_eq(taco_judge_hit(j, 4.5, TACO_INPUT_DON), TACO_JUDGE_NONE);
+  ck_assert_int_eq(taco_judge_hit(j, 5, TACO_INPUT_KAT), TACO_JUDGE_GOOD);
+  ck_assert_int_eq(taco_judge_combo(j), 2);
+
+  // misses everything else, staying on the normal branch
+  taco_judge_reset(j);
+  taco_judge_finish(j);
+  ck_assert_int_eq(taco_judge_branch(j), TACO_BRANCH_NORMAL);
+  ck_assert_int_eq(taco_judge_count(j, TACO_JUDGE_BAD), 5);
+  ck_assert_int_eq(taco_judge_score(j), 0);
+
+  taco_judge_free(j);
+  taco_courseset_free(set);
+}
+END_TEST
+
+START_TEST(test_judge_balloon) {
+  taco_courseset *set = taco_parser_parse_file(parser, "assets/checkpoint.tja");
+  ck_assert_ptr_nonnull(set);
+  const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  taco_judge *j = taco_judge_create(c, TACO_SIDE_LEFT);
+  ck_assert_ptr_nonnull(j);
+
+  // balloons only take don
+  ck_assert_int_eq(taco_judge_hit(j, 0.05, TACO_INPUT_KAT), TACO_JUDGE_NONE);
+  for (int i = 0; i < 9; ++i)
+    ck_assert_int_eq(taco_judge_hit(j, 0.1 * i, TACO_INPUT_DON),
+                     TACO_JUDGE_ROLL);
+  ck_assert_int_eq(taco_judge_hit(j, 1, TACO_INPUT_DON), TACO_JUDGE_POP);
+  ck_assert_int_eq(taco_judge_hit(j, 1.1, TACO_INPUT_DON), TACO_JUDGE_NONE);
+  ck_assert_int_eq(taco_judge_score(j), 9 * 300 + 5000);
+
+  // kusudama popped after its checkpoint
+  for (int i = 0; i < 19; ++i)
+    ck_assert_int_eq(taco_judge_hit(j, 2.6 + 0.04 * i, TACO_INPUT_DON),
+                     TACO_JUDGE_ROLL);
+  ck_assert_int_eq(taco_judge_hit(j, 3.4, TACO_INPUT_DON), TACO_JUDGE_POP);
+  ck_assert_int_eq(taco_judge_score(j), 28 * 300 + 5000 + 1000);
+  ck_assert_int_eq(taco_judge_hit(j, 3.6, TACO_INPUT_DON), TACO_JUDGE_NONE);
+  ck_assert_int_eq(taco_judge_count(j, TACO_JUDGE_POP), 2);
+
+  taco_judge_free(j);
+  taco_courseset_free(set);
+}
+END_TEST
+
+TCase *case_judge(void) {
+  TCase *c = tcase_create("judge");
+  tcase_add_checked_fixture(c, setup, teardown);
+  tcase_add_test(c, test_judge);
+  tcase_add_test(c, test_judge_balloon);
+  return c;
+}
@@ -1,7 +1,16 @@
 // SPDX-License-Identifier: BSD-2-Clause
+#include "tja/keyword.h"
+#include "tja/metadata.h"
 #include "tja/parser.h"
+#include "tja/shiftjis.h"
 #include <check.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include "alloc.h"
+#include "io.h"
 #include "taco.h"
 #include "tacoassert.h"
 
@@ -38,6 +47,21 @@ START_TEST(test_basic) {
 }
 END_TEST
 
+START_TEST(test_reuse) {
+  // a parser is reusable, even after failing midway
+  taco_courseset *set = taco_parser_parse_file(parser, "assets/badmeasure.tja");
+  taco_courseset_free(set);
+
+  for (int i = 0; i < 2; ++i) {
+    set = taco_parser_parse_file(parser, "assets/basic.tja");
+    ck_assert_ptr_nonnull(set);
+    ck_assert_str_eq(taco_courseset_title(set), "Example");
+    ck_assert_ptr_nonnull(taco_courseset_get_course(set, TACO_CLASS_ONI));
+    taco_courseset_free(set);
+  }
+}
+END_TEST
+
 START_TEST(test_empty) {
   taco_courseset *set = taco_parser_parse_file(parser, "assets/empty.tja");
   ck_assert_ptr_nonnull(set);
@@ -113,6 +137,34 @@ START_TEST(test_whitespace) {
 }
 END_TEST
 
+static void header_diagnostic(const taco_diagnostic *restrict diag,
+                              void *data) {
+  int *counts = data;
+  if (taco_diagnostic_code(diag) == TACO_DIAG_UNKNOWN_HEADER) {
+    counts[0] += 1;
+    // bytes scanned again are not counted twice
+    ck_assert_int_eq(taco_diagnostic_line(diag), 5);
+    ck_assert_int_eq(taco_diagnostic_column(diag), 1);
+    ck_assert_int_eq(taco_diagnostic_offset(diag), 77);
+  }
+  if (taco_diagnostic_code(diag) == TACO_DIAG_SYNTAX)
+    counts[1] += 1;
+}
+
+START_TEST(test_indented) {
+  // known headers may be indented, but unknown ones are not headers then
+  int counts[2] = {0};
+  taco_parser_set_diagnostics(parser, header_diagnostic, counts);
+  taco_courseset *set = taco_parser_parse_file(parser, "assets/indented.tja");
+  ck_assert_ptr_nonnull(set);
+  ck_assert_str_eq(taco_courseset_title(set), "Indented");
+  ck_assert_ptr_nonnull(taco_courseset_get_course(set, TACO_CLASS_ONI));
+  ck_assert_int_eq(counts[0], 1);
+  ck_assert_int_ge(counts[1], 1);
+  taco_courseset_free(set);
+}
+END_TEST
+
 START_TEST(test_commands) {
   taco_courseset *set = taco_parser_parse_file(parser, "assets/commands.tja");
   const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_ONI);
@@ -180,6 +232,203 @@ START_TEST(test_branch) {
 }
 END_TEST
 
+START_TEST(test_measure_index) {
+  taco_courseset *set = taco_parser_parse_file(parser, "assets/measures.tja");
+  const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  const taco_section *s = taco_course_get_branch(c, 0, 0);
+
+  static const int ticks[] = {0, 96, 168, 264, 360};
+  static const int lengths[] = {96, 72, 96, 96, 96};
+  ck_assert_int_eq(taco_section_measure_count(s), 5);
+  for (size_t i = 0; i < 5; ++i) {
+    const taco_measure *m = taco_section_measure(s, i);
+    ck_assert_int_eq(taco_measure_time(m), ticks[i]);
+    ck_assert_int_eq(taco_measure_length(m), lengths[i]);
+  }
+
+  const taco_measure *m = taco_section_measure_at_time(s, 4.0);
+  ck_assert_int_eq(taco_measure_index(m, s), 2);
+  ck_assert_double_eq(taco_measure_seconds(m), 3.5);
+  taco_courseset_free(set);
+}
+END_TEST
+
+START_TEST(test_tuplets) {
+  // exact tickrate overflows; timing is rounded instead
+  static const int units[] = {7, 11, 13, 17, 19, 23, 29, 31};
+
+  taco_courseset *set = taco_parser_parse_file(parser, "assets/tuplets.tja");
+  const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  ck_assert_ptr_nonnull(c);
+  const taco_section *s = taco_course_get_branch(c, 0, 0);
+  int tickrate = taco_section_tickrate(s);
+  ck_assert_int_eq(taco_section_measure_count(s), 8);
+
+  for (size_t i = 0; i < 8; ++i) {
+    const taco_measure *m = taco_section_measure(s, i);
+    ck_assert_int_eq(taco_measure_time(m), i * tickrate);
+    ck_assert_int_eq(taco_measure_length(m), tickrate);
+
+    int n = 0;
+    const taco_event *e = taco_section_locate(s, taco_measure_first_event(m));
+    for (; e != taco_section_end(s) && taco_event_time(e) < (i + 1) * tickrate;
+         e = taco_event_next(e)) {
+      if (!taco_event_is_note(e))
+        continue;
+      double expected = i * tickrate + (double)tickrate * n / units[i];
+      ck_assert_double_eq_tol(taco_event_time(e), expected, 0.5);
+      n += 1;
+    }
+    ck_assert_int_eq(n, units[i]);
+  }
+
+  taco_courseset_free(set);
+}
+END_TEST
+
+static void rounded_diagnostic(const taco_diagnostic *restrict diag,
+                               void *data) {
+  if (taco_diagnostic_code(diag) == TACO_DIAG_ROUNDED)
+    *(int *)data = taco_diagnostic_int(diag, 0);
+}
+
+START_TEST(test_rounding) {
+  // the fallback tickrate loses factors as the course grows, but always
+  // divides the one before; measures stay exact, notes within half a tick
+  static const struct {
+    int measures;
+    int tickrate;
+  } cases[] = {
+      {300, 5765760},
+      {1000, 443520},
+      {5000, 40320},
+      {60000, 5760},
+  };
+  static const char header[] = "BPM:120\nCOURSE:Oni\n#START\n";
+  static const int units[] = {17, 19, 23, 29};
+
+  int measures = cases[_i].measures;
+  size_t capacity = sizeof(header) + 32 * 4 + 3 * measures + 8;
+  char *chart = malloc(capacity);
+  ck_assert_ptr_nonnull(chart);
+  size_t size = strlen(header);
+  memcpy(chart, header, size);
+  for (int m = 0; m < 4; ++m) {
+    memset(chart + size, '1', units[m]);
+    size += units[m];
+    memcpy(chart + size, ",\n", 2);
+    size += 2;
+  }
+  for (int m = 4; m < measures; ++m) {
+    memcpy(chart + size, "1,\n", 3);
+    size += 3;
+  }
+  memcpy(chart + size, "#END\n", 5);
+  size += 5;
+
+  int rounded = 0;
+  taco_parser_set_diagnostics(parser, rounded_diagnostic, &rounded);
+  ck_assert_int_eq(taco_parser_feed(parser, chart, size), 0);
+  taco_courseset *set = taco_parser_finish(parser);
+  free(chart);
+  ck_assert_int_eq(rounded, cases[_i].tickrate);
+
+  const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  ck_assert_ptr_nonnull(c);
+  const taco_section *s = taco_course_get_branch(c, 0, 0);
+  int tickrate = taco_section_tickrate(s);
+  ck_assert_int_eq(cases[_i].tickrate % tickrate, 0);
+  ck_assert_int_eq(taco_section_measure_count(s), measures);
+
+  for (int i = 0; i < 4; ++i) {
+    const taco_measure *m = taco_section_measure(s, i);
+    ck_assert_int_eq(taco_measure_time(m), i * tickrate);
+
+    int n = 0;
+    const taco_event *e = taco_section_locate(s, taco_measure_first_event(m));
+    for (; e != taco_section_end(s) && taco_event_time(e) < (i + 1) * tickrate;
+         e = taco_event_next(e)) {
+      if (!taco_event_is_note(e))
+        continue;
+      double expected = i * tickrate + (double)tickrate * n / units[i];
+      ck_assert_double_eq_tol(taco_event_time(e), expected, 0.5);
+      n += 1;
+    }
+    ck_assert_int_eq(n, units[i]);
+  }
+
+  const taco_measure *last = taco_section_measure(s, measures - 1);
+  ck_assert_int_eq(taco_measure_time(last), (int64_t)(measures - 1) * tickrate);
+  taco_courseset_free(set);
+}
+END_TEST
+
+START_TEST(test_rational) {
+  static const int units[] = {7, 11, 13, 17, 19, 23, 29, 31};
+
+  ck_assert_int_eq(taco_parser_set_timing(parser, TACO_TIMING_RATIONAL), 0);
+  taco_courseset *set = taco_parser_parse_file(parser, "assets/tuplets.tja");
+  const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  ck_assert_ptr_nonnull(c);
+  const taco_section *s = taco_course_get_branch(c, 0, 0);
+
+  size_t index = 0;
+  int n = 0;
+  taco_section_foreach(e, s) {
+    if (!taco_event_is_note(e))
+      continue;
+
+    if (n == units[index]) {
+      index += 1;
+      n = 0;
+    }
+
+    size_t measure;
+    int num, den;
+    ck_assert_int_eq(taco_event_position(e, s, &measure, &num, &den), 0);
+    ck_assert_int_eq(measure, index);
+    ck_assert_int_eq(num * units[index], n * den);
+    ck_assert_int_eq(taco_event_time_at(e, s, units[index]),
+                     index * units[index] + n);
+
+    // 120 BPM; two seconds per measure
+    double expected = 2.0 * index + 2.0 * n / units[index];
+    ck_assert_double_eq_tol(taco_event_seconds(e, s), expected, 1e-9);
+    n += 1;
+  }
+  ck_assert_int_eq(index, 7);
+  taco_courseset_free(set);
+
+  // measures of 1/17 do not fit the fixed tickrate; their starts must not
+  // drift with rounding
+  static const char header[] = "BPM:120\nCOURSE:Oni\n#START\n#MEASURE 1/17\n";
+  char chart[sizeof(header) + 3 * 400 + 8];
+  size_t size = strlen(header);
+  memcpy(chart, header, size);
+  for (int m = 0; m < 400; ++m) {
+    memcpy(chart + size, "1,\n", 3);
+    size += 3;
+  }
+  memcpy(chart + size, "#END\n", 5);
+  size += 5;
+
+  ck_assert_int_eq(taco_parser_feed(parser, chart, size), 0);
+  set = taco_parser_finish(parser);
+  c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  ck_assert_ptr_nonnull(c);
+  s = taco_course_get_branch(c, 0, 0);
+  n = 0;
+  taco_section_foreach(e, s) {
+    if (!taco_event_is_note(e))
+      continue;
+    ck_assert_double_eq_tol(taco_event_seconds(e, s), 2.0 * n / 17, 1e-9);
+    n += 1;
+  }
+  ck_assert_int_eq(n, 400);
+  taco_courseset_free(set);
+}
+END_TEST
+
 START_TEST(test_double) {
   static const char *expected[] = {
       "assets/double_l.txt",
@@ -262,6 +511,557 @@ START_TEST(test_shiftjis) {
 }
 END_TEST
 
+START_TEST(test_encodings) {
+  static const struct {
+    const char *path;
+    int encoding;
+    const char *title;
+  } cases[] = {
+      {"assets/basic.tja", TACO_ENCODING_UTF8, "Example"},
+      {"assets/shiftjis.tja", TACO_ENCODING_SHIFT_JIS, "東京テディベア"},
+      {"assets/gb18030.tja", TACO_ENCODING_GB18030, "千本樱"},
+      {"assets/euckr.tja", TACO_ENCODING_EUC_KR, "봄날"},
+      {"assets/utf16.tja", TACO_ENCODING_UTF16LE, "千本桜"},
+  };
+
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+    taco_courseset *set = taco_parser_parse_file(parser, cases[i].path);
+    ck_assert_ptr_nonnull(set);
+    ck_assert_int_eq(taco_courseset_encoding(set), cases[i].encoding);
+    ck_assert_str_eq(taco_courseset_title(set), cases[i].title);
+    ck_assert_ptr_nonnull(taco_courseset_get_course(set, TACO_CLASS_ONI));
+    taco_courseset_free(set);
+  }
+}
+END_TEST
+
+START_TEST(test_cp932) {
+  char out[64];
+  size_t consumed;
+
+  // half-width katakana, an NEC special character and ASCII past eight bytes
+  const char text[] = "\xb6\xc0\xba\x87\x40 taco drum!";
+  const char expected[] = "ｶﾀｺ① taco drum!";
+  size_t size = tja_cp932_decode_(text, sizeof(text) - 1, out, &consumed, 0);
+  ck_assert_uint_eq(consumed, sizeof(text) - 1);
+  ck_assert_uint_eq(size, sizeof expected - 1);
+  ck_assert_mem_eq(out, expected, size);
+
+  // an invalid pair only loses its lead byte
+  const char replaced[] = "\xef\xbf\xbd" "9" "\xef\xa3\xb0";
+  size = tja_cp932_decode_("\x81\x39\xa0", 3, out, &consumed, 0);
+  ck_assert_uint_eq(consumed, 3);
+  ck_assert_uint_eq(size, sizeof replaced - 1);
+  ck_assert_mem_eq(out, replaced, size);
+
+  // a lead byte at the end waits for more input
+  size = tja_cp932_decode_("a\x93", 2, out, &consumed, 0);
+  ck_assert_uint_eq(consumed, 1);
+  ck_assert_uint_eq(size, 1);
+  size = tja_cp932_decode_("a\x93", 2, out, &consumed, 1);
+  ck_assert_uint_eq(consumed, 2);
+  ck_assert_uint_eq(size, 4);
+  ck_assert_mem_eq(out, "a\xef\xbf\xbd", size);
+}
+END_TEST
+
+typedef struct trickle_ trickle;
+
+// An in-memory stream read a few bytes at a time, which cannot seek.
+struct trickle_ {
+  const char *data;
+  size_t size;
+  size_t pos;
+};
+
+static size_t trickle_read(void *restrict dst, size_t size, size_t count,
+                           void *restrict stream) {
+  trickle *t = stream;
+  size_t n = size * count < 3 ? size * count : 3;
+  if (n > t->size - t->pos)
+    n = t->size - t->pos;
+  memcpy(dst, t->data + t->pos, n);
+  t->pos += n;
+  return n;
+}
+
+static const taco_io trickle_io = {
+    .version = sizeof(taco_io),
+    .read = trickle_read,
+};
+
+START_TEST(test_unseekable) {
+  // UTF-8 up front, then Shift_JIS long after detection has passed
+  const char head[] = "SUBTITLE:--\xc3\xbc\n";
+  const char tail[] = "TITLE:\x93\x8c\x8b\x9e\nBPM:204\nCOURSE:3\n"
+                      "LEVEL:8\n\n#START\n#END\n";
+  size_t comments = 20000;
+  size_t size = strlen(head) + comments + strlen(tail);
+  char *data = malloc(size + 1);
+  strcpy(data, head);
+  for (size_t i = 0; i < comments; i += 10)
+    strcat(data + i, "//comment\n");
+  strcpy(data + strlen(head) + comments, tail);
+
+  trickle t = {data, size, 0};
+  taco_file *f =
+      taco_file_open_(&taco_default_allocator_, &t, "<trickle>", &trickle_io);
+  tja_parser *p = tja_parser_create_();
+  taco_courseset *set = tja_parser_parse_(p, f);
+  ck_assert_ptr_nonnull(set);
+  ck_assert_str_eq(taco_courseset_title(set), "東京");
+  ck_assert_str_eq(taco_courseset_subtitle(set), "ü");
+  ck_assert_ptr_nonnull(taco_courseset_get_course(set, TACO_CLASS_ONI));
+
+  taco_courseset_free(set);
+  tja_parser_free_(p);
+  taco_file_close_(f);
+  free(data);
+}
+END_TEST
+
+// Feeds a file to the parser a few bytes at a time.
+static taco_courseset *feed_file(const char *path, size_t chunk) {
+  FILE *f = fopen(path, "rb");
+  ck_assert_ptr_nonnull(f);
+  char buf[64];
+  size_t n;
+  while ((n = fread(buf, 1, chunk, f)) > 0)
+    ck_assert_int_eq(taco_parser_feed(parser, buf, n), 0);
+  fclose(f);
+  return taco_parser_finish(parser);
+}
+
+START_TEST(test_push) {
+  taco_courseset *set = feed_file("assets/basic.tja", 1);
+  ck_assert_ptr_nonnull(set);
+  ck_assert_str_eq(taco_courseset_title(set), "Example");
+  const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  assert_section_eq(taco_course_get_branch(c, 0, 0), "assets/basic.txt",
+                    assert_section);
+  taco_courseset_free(set);
+
+  // characters and UTF-16 code units split across chunks
+  set = feed_file("assets/shiftjis.tja", 7);
+  ck_assert_str_eq(taco_courseset_title(set), "東京テディベア");
+  taco_courseset_free(set);
+  set = feed_file("assets/utf16.tja", 3);
+  ck_assert_int_eq(taco_courseset_encoding(set), TACO_ENCODING_UTF16LE);
+  ck_assert_str_eq(taco_courseset_title(set), "千本桜");
+  ck_assert_ptr_nonnull(taco_courseset_get_course(set, TACO_CLASS_ONI));
+  taco_courseset_free(set);
+
+  // a long file, changing encoding past the first lines parsed
+  char line[] = "//comment\n";
+  for (int i = 0; i < 4000; ++i)
+    ck_assert_int_eq(taco_parser_feed(parser, line, strlen(line)), 0);
+  const char tail[] = "TITLE:\x93\x8c\x8b\x9e\nCOURSE:3\n#START\n1,\n#END";
+  ck_assert_int_eq(taco_parser_feed(parser, tail, strlen(tail)), 0);
+  set = taco_parser_finish(parser);
+  ck_assert_str_eq(taco_courseset_title(set), "東京");
+  ck_assert_ptr_nonnull(taco_courseset_get_course(set, TACO_CLASS_ONI));
+  taco_courseset_free(set);
+
+  // whole files cannot be parsed while one is fed
+  ck_assert_int_eq(taco_parser_feed(parser, tail, strlen(tail)), 0);
+  ck_assert_ptr_null(taco_parser_parse_file(parser, "assets/basic.tja"));
+  set = taco_parser_finish(parser);
+  ck_assert_str_eq(taco_courseset_title(set), "東京");
+  ck_assert_ptr_nonnull(taco_courseset_get_course(set, TACO_CLASS_ONI));
+  taco_courseset_free(set);
+
+  // input left unfinished is freed with the parser
+  taco_parser *p = taco_parser_tja_create();
+  ck_assert_int_eq(taco_parser_feed(p, tail, strlen(tail)), 0);
+  taco_parser_free(p);
+
+  // nothing fed at all
+  set = taco_parser_finish(parser);
+  ck_assert_ptr_nonnull(set);
+  ck_assert_str_eq(taco_courseset_title(set), "Untitled");
+  taco_courseset_free(set);
+}
+END_TEST
+
+START_TEST(test_step) {
+  // even a small chart is parsed before the input ends
+  FILE *f = fopen("assets/notesdesigner.tja", "rb");
+  ck_assert_ptr_nonnull(f);
+  char buf[512];
+  size_t n = fread(buf, 1, sizeof(buf), f);
+  fclose(f);
+  ck_assert_int_eq(taco_parser_feed(parser, buf, n), 0);
+
+  // no budget still gets some work done
+  int steps = 0, result;
+  while ((result = taco_parser_step(parser, 0)) == TACO_STEP_MORE)
+    steps += 1;
+  ck_assert_int_eq(result, 0);
+  ck_assert_int_gt(steps, 1);
+  ck_assert_int_eq(taco_parser_step(parser, 1000000), 0);
+
+  taco_courseset *set = taco_parser_finish(parser);
+  const char *expected = "\xe6\xb2\xa1\xe7\x9c\x8b\xe6\x87\x82";
+  const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_EX);
+  ck_assert_str_eq(taco_course_maker(c), expected);
+  c = taco_courseset_get_course(set, TACO_CLASS_EASY);
+  ck_assert_str_eq(taco_course_maker(c), expected);
+  taco_courseset_free(set);
+
+  // courses failing post processing are dropped
+  f = fopen("assets/badbranch.tja", "rb");
+  ck_assert_ptr_nonnull(f);
+  n = fread(buf, 1, sizeof(buf), f);
+  fclose(f);
+  ck_assert_int_eq(taco_parser_feed(parser, buf, n), 0);
+  while ((result = taco_parser_step(parser, 1000000)) == TACO_STEP_MORE)
+    continue;
+  ck_assert_int_eq(result, 0);
+  set = taco_parser_finish(parser);
+  ck_assert_ptr_null(taco_courseset_get_course(set, TACO_CLASS_ONI));
+  taco_courseset_free(set);
+
+  // lines ending with carriage returns only
+  const char cr[] = "TITLE:Carriage returns\rCOURSE:Oni\rLEVEL:1\r\r"
+                    "#START\r1020102010201020,\r#END\r";
+  ck_assert_int_eq(taco_parser_feed(parser, cr, strlen(cr)), 0);
+  steps = 0;
+  while ((result = taco_parser_step(parser, 0)) == TACO_STEP_MORE)
+    steps += 1;
+  ck_assert_int_eq(result, 0);
+  ck_assert_int_gt(steps, 0);
+  set = taco_parser_finish(parser);
+  ck_assert_str_eq(taco_courseset_title(set), "Carriage returns");
+  ck_assert_ptr_nonnull(taco_courseset_get_course(set, TACO_CLASS_ONI));
+  taco_courseset_free(set);
+}
+END_TEST
+
+static void count_diagnostic(const taco_diagnostic *restrict diag,
+                             void *data) {
+  int *count = data;
+  *count += 1;
+  ck_assert_str_eq(taco_diagnostic_file(diag), "assets/badbranch.tja");
+
+  char buf[64];
+  if (taco_diagnostic_code(diag) == TACO_DIAG_BRANCH_DIVERGES &&
+      taco_diagnostic_line(diag) == 16) {
+    ck_assert_int_eq(taco_diagnostic_severity(diag), TACO_SEVERITY_ERROR);
+    ck_assert_int_eq(taco_diagnostic_arg_count(diag), 2);
+    ck_assert_str_eq(taco_diagnostic_string(diag, 0), "master");
+    ck_assert_str_eq(taco_diagnostic_string(diag, 1), "normal");
+    ck_assert_int_eq(taco_diagnostic_column(diag), 0);
+    ck_assert_int_eq(taco_diagnostic_format(diag, buf, sizeof(buf)), 44);
+    ck_assert_str_eq(buf, "timing of branch master diverges from normal");
+    // cut short like snprintf
+    ck_assert_int_eq(taco_diagnostic_format(diag, buf, 7), 44);
+    ck_assert_str_eq(buf, "timing");
+  }
+}
+
+START_TEST(test_diagnostics) {
+  int count = 0;
+  taco_parser_set_diagnostics(parser, count_diagnostic, &count);
+  taco_courseset *set =
+      taco_parser_parse_file(parser, "assets/badbranch.tja");
+  taco_courseset_free(set);
+  ck_assert_int_ge(count, 2);
+
+  // less severe diagnostics are dropped
+  count = 0;
+  ck_assert_int_eq(taco_parser_set_severity(parser, TACO_SEVERITY_FATAL), 0);
+  set = taco_parser_parse_file(parser, "assets/badbranch.tja");
+  taco_courseset_free(set);
+  ck_assert_int_eq(count, 0);
+  ck_assert_int_eq(taco_parser_set_severity(parser, 4), -1);
+}
+END_TEST
+
+static void locate_diagnostic(const taco_diagnostic *restrict diag,
+                              void *data) {
+  if (taco_diagnostic_code(diag) == TACO_DIAG_UNKNOWN_COMMAND)
+    *(int *)data += 1;
+  ck_assert_int_eq(taco_diagnostic_line(diag), 2);
+  ck_assert_int_eq(taco_diagnostic_column(diag), 3);
+  ck_assert_int_eq(taco_diagnostic_offset(diag), 9);
+}
+
+START_TEST(test_sources) {
+  FILE *f = fopen("assets/branch.tja", "rb");
+  ck_assert_ptr_nonnull(f);
+  char buf[512];
+  size_t n = fread(buf, 1, sizeof(buf), f);
+  fclose(f);
+
+  taco_courseset *set = taco_parser_parse_file(parser, "assets/branch.tja");
+  const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  const taco_section *s = taco_course_get_branch(c, 0, TACO_BRANCH_MASTER);
+  ck_assert_int_eq(taco_event_source(taco_section_begin(s), s, NULL, NULL,
+                                     NULL),
+                   -1);
+  taco_courseset_free(set);
+
+  ck_assert_int_eq(taco_parser_set_sources(parser, 1), 0);
+  set = taco_parser_parse_file(parser, "assets/branch.tja");
+  c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  s = taco_course_get_branch(c, 0, TACO_BRANCH_MASTER);
+
+  int notes = 0, branches = 0;
+  taco_section_foreach(i, s) {
+    uint64_t offset;
+    int line, column;
+    if (taco_event_source(i, s, &offset, &line, &column) != 0) {
+      // only the initial BPM is not in the input
+      ck_assert_int_eq(taco_event_type(i), TACO_EVENT_BPM);
+      continue;
+    }
+    ck_assert_uint_lt(offset, n);
+
+    int lines = 1, start = 0;
+    for (uint64_t j = 0; j < offset; ++j) {
+      if (buf[j] == '\n') {
+        lines += 1;
+        start = j + 1;
+      }
+    }
+    ck_assert_int_eq(line, lines);
+    ck_assert_int_eq(column, offset - start + 1);
+
+    switch (taco_event_type(i)) {
+    case TACO_EVENT_DON:
+      ck_assert_int_eq(buf[offset], '1');
+      notes += 1;
+      break;
+    case TACO_EVENT_KAT:
+      ck_assert_int_eq(buf[offset], '2');
+      notes += 1;
+      break;
+    case TACO_EVENT_BRANCH_START:
+    case TACO_EVENT_BRANCH_CHECK:
+    case TACO_EVENT_BRANCH_JUMP:
+      ck_assert_int_eq(memcmp(buf + offset, "#BRANCHSTART", 12), 0);
+      branches += 1;
+      break;
+    }
+  }
+  ck_assert_int_eq(notes, 7);
+  ck_assert_int_eq(branches, 3);
+  taco_courseset_free(set);
+
+  // diagnostics are located too
+  int count = 0;
+  const char chart[] = "#START\n  #FOO\n1,\n#END\n";
+  taco_parser_set_diagnostics(parser, locate_diagnostic, &count);
+  ck_assert_int_eq(taco_parser_feed(parser, chart, strlen(chart)), 0);
+  taco_courseset_free(taco_parser_finish(parser));
+  ck_assert_int_eq(count, 1);
+}
+END_TEST
+
+static void tally_diagnostic(const taco_diagnostic *restrict diag,
+                             void *data) {
+  int *count = data;
+  *count += 1;
+}
+
+START_TEST(test_keywords) {
+  // every keyword is found by name; one overwriting another on a collision
+  // would go missing here
+  static const char *const headers[] = {
+      "TITLE",          "SUBTITLE",       "GENRE",          "MAKER",
+      "WAVE",           "BPM",            "OFFSET",         "DEMOSTART",
+      "SIDE",           "COURSE",         "LEVEL",          "STYLE",
+      "SCOREINIT",      "SCOREDIFF",      "BALLOON",        "BALLOONNOR",
+      "BALLOONEXP",     "BALLOONMAS",     "NOTESDESIGNER",  "NOTESDESIGNER0",
+      "NOTESDESIGNER1", "NOTESDESIGNER2", "NOTESDESIGNER3", "NOTESDESIGNER4",
+  };
+  static const char *const commands[] = {
+      "PAPAMAMA",  "START",      "NMSCROLL",  "BMSCROLL",  "HBSCROLL",
+      "END",       "BRANCHSTART", "N",        "E",         "M",
+      "BRANCHEND", "MEASURE",    "SECTION",   "LEVELHOLD", "GOGOSTART",
+      "GOGOEND",   "SCROLL",     "BPMCHANGE", "DELAY",     "BARLINEON",
+      "BARLINEOFF", "BARLINE",   "SUDDEN",    "DIRECTION", "JPOSSCROLL",
+  };
+  const size_t header_count = sizeof(headers) / sizeof(*headers);
+  const size_t command_count = sizeof(commands) / sizeof(*commands);
+  for (size_t i = 0; i < header_count; ++i) {
+    const tja_keyword *k =
+        tja_keyword_find_(tja_header_keywords_, headers[i], strlen(headers[i]));
+    ck_assert_ptr_nonnull(k);
+    ck_assert_str_eq(k->name, headers[i]);
+  }
+  for (size_t i = 0; i < command_count; ++i) {
+    const tja_keyword *k = tja_keyword_find_(tja_command_keywords_, commands[i],
+                                             strlen(commands[i]));
+    ck_assert_ptr_nonnull(k);
+    ck_assert_str_eq(k->name, commands[i]);
+  }
+
+  // and nothing else is in the tables
+  const tja_keyword *tables[] = {tja_header_keywords_, tja_command_keywords_};
+  const size_t counts[] = {header_count, command_count};
+  for (int t = 0; t < 2; ++t) {
+    size_t filled = 0;
+    for (int i = 0; i < TJA_KEYWORD_SLOTS; ++i)
+      filled += tables[t][i].name != NULL;
+    ck_assert_uint_eq(filled, counts[t]);
+  }
+
+  ck_assert_int_eq(tja_interpret_course_("Easy"), TACO_CLASS_EASY);
+  ck_assert_int_eq(tja_interpret_course_("normal"), TACO_CLASS_NORMAL);
+  ck_assert_int_eq(tja_interpret_course_("HARD"), TACO_CLASS_HARD);
+  ck_assert_int_eq(tja_interpret_course_("edit"), TACO_CLASS_EX);
+  ck_assert_int_eq(tja_interpret_side_("Ex"), TACO_CLASS_EX_EASY);
+  ck_assert_int_eq(tja_interpret_side_("both"), TACO_CLASS_EASY);
+  ck_assert_ptr_null(tja_keyword_find_(tja_command_keywords_, "SCROL", 5));
+  ck_assert_ptr_null(tja_keyword_find_(tja_command_keywords_, "", 0));
+
+  // keywords and values are recognized in any case
+  int count = 0;
+  const char chart[] = "title:Lower\ncourse:hard\n"
+                       "#start\n#BpmChange 240\n1,\n#end\n";
+  taco_parser_set_diagnostics(parser, tally_diagnostic, &count);
+  ck_assert_int_eq(taco_parser_feed(parser, chart, strlen(chart)), 0);
+  taco_courseset *set = taco_parser_finish(parser);
+  ck_assert_int_eq(count, 0);
+  ck_assert_str_eq(taco_courseset_title(set), "Lower");
+
+  const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_HARD);
+  ck_assert_ptr_nonnull(c);
+  const taco_section *s = taco_course_get_branch(c, 0, 0);
+  int bpm = 0;
+  taco_section_foreach(i, s) {
+    if (taco_event_type(i) == TACO_EVENT_BPM && taco_event_bpm(i) == 240)
+      bpm += 1;
+  }
+  ck_assert_int_eq(bpm, 1);
+  taco_courseset_free(set);
+}
+END_TEST
+
+START_TEST(test_tjap3_commands) {
+  int count = 0;
+  const char chart[] = "BPM:240\nCOURSE:Oni\n#HBSCROLL\n#START\n"
+                       "#SCROLL 1+2i\n1,\n"
+                       "#SUDDEN 2 1\n#DIRECTION 1\n1,\n"
+                       "#JPOSSCROLL 0.5 100 0\n#SCROLL 2\n1,\n#END\n";
+  taco_parser_set_diagnostics(parser, tally_diagnostic, &count);
+  ck_assert_int_eq(taco_parser_feed(parser, chart, strlen(chart)), 0);
+  taco_courseset *set = taco_parser_finish(parser);
+  ck_assert_int_eq(count, 0);
+
+  const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  ck_assert_int_eq(taco_course_scrollmode(c), TACO_SCROLLMODE_HB);
+
+  const taco_section *s = taco_course_get_branch(c, 0, 0);
+  double x, y, appear, move;
+  taco_motion motion;
+  int notes = 0;
+  taco_section_foreach(i, s) {
+    switch (taco_event_type(i)) {
+    case TACO_EVENT_SCROLL_COMPLEX:
+      ck_assert_int_eq(taco_event_scroll(i, &x, &y), 0);
+      ck_assert_double_eq(x, 1);
+      ck_assert_double_eq(y, 2);
+      break;
+    case TACO_EVENT_SUDDEN:
+      ck_assert_int_eq(taco_event_sudden(i, &appear, &move), 0);
+      ck_assert_double_eq(appear, 2);
+      ck_assert_double_eq(move, 1);
+      break;
+    case TACO_EVENT_DIRECTION:
+      ck_assert_int_eq(taco_event_direction(i), TACO_DIRECTION_TOP);
+      break;
+    case TACO_EVENT_JPOSSCROLL:
+      ck_assert_int_eq(taco_event_jposscroll(i, &x, &y), 0);
+      ck_assert_double_eq(x, 0.5);
+      ck_assert_double_eq(y, -100);
+      break;
+    case TACO_EVENT_DON:
+      ck_assert_int_eq(taco_event_motion(i, s, &motion), 0);
+      notes += 1;
+      break;
+    }
+
+    if (notes == 1 && taco_event_type(i) == TACO_EVENT_DON) {
+      // a measure at 240 BPM takes a second
+      ck_assert_double_eq(motion.x, 1);
+      ck_assert_double_eq(motion.y, 2);
+      ck_assert(isinf(motion.appear));
+      ck_assert_int_eq(taco_motion_offset(&motion, 0.5, &x, &y), 0);
+      ck_assert_double_eq(x, 0.5);
+      ck_assert_double_eq(y, 1);
+    } else if (notes == 2 && taco_event_type(i) == TACO_EVENT_DON) {
+      // coming from the top turns the scroll speed a quarter turn
+      ck_assert_double_eq(motion.x, -2);
+      ck_assert_double_eq(motion.y, 1);
+      ck_assert_int_eq(taco_motion_offset(&motion, 3, &x, &y), -1);
+      ck_assert_int_eq(taco_motion_offset(&motion, 1.5, &x, &y), 0);
+      ck_assert_double_eq(x, -2);
+      ck_assert_double_eq(y, 1);
+    } else if (notes == 3 && taco_event_type(i) == TACO_EVENT_DON) {
+      ck_assert_double_eq(motion.x, 0);
+      ck_assert_double_eq(motion.y, 2);
+    }
+  }
+  ck_assert_int_eq(notes, 3);
+  taco_courseset_free(set);
+}
+END_TEST
+
+START_TEST(test_scroll_curves) {
+  static const char *const headers[] = {"#NMSCROLL", "#BMSCROLL", "#HBSCROLL"};
+  static const int modes[] = {TACO_SCROLLMODE_TAIKO, TACO_SCROLLMODE_BM,
+                              TACO_SCROLLMODE_HB};
+  // the second note is at 1 measure and 2 seconds, after a delay
+  static const double anchors[] = {2, 1, 1};
+  static const double speeds[] = {1, 1, 2};
+
+  for (int m = 0; m < 3; ++m) {
+    char chart[128];
+    snprintf(chart, sizeof(chart),
+             "BPM:240\nCOURSE:Oni\n%s\n#START\n#SCROLL 2\n1,\n"
+             "#DELAY 1\n#BPMCHANGE 120\n1,\n#END\n",
+             headers[m]);
+    taco_parser *p = taco_parser_tja_create();
+    ck_assert_int_eq(taco_parser_feed(p, chart, strlen(chart)), 0);
+    taco_courseset *set = taco_parser_finish(p);
+    taco_parser_free(p);
+
+    const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+    const taco_section *s = taco_course_get_branch(c, 0, 0);
+    taco_scroll scroll;
+    ck_assert_int_eq(taco_section_scroll(s, &scroll), 0);
+    ck_assert_int_eq(scroll.mode, modes[m]);
+    ck_assert_uint_eq(scroll.count, 4); // two barlines and two notes
+
+    // progress stops during the delay under BM and HB scrolling
+    double p1 = taco_section_scroll_progress(s, scroll.mode, 1.5);
+    double p2 = taco_section_scroll_progress(s, scroll.mode, 2.5);
+    ck_assert_double_eq_tol(p1, m == 0 ? 1.5 : 1, 1e-9);
+    ck_assert_double_eq_tol(p2, m == 0 ? 2.5 : 1.25, 1e-9);
+
+    size_t note = scroll.count;
+    for (size_t i = 0; i < scroll.count; ++i) {
+      const taco_event *e = taco_section_locate(s, scroll.events[i]);
+      if (taco_event_type(e) == TACO_EVENT_DON)
+        note = i;
+    }
+    ck_assert_uint_lt(note, scroll.count);
+    ck_assert_double_eq_tol(scroll.anchor[note], anchors[m], 1e-9);
+    ck_assert_double_eq_tol(scroll.x[note], speeds[m], 1e-6);
+    ck_assert(isinf(scroll.appear[note]));
+
+    double x, y;
+    double p0 = taco_section_scroll_progress(s, scroll.mode, 0.5);
+    ck_assert_int_eq(taco_scroll_position(&scroll, note, p0, &x, &y), 0);
+    ck_assert_double_eq_tol(x, speeds[m] * (anchors[m] - p0), 1e-6);
+    ck_assert_double_eq_tol(y, 0, 1e-9);
+    taco_courseset_free(set);
+  }
+}
+END_TEST
+
 START_TEST(test_div0) {
   taco_courseset *set = taco_parser_parse_file(parser, "assets/div0.tja");
   ck_assert_ptr_null(taco_courseset_get_course(set, TACO_CLASS_ONI));
@@ -316,23 +1116,39 @@ TCase *case_parser(void) {
   tcase_add_test(c, test_basic);
   tcase_add_test(c, test_bom);
   tcase_add_loop_test(c, test_branch, 0, 3);
-  tcase_add_test(c, test_commands);
   tcase_add_test(c, test_checkpoint);
+  tcase_add_test(c, test_commands);
+  tcase_add_test(c, test_cp932);
   tcase_add_test(c, test_crlf);
   tcase_add_test(c, test_delay);
+  tcase_add_test(c, test_diagnostics);
   tcase_add_test(c, test_div0);
   tcase_add_test(c, test_division);
   tcase_add_loop_test(c, test_double, 0, 2);
   tcase_add_test(c, test_empty);
   tcase_add_test(c, test_emptymeasures);
+  tcase_add_test(c, test_encodings);
   tcase_add_test(c, test_eof);
   tcase_add_test(c, test_hand);
+  tcase_add_test(c, test_indented);
+  tcase_add_test(c, test_keywords);
   tcase_add_test(c, test_label);
+  tcase_add_test(c, test_measure_index);
   tcase_add_test(c, test_measures);
   tcase_add_test(c, test_notesdesigner);
   tcase_add_test(c, test_opentaiko_ext);
+  tcase_add_test(c, test_push);
+  tcase_add_test(c, test_rational);
+  tcase_add_test(c, test_reuse);
+  tcase_add_loop_test(c, test_rounding, 0, 4);
+  tcase_add_test(c, test_scroll_curves);
   tcase_add_test(c, test_shiftjis);
+  tcase_add_test(c, test_sources);
+  tcase_add_test(c, test_step);
   tcase_add_test(c, test_subtitle);
+  tcase_add_test(c, test_tjap3_commands);
+  tcase_add_test(c, test_tuplets);
+  tcase_add_test(c, test_unseekable);
   tcase_add_test(c, test_whitespace);
   return c;
 }
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include <check.h>
+
+#include "taco.h"
+
+static taco_parser *parser;
+
+static void setup(void) { parser = taco_parser_tja_create(); }
+
+static void teardown(void) { taco_parser_free(parser); }
+
+static int collect_path(const unsigned char *branches, size_t count,
+                        const taco_score *score, void *data) {
+  taco_score *scores = data;
+  ck_assert_int_eq(count, 1);
+  scores[branches[0]] = *score;
+  return 0;
+}
+
+START_TEST(test_path) {
+  taco_courseset *set = taco_parser_parse_file(parser, "assets/branch.tja");
+  ck_assert_ptr_nonnull(set);
+  const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  const taco_section *m =
+      taco_course_get_branch(c, TACO_SIDE_LEFT, TACO_BRANCH_MASTER);
+
+  // the master path ends with the events of the master branch
+  unsigned char branches[] = {TACO_BRANCH_MASTER};
+  taco_path *p = taco_path_create(c, TACO_SIDE_LEFT, branches, 1);
+  ck_assert_ptr_nonnull(p);
+  const taco_event *e, *last = NULL;
+  int notes = 0;
+  while ((e = taco_path_next(p))) {
+    notes += taco_event_is_normal_note(e);
+    last = e;
+  }
+  ck_assert_ptr_eq(last, taco_event_prev(taco_section_end(m)));
+  ck_assert_ptr_eq(taco_path_section(p), m);
+  ck_assert_int_eq(notes, 7);
+  ck_assert_int_eq(taco_path_jumps(p), 1);
+
+  taco_score path_score, score;
+  ck_assert_int_eq(taco_path_score(p, TACO_RULES_AC15, &path_score), 0);
+  taco_section_score(m, c, TACO_RULES_AC15, &score);
+  ck_assert_int_eq(path_score.ceiling, score.ceiling);
+  taco_path_free(p);
+
+  // every branch is reachable
+  taco_score scores[3] = {{0}};
+  ck_assert_int_eq(taco_course_foreach_path(c, TACO_SIDE_LEFT,
+                                            TACO_RULES_AC15, collect_path,
+                                            scores),
+                   0);
+  ck_assert_int_eq(scores[TACO_BRANCH_NORMAL].combo, 5);
+  ck_assert_int_eq(scores[TACO_BRANCH_ADVANCED].combo, 6);
+  ck_assert_int_eq(scores[TACO_BRANCH_MASTER].ceiling, score.ceiling);
+
+  // the master path has the highest ceiling
+  taco_ceilings ceilings;
+  ck_assert_int_eq(
+      taco_course_ceilings(c, TACO_SIDE_LEFT, TACO_RULES_AC15, &ceilings), 0);
+  ck_assert_double_eq(ceilings.paths, 3);
+  ck_assert_int_eq(ceilings.max, score.ceiling);
+  ck_assert_int_lt(ceilings.min, ceilings.max);
+
+  taco_courseset_free(set);
+}
+END_TEST
+
+TCase *case_path(void) {
+  TCase *c = tcase_create("path");
+  tcase_add_checked_fixture(c, setup, teardown);
+  tcase_add_test(c, test_path);
+  return c;
+}
@@ -0,0 +1,60 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include <check.h>
+
+#include "taco.h"
+
+static taco_parser *parser;
+
+static void setup(void) { parser = taco_parser_tja_create(); }
+
+static void teardown(void) { taco_parser_free(parser); }
+
+START_TEST(test_replay) {
+  taco_courseset *set = taco_parser_parse_file(parser, "assets/branch.tja");
+  ck_assert_ptr_nonnull(set);
+  const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+
+  static const taco_hit full[] = {
+      {0, TACO_INPUT_DON}, {1, TACO_INPUT_DON},   {2, TACO_INPUT_KAT},
+      {4, TACO_INPUT_DON}, {4.5, TACO_INPUT_DON}, {5, TACO_INPUT_KAT},
+      {6, TACO_INPUT_DON},
+  };
+  static const taco_hit oks[] = {
+      {0.05, TACO_INPUT_DON}, {0.95, TACO_INPUT_DON}, {4, TACO_INPUT_DON},
+      {5, TACO_INPUT_KAT},    {3, TACO_INPUT_DON},
+  };
+
+  unsigned char paths[4][2];
+  taco_replay replays[4] = {
+      {.hits = full, .count = 7, .path = paths[0], .path_size = 2},
+      {.hits = oks, .count = 4, .path = paths[1], .path_size = 2},
+      {.hits = NULL, .count = 0, .path = paths[2], .path_size = 2},
+      {.hits = oks, .count = 5, .path = paths[3], .path_size = 2},
+  };
+  ck_assert_int_eq(taco_replay_validate(c, TACO_SIDE_LEFT, replays, 4, 2), 0);
+
+  ck_assert_int_eq(replays[0].valid, 1);
+  ck_assert_int_eq(replays[0].max_combo, 7);
+  ck_assert_int_eq(replays[0].counts[TACO_JUDGE_GOOD], 7);
+  ck_assert_int_eq(replays[0].jumps, 1);
+  ck_assert_int_eq(paths[0][0], TACO_BRANCH_MASTER);
+
+  ck_assert_int_eq(replays[1].counts[TACO_JUDGE_OK], 2);
+  ck_assert_int_eq(paths[1][0], TACO_BRANCH_ADVANCED);
+  ck_assert_int_eq(replays[2].counts[TACO_JUDGE_BAD], 5);
+  ck_assert_int_eq(paths[2][0], TACO_BRANCH_NORMAL);
+
+  // an input out of order is skipped, but makes the replay invalid
+  ck_assert_int_eq(replays[3].valid, 0);
+  ck_assert_int_eq(replays[3].score, replays[1].score);
+
+  taco_courseset_free(set);
+}
+END_TEST
+
+TCase *case_replay(void) {
+  TCase *c = tcase_create("replay");
+  tcase_add_checked_fixture(c, setup, teardown);
+  tcase_add_test(c, test_replay);
+  return c;
+}
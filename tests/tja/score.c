@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include <check.h>
+
+#include "taco.h"
+
+static taco_parser *parser;
+
+static void setup(void) { parser = taco_parser_tja_create(); }
+
+static void teardown(void) { taco_parser_free(parser); }
+
+START_TEST(test_score) {
+  taco_courseset *set = taco_parser_parse_file(parser, "assets/checkpoint.tja");
+  ck_assert_ptr_nonnull(set);
+  const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  const taco_section *b =
+      taco_course_get_branch(c, TACO_SIDE_LEFT, TACO_BRANCH_MASTER);
+
+  taco_score all[TACO_RULES_MAX];
+  ck_assert_int_eq(taco_section_score_all(b, c, all), 0);
+  for (int r = 0; r < TACO_RULES_MAX; ++r) {
+    taco_score one;
+    ck_assert_int_eq(taco_section_score(b, c, r, &one), 0);
+    ck_assert_int_eq(one.base, all[r].base);
+    ck_assert_int_eq(one.ceiling, all[r].ceiling);
+  }
+
+  // no course scores; falls back to ac15
+  ck_assert_int_eq(all[TACO_RULES_DEFAULT].base, all[TACO_RULES_AC15].base);
+  // balloons only
+  ck_assert_int_eq(all[TACO_RULES_AC16].combo, 0);
+  ck_assert_int_eq(all[TACO_RULES_AC16].ceiling, 3000);
+
+  taco_score s;
+  ck_assert_int_eq(taco_section_score(b, c, TACO_RULES_MAX, &s), -1);
+
+  taco_courseset_free(set);
+}
+END_TEST
+
+// Scores of the normal branch and ceilings over all paths, by rules.
+typedef struct golden_ {
+  const char *path;
+  taco_score scores[TACO_RULES_MAX];
+  taco_ceilings ceilings[TACO_RULES_MAX];
+} golden;
+
+static const golden goldens[] = {
+    {"assets/branch.tja",
+     {{140000, 35000, 700000, 5},
+      {200000, 0, 1000000, 5},
+      {200000, 0, 1000000, 5},
+      {140000, 35000, 700000, 5},
+      {200000, 0, 1000000, 5}},
+     {{500000, 700000, 3},
+      {714300, 1000020, 3},
+      {714300, 1000020, 3},
+      {500000, 700000, 3},
+      {714300, 1000020, 3}}},
+    {"assets/checkpoint.tja",
+     {{0, 0, 7700, 0},
+      {0, 0, 7700, 0},
+      {0, 0, 3000, 0},
+      {0, 0, 7700, 0},
+      {0, 0, 7700, 0}},
+     {{7700, 7700, 1},
+      {7700, 7700, 1},
+      {3000, 3000, 1},
+      {7700, 7700, 1},
+      {7700, 7700, 1}}},
+    {"assets/hand.tja",
+     {{77780, 19445, 700020, 6},
+      {111120, 0, 1000080, 6},
+      {166670, 0, 1000020, 6},
+      {77780, 19445, 700020, 6},
+      {111120, 0, 1000080, 6}},
+     {{700020, 700020, 1},
+      {1000080, 1000080, 1},
+      {1000020, 1000020, 1},
+      {700020, 700020, 1},
+      {1000080, 1000080, 1}}},
+    {"assets/scoreinit.tja",
+     {{118720, 29679, 1044720, 8},
+      {124340, 0, 994720, 8},
+      {124250, 0, 994000, 8},
+      {1000, 250, 8800, 8},
+      {2000, 0, 17600, 8}},
+     {{1044720, 1044720, 1},
+      {994720, 994720, 1},
+      {994000, 994000, 1},
+      {8800, 8800, 1},
+      {17600, 17600, 1}}},
+    {"assets/tuplets.tja",
+     {{2180, 545, 690960, 150},
+      {6670, 0, 1000500, 150},
+      {6670, 0, 1000500, 150},
+      {2180, 545, 690960, 150},
+      {6670, 0, 1000500, 150}},
+     {{690960, 690960, 1},
+      {1000500, 1000500, 1},
+      {1000500, 1000500, 1},
+      {690960, 690960, 1},
+      {1000500, 1000500, 1}}},
+};
+
+START_TEST(test_golden) {
+  const golden *g = &goldens[_i];
+  taco_courseset *set = taco_parser_parse_file(parser, g->path);
+  ck_assert_ptr_nonnull(set);
+  const taco_course *c = taco_courseset_get_course(set, TACO_CLASS_ONI);
+  const taco_section *b =
+      taco_course_get_branch(c, TACO_SIDE_LEFT, TACO_BRANCH_NORMAL);
+
+  taco_score all[TACO_RULES_MAX];
+  ck_assert_int_eq(taco_section_score_all(b, c, all), 0);
+  for (int r = 0; r < TACO_RULES_MAX; ++r) {
+    const taco_score *want = &g->scores[r];
+    ck_assert_int_eq(all[r].base, want->base);
+    ck_assert_int_eq(all[r].bonus, want->bonus);
+    ck_assert_int_eq(all[r].ceiling, want->ceiling);
+    ck_assert_int_eq(all[r].combo, want->combo);
+
+    taco_ceilings ceilings;
+    ck_assert_int_eq(taco_course_ceilings(c, TACO_SIDE_LEFT, r, &ceilings),
+                     0);
+    ck_assert_int_eq(ceilings.min, g->ceilings[r].min);
+    ck_assert_int_eq(ceilings.max, g->ceilings[r].max);
+    ck_assert_double_eq(ceilings.paths, g->ceilings[r].paths);
+  }
+
+  taco_courseset_free(set);
+}
+END_TEST
+
+TCase *case_score(void) {
+  TCase *c = tcase_create("score");
+  tcase_add_checked_fixture(c, setup, teardown);
+  tcase_add_test(c, test_score);
+  tcase_add_loop_test(c, test_golden, 0, sizeof(goldens) / sizeof(golden));
+  return c;
+}
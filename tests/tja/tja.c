@@ -3,9 +3,23 @@
 
 const char suite_name[] = "libtaco_tja";
 
+extern TCase *case_alloc();
+extern TCase *case_archive();
+extern TCase *case_fingerprint();
+extern TCase *case_judge();
 extern TCase *case_parser();
+extern TCase *case_path();
+extern TCase *case_replay();
+extern TCase *case_score();
 
 TCase *(*const cases[])(void) = {
+    case_alloc,
+    case_archive,
+    case_fingerprint,
+    case_judge,
     case_parser,
+    case_path,
+    case_replay,
+    case_score,
     NULL,
 };
@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "batch.h"
+
+#include "platform.h"
+#include "thread.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <taco.h>
+
+void batch_init(batch *b, int rules) {
+  memset(b, 0, sizeof(batch));
+  b->rules = rules;
+}
+
+void batch_free(batch *b) {
+  for (size_t i = 0; i < b->count; ++i) {
+    free(b->paths[i]);
+    if (b->reports)
+      score_report_free(&b->reports[i]);
+  }
+  free(b->paths);
+  free(b->reports);
+}
+
+static int add_path(const char *path, void *data) {
+  batch *b = data;
+  if (b->count == b->capacity) {
+    size_t capacity = b->capacity ? b->capacity * 2 : 64;
+    char **paths = realloc(b->paths, capacity * sizeof(char *));
+    if (!paths)
+      return -1;
+    b->paths = paths;
+    b->capacity = capacity;
+  }
+
+  char *copy = malloc(strlen(path) + 1);
+  if (!copy)
+    return -1;
+  strcpy(copy, path);
+  b->paths[b->count++] = copy;
+  return 0;
+}
+
+int batch_add(batch *b, const char *operand) {
+  if (strcmp(operand, "-") == 0)
+    return add_path(operand, b);
+  if (is_directory(operand))
+    return walk_directory(operand, add_path, b);
+
+  // expand wildcards the shell left alone, as on Windows
+  FILE *f = fopen(operand, "r");
+  if (!f && operand[strcspn(operand, "*?[")])
+    return expand_glob(operand, add_path, b);
+  if (f)
+    fclose(f);
+  return add_path(operand, b);
+}
+
+int batch_add_list(batch *b, const char *list) {
+  FILE *f = strcmp(list, "-") == 0 ? stdin : fopen(list, "r");
+  if (!f)
+    return -1;
+
+  char line[4096];
+  int result = 0;
+  while (result == 0 && fgets(line, sizeof(line), f)) {
+    line[strcspn(line, "\r\n")] = '\0';
+    if (*line)
+      result = batch_add(b, line);
+  }
+
+  if (f != stdin)
+    fclose(f);
+  return result;
+}
+
+static void score_one(batch *b, taco_parser *parser, size_t i) {
+  const char *path = b->paths[i];
+  taco_courseset *set = strcmp(path, "-") == 0
+                            ? taco_parser_parse_stdio(parser, stdin)
+                            : taco_parser_parse_file(parser, path);
+  if (!set) {
+    memset(&b->reports[i], 0, sizeof(score_report));
+    return;
+  }
+
+  score_set(set, b->rules, &b->reports[i]);
+  taco_courseset_free(set);
+}
+
+static void *heap_malloc(size_t size, void *restrict heap) {
+  return malloc(size);
+}
+
+static void heap_free(void *ptr, void *restrict heap) { free(ptr); }
+
+static void *heap_realloc(void *ptr, size_t size, void *restrict heap) {
+  return realloc(ptr, size);
+}
+
+// for the threads of the library's worker pool
+static taco_allocator allocator = {heap_malloc, heap_free, heap_realloc,
+                                   NULL};
+
+// each worker owns a parser and claims files until none are left
+static void work(void *data) {
+  batch *b = data;
+  taco_parser *parser = taco_parser_tja_create();
+
+  size_t i;
+  while ((i = taco_claim_job_(&b->next)) < b->count) {
+    if (parser)
+      score_one(b, parser, i);
+    else
+      memset(&b->reports[i], 0, sizeof(score_report));
+  }
+
+  taco_parser_free(parser);
+}
+
+size_t batch_run(batch *b, int jobs) {
+  b->reports = calloc(b->count ? b->count : 1, sizeof(score_report));
+  if (!b->reports)
+    return b->count;
+
+  atomic_store(&b->next, 0);
+  if (jobs <= 0)
+    jobs = taco_cpu_count_();
+  if ((size_t)jobs > b->count)
+    jobs = (int)b->count;
+  if (jobs <= 1 || taco_run_workers_(&allocator, jobs, work, b) != 0)
+    work(b);
+
+  size_t failed = 0;
+  for (size_t i = 0; i < b->count; ++i)
+    failed += !b->reports[i].ok;
+  return failed;
+}
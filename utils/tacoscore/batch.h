@@ -0,0 +1,32 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "calc.h"
+#include <stdatomic.h>
+#include <stddef.h>
+
+typedef struct batch_ batch;
+
+// A list of files scored on a pool of workers.
+struct batch_ {
+  char **paths;
+  size_t count;
+  size_t capacity;
+
+  int rules;
+  score_report *reports;
+  atomic_size_t next;
+};
+
+extern void batch_init(batch *b, int rules);
+extern void batch_free(batch *b);
+// Adds a file, directory, wildcard pattern or - for standard input.
+extern int batch_add(batch *b, const char *operand);
+// Adds the paths listed in a file, one per line.
+extern int batch_add_list(batch *b, const char *list);
+// Scores all files, on one thread per processor if jobs is 0. Returns the
+// number of files failing to parse.
+extern size_t batch_run(batch *b, int jobs);
+
+#endif /* !BATCH_H */
@@ -1,65 +1,62 @@
 // SPDX-License-Identifier: BSD-2-Clause
 #include "calc.h"
 
-#include <math.h>
+#include <stdlib.h>
+#include <string.h>
 #include <taco.h>
 
-int score_set(taco_parser *parser, FILE *f, const char *filename,
-              score_branch_fn score) {
-  taco_courseset *set = taco_parser_parse_stdio(parser, f);
-  if (!set) {
-    printf("## %s ##\n", filename);
-    printf("Failed to read courseset.\n");
-    return -1;
-  }
+int score_set(const taco_courseset *set, int rules, score_report *report) {
+  memset(report, 0, sizeof(score_report));
 
   const char *title = taco_courseset_title(set);
   if (title) {
-    printf("## %s (%s) ##\n", title, filename);
-  } else {
-    printf("## %s ##\n", filename);
+    report->title = malloc(strlen(title) + 1);
+    if (report->title)
+      strcpy(report->title, title);
   }
 
   for (int i = 0; i < 8; ++i) {
     const taco_course *course = taco_courseset_get_course(set, i);
     if (!course)
       continue;
-    score_course(course, i, score);
+    score_course(course, i, rules, report);
   }
 
-  taco_courseset_free(set);
+  report->ok = 1;
   return 0;
 }
 
-int score_course(const taco_course *c, int cls, score_branch_fn score) {
-  static const char *const class_names[8] = {
-      "Easy",       "Normal",       "Hard",       "Oni",
-      "Inner Easy", "Inner Normal", "Inner Hard", "Inner Oni",
-  };
-
-  int base, bonus, ceil, combo;
-
-  if (taco_course_style(c) == TACO_STYLE_SINGLE) {
-    const taco_section *b = taco_course_get_branch(c, 0, TACO_BRANCH_MASTER);
-    score(b, c, &base, &bonus, &ceil, &combo);
-    printf("%s: base %d, bonus %d, ceiling %d, max combo %d\n",
-           class_names[cls], base, bonus, ceil, combo);
-  } else {
-    const taco_section *l =
-        taco_course_get_branch(c, TACO_SIDE_LEFT, TACO_BRANCH_MASTER);
-    const taco_section *r =
-        taco_course_get_branch(c, TACO_SIDE_RIGHT, TACO_BRANCH_MASTER);
-    score(l, c, &base, &bonus, &ceil, &combo);
-    printf("%s (%s): base %d, bonus %d, ceiling %d, max combo %d\n",
-           class_names[cls], "P1", base, bonus, ceil, combo);
-    score(r, c, &base, &bonus, &ceil, &combo);
-    printf("%s (%s): base %d, bonus %d, ceiling %d, max combo %d\n",
-           class_names[cls], "P2", base, bonus, ceil, combo);
+int score_course(const taco_course *c, int cls, int rules,
+                 score_report *report) {
+  int sides = taco_course_style(c) == TACO_STYLE_SINGLE ? 1 : 2;
+
+  for (int side = 0; side < sides; ++side) {
+    score_entry *e = &report->entries[report->count++];
+    const taco_section *b = taco_course_get_branch(c, side, TACO_BRANCH_MASTER);
+    e->diffclass = cls;
+    e->side = sides == 1 ? -1 : side;
+    taco_score score;
+    taco_section_score(b, c, rules, &score);
+    e->base = score.base;
+    e->bonus = score.bonus;
+    e->ceil = score.ceiling;
+    e->combo = score.combo;
+
+    taco_ceilings ceilings;
+    if (taco_course_ceilings(c, side, rules, &ceilings) == 0) {
+      e->ceil_min = ceilings.min;
+      e->ceil_max = ceilings.max;
+      e->paths = ceilings.paths;
+    } else {
+      e->ceil_min = e->ceil_max = e->ceil;
+      e->paths = 1;
+    }
   }
 
   return 0;
 }
 
-int roll_hits(double duration, double roll_rate) {
-  return ceil(duration * roll_rate);
+void score_report_free(score_report *report) {
+  free(report->title);
+  report->title = NULL;
 }
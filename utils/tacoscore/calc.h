@@ -4,31 +4,35 @@
 
 #include <taco.h>
 
-typedef int (*score_branch_fn)(const taco_section *branch,
-                               const taco_course *meta, int *base, int *bonus,
-                               int *ceil, int *combo);
+typedef struct score_entry_ score_entry;
+typedef struct score_report_ score_report;
 
-extern int score_set(taco_parser *parser, FILE *f, const char *filename,
-                     score_branch_fn score);
-extern int score_course(const taco_course *course, int diffclass,
-                        score_branch_fn score);
+// Scoring parameters of one side of a course.
+struct score_entry_ {
+  int diffclass;
+  int side;
+  int base;
+  int bonus;
+  int ceil;
+  int combo;
+  // ceilings among every branch path; the one above is the master path's
+  int ceil_min;
+  int ceil_max;
+  double paths;
+};
 
-extern int score_branch_ac15(const taco_section *branch,
-                             const taco_course *meta, int *base, int *bonus,
-                             int *ceil, int *combo);
-extern int score_branch_ac15s(const taco_section *branch,
-                              const taco_course *meta, int *base, int *bonus,
-                              int *ceil, int *combo);
-extern int score_branch_ac16(const taco_section *branch,
-                             const taco_course *meta, int *base, int *bonus,
-                             int *ceil, int *combo);
-extern int score_branch_default(const taco_section *branch,
-                                const taco_course *meta, int *base, int *bonus,
-                                int *ceiling, int *combo);
-extern int score_branch_shinuchi(const taco_section *branch,
-                                 const taco_course *meta, int *base, int *bonus,
-                                 int *ceiling, int *combo);
+// Scoring parameters of a courseset.
+struct score_report_ {
+  int ok;
+  char *title;
+  int count;
+  score_entry entries[16];
+};
 
-extern int roll_hits(double duration, double roll_rate);
+extern int score_set(const taco_courseset *set, int rules,
+                     score_report *report);
+extern int score_course(const taco_course *course, int diffclass, int rules,
+                        score_report *report);
+extern void score_report_free(score_report *report);
 
 #endif /* !CALC_H */
@@ -5,24 +5,30 @@
 #include <stdlib.h>
 #include <string.h>
 #include <taco.h>
+#include <time.h>
 
+#include "batch.h"
 #include "calc.h"
+#include "output.h"
 
 static const struct option options[] = {
     {"help", no_argument, NULL, 'h'},
     {"version", no_argument, NULL, 'v'},
     {"rules", required_argument, NULL, 'r'},
+    {"format", required_argument, NULL, 'f'},
+    {"jobs", required_argument, NULL, 'j'},
+    {"files-from", required_argument, NULL, 'l'},
     {NULL, 0, NULL, 0},
 };
 
 static const struct scoring_rule {
   const char *name;
-  score_branch_fn score_fn;
+  int rules;
 } scoring_rules[] = {
-    {"ac15", score_branch_ac15},       {"ac15s", score_branch_ac15s},
-    {"ac16", score_branch_ac16},       {"arcade", score_branch_ac16},
-    {"console", score_branch_ac15},    {"course", score_branch_default},
-    {"default", score_branch_default}, {"shinuchi", score_branch_shinuchi},
+    {"ac15", TACO_RULES_AC15},       {"ac15s", TACO_RULES_AC15S},
+    {"ac16", TACO_RULES_AC16},       {"arcade", TACO_RULES_AC16},
+    {"console", TACO_RULES_AC15},    {"course", TACO_RULES_DEFAULT},
+    {"default", TACO_RULES_DEFAULT}, {"shinuchi", TACO_RULES_SHINUCHI},
 };
 
 int cmp_scoring_rules(const void *k, const void *e) {
@@ -30,17 +36,21 @@ int cmp_scoring_rules(const void *k, const void *e) {
   return strcmp(k, entry->name);
 }
 
+static const char *const format_names[] = {"text", "csv", "json"};
+
 static void help(const char *arg0);
 static void version();
+static double now(void);
 
 int main(int argc, char **argv) {
   int opt;
   int options_valid = 1;
-  FILE *input = stdin;
-  const char *filename = "<stdin>";
-  score_branch_fn score_fn = score_branch_ac16;
+  int format = FORMAT_TEXT;
+  int jobs = 0;
+  const char *list = NULL;
+  int rules = TACO_RULES_AC16;
 
-  while ((opt = getopt_long(argc, argv, "hvr:", options, NULL)) != -1) {
+  while ((opt = getopt_long(argc, argv, "hvr:f:j:l:", options, NULL)) != -1) {
     switch (opt) {
     case 'h':
       help(argv[0]);
@@ -54,13 +64,34 @@ int main(int argc, char **argv) {
                   sizeof(scoring_rules) / sizeof(struct scoring_rule),
                   sizeof(struct scoring_rule), cmp_scoring_rules);
       if (entry) {
-        score_fn = entry->score_fn;
+        rules = entry->rules;
       } else {
         fprintf(stderr, "%s: unrecognized scoring rule: %s\n", argv[0], optarg);
         options_valid = 0;
       }
       break;
     }
+    case 'f':
+      format = -1;
+      for (int i = 0; i < 3; ++i) {
+        if (strcmp(optarg, format_names[i]) == 0)
+          format = i;
+      }
+      if (format < 0) {
+        fprintf(stderr, "%s: unrecognized format: %s\n", argv[0], optarg);
+        options_valid = 0;
+      }
+      break;
+    case 'j':
+      jobs = atoi(optarg);
+      if (jobs <= 0) {
+        fprintf(stderr, "%s: invalid job count: %s\n", argv[0], optarg);
+        options_valid = 0;
+      }
+      break;
+    case 'l':
+      list = optarg;
+      break;
     case '?':
     default:
       options_valid = 0;
@@ -71,28 +102,65 @@ int main(int argc, char **argv) {
   if (!options_valid)
     exit(1);
 
-  if (argc > optind && strcmp(argv[optind], "-") != 0) {
-    input = fopen(argv[optind], "r");
-    filename = argv[optind];
+  batch b;
+  batch_init(&b, rules);
+
+  if (list && batch_add_list(&b, list) != 0) {
+    fprintf(stderr, "%s: cannot read file list %s\n", argv[0], list);
+    exit(1);
+  }
+  for (int i = optind; i < argc; ++i) {
+    if (batch_add(&b, argv[i]) != 0) {
+      fprintf(stderr, "%s: cannot read %s\n", argv[0], argv[i]);
+      exit(1);
+    }
   }
+  if (!list && optind == argc)
+    batch_add(&b, "-");
 
-  taco_parser *parser = taco_parser_tja_create();
-  int result = score_set(parser, input, filename, score_fn);
-  taco_parser_free(parser);
+  double start = now();
+  size_t failed = batch_run(&b, jobs);
+  double elapsed = now() - start;
+
+  print_header(stdout, format);
+  size_t courses = 0;
+  for (size_t i = 0; i < b.count; ++i) {
+    const char *name = strcmp(b.paths[i], "-") ? b.paths[i] : "<stdin>";
+    print_report(stdout, format, name, &b.reports[i]);
+    courses += b.reports[i].count;
+  }
+
+  if (b.count > 1) {
+    fprintf(stderr,
+            "%zu files (%zu failed), %zu courses in %.3f s; %.1f files/s\n",
+            b.count, failed, courses, elapsed,
+            elapsed > 0 ? b.count / elapsed : 0.0);
+  }
+
+  batch_free(&b);
+  exit(failed ? 1 : 0);
+}
 
-  exit(result);
+static double now(void) {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
 }
 
 static void help(const char *arg0) {
-  printf("Usage: %s [options] [FILE]\n"
-         "Calculate scoring parameters of a TJA file.\n"
+  printf("Usage: %s [options] [FILE]...\n"
+         "Calculate scoring parameters of TJA files.\n"
          "\n"
-         "With no FILE, or when FILE is -, read standard input.\n"
+         "With no FILE, or when FILE is -, read standard input. Directories\n"
+         "are searched recursively for .tja files.\n"
          "\n"
          "Options:\n"
-         "  -r, --rules=RULES  use specified scoring rules\n"
-         "  -h, --help         print this help\n"
-         "  -v, --version      print version info\n"
+         "  -r, --rules=RULES       use specified scoring rules\n"
+         "  -f, --format=FORMAT     output as text, csv or json (lines)\n"
+         "  -j, --jobs=N            score N files at once\n"
+         "  -l, --files-from=FILE   also score files listed in FILE\n"
+         "  -h, --help              print this help\n"
+         "  -v, --version           print version info\n"
          "\n"
          "Available rules:\n"
          "  - ac15 (console)\n"
@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#include "output.h"
+
+#include <string.h>
+
+static const char *const class_names[8] = {
+    "Easy",       "Normal",       "Hard",       "Oni",
+    "Inner Easy", "Inner Normal", "Inner Hard", "Inner Oni",
+};
+
+static const char *const side_names[2] = {"P1", "P2"};
+
+static void print_csv_string(FILE *out, const char *str) {
+  if (!str || !str[strcspn(str, ",\"\r\n")]) {
+    fputs(str ? str : "", out);
+    return;
+  }
+
+  fputc('"', out);
+  for (const char *c = str; *c; ++c) {
+    if (*c == '"')
+      fputc('"', out);
+    fputc(*c, out);
+  }
+  fputc('"', out);
+}
+
+static void print_json_string(FILE *out, const char *str) {
+  if (!str) {
+    fputs("null", out);
+    return;
+  }
+
+  fputc('"', out);
+  for (const unsigned char *c = (const unsigned char *)str; *c; ++c) {
+    if (*c == '"' || *c == '\\')
+      fprintf(out, "\\%c", *c);
+    else if (*c < 0x20)
+      fprintf(out, "\\u%04x", *c);
+    else
+      fputc(*c, out);
+  }
+  fputc('"', out);
+}
+
+void print_header(FILE *out, int format) {
+  if (format == FORMAT_CSV)
+    fputs("file,title,class,side,base,bonus,ceiling,combo,min_ceiling,"
+          "max_ceiling,paths\n",
+          out);
+}
+
+static void print_text(FILE *out, const char *filename,
+                       const score_report *r) {
+  if (r->title) {
+    fprintf(out, "## %s (%s) ##\n", r->title, filename);
+  } else {
+    fprintf(out, "## %s ##\n", filename);
+  }
+
+  if (!r->ok) {
+    fprintf(out, "Failed to read courseset.\n");
+    return;
+  }
+
+  for (int i = 0; i < r->count; ++i) {
+    const score_entry *e = &r->entries[i];
+    fputs(class_names[e->diffclass], out);
+    if (e->side >= 0)
+      fprintf(out, " (%s)", side_names[e->side]);
+    fprintf(out, ": base %d, bonus %d, ceiling %d, max combo %d", e->base,
+            e->bonus, e->ceil, e->combo);
+    if (e->paths > 1)
+      fprintf(out, " (%.0f paths, ceilings %d to %d)", e->paths, e->ceil_min,
+              e->ceil_max);
+    fputc('\n', out);
+  }
+}
+
+// one row per scored course and side; files failing to parse get a row
+// with empty fields
+static void print_csv(FILE *out, const char *filename, const score_report *r) {
+  if (!r->ok) {
+    print_csv_string(out, filename);
+    fputs(",,,,,,,,,,\n", out);
+    return;
+  }
+
+  for (int i = 0; i < r->count; ++i) {
+    const score_entry *e = &r->entries[i];
+    print_csv_string(out, filename);
+    fputc(',', out);
+    print_csv_string(out, r->title);
+    fprintf(out, ",%s,%s,%d,%d,%d,%d,%d,%d,%.0f\n", class_names[e->diffclass],
+            e->side >= 0 ? side_names[e->side] : "", e->base, e->bonus,
+            e->ceil, e->combo, e->ceil_min, e->ceil_max, e->paths);
+  }
+}
+
+// one object per scored course and side, or an error object per file
+static void print_json(FILE *out, const char *filename,
+                       const score_report *r) {
+  if (!r->ok) {
+    fputs("{\"file\":", out);
+    print_json_string(out, filename);
+    fputs(",\"error\":\"failed to read courseset\"}\n", out);
+    return;
+  }
+
+  for (int i = 0; i < r->count; ++i) {
+    const score_entry *e = &r->entries[i];
+    fputs("{\"file\":", out);
+    print_json_string(out, filename);
+    fputs(",\"title\":", out);
+    print_json_string(out, r->title);
+    fprintf(out, ",\"class\":\"%s\"", class_names[e->diffclass]);
+    if (e->side >= 0)
+      fprintf(out, ",\"side\":\"%s\"", side_names[e->side]);
+    fprintf(out, ",\"base\":%d,\"bonus\":%d,\"ceiling\":%d,\"combo\":%d",
+            e->base, e->bonus, e->ceil, e->combo);
+    fprintf(out, ",\"min_ceiling\":%d,\"max_ceiling\":%d,\"paths\":%.0f}\n",
+            e->ceil_min, e->ceil_max, e->paths);
+  }
+}
+
+void print_report(FILE *out, int format, const char *filename,
+                  const score_report *report) {
+  switch (format) {
+  case FORMAT_CSV:
+    print_csv(out, filename, report);
+    break;
+  case FORMAT_JSON:
+    print_json(out, filename, report);
+    break;
+  default:
+    print_text(out, filename, report);
+    break;
+  }
+}
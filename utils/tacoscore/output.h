@@ -0,0 +1,16 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include "calc.h"
+#include <stdio.h>
+
+#define FORMAT_TEXT 0
+#define FORMAT_CSV 1
+#define FORMAT_JSON 2
+
+extern void print_header(FILE *out, int format);
+extern void print_report(FILE *out, int format, const char *filename,
+                         const score_report *report);
+
+#endif /* !OUTPUT_H */
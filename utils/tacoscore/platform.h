@@ -0,0 +1,19 @@
+/* SPDX-License-Identifier: BSD-2-Clause */
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stddef.h>
+
+// Called for each file found. Stops the walk if nonzero.
+typedef int walk_fn(const char *path, void *data);
+
+// Gets whether a path is a directory.
+extern int is_directory(const char *path);
+// Calls fn on every .tja file in a directory and its subdirectories, in
+// a stable order. Links to directories are not followed. Returns -1 if a
+// directory could not be listed in full.
+extern int walk_directory(const char *path, walk_fn *fn, void *data);
+// Calls fn on every path matching a wildcard pattern, in sorted order.
+extern int expand_glob(const char *pattern, walk_fn *fn, void *data);
+
+#endif /* !PLATFORM_H */
@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#define _XOPEN_SOURCE 700
+
+#include "platform.h"
+
+#include <dirent.h>
+#include <glob.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/stat.h>
+
+int is_directory(const char *path) {
+  struct stat st;
+  return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+// Gets whether a path is a directory and not a link to one, which could
+// lead back to a directory being walked.
+static int is_walkable(const char *path) {
+  struct stat st;
+  return lstat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static void free_names(char **names, size_t count) {
+  for (size_t i = 0; i < count; ++i)
+    free(names[i]);
+  free(names);
+}
+
+static int compare_names(const void *a, const void *b) {
+  return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static int is_tja(const char *name) {
+  size_t len = strlen(name);
+  return len > 4 && strcasecmp(name + len - 4, ".tja") == 0;
+}
+
+int walk_directory(const char *path, walk_fn *fn, void *data) {
+  DIR *dir = opendir(path);
+  if (!dir)
+    return -1;
+
+  // readdir order is arbitrary; sort for stable output
+  char **names = NULL;
+  size_t count = 0, capacity = 0;
+  struct dirent *entry;
+  while ((entry = readdir(dir))) {
+    if (entry->d_name[0] == '.')
+      continue;
+
+    if (count == capacity) {
+      capacity = capacity ? capacity * 2 : 16;
+      char **n = realloc(names, capacity * sizeof(char *));
+      if (!n)
+        goto fail;
+      names = n;
+    }
+
+    size_t size = strlen(path) + strlen(entry->d_name) + 2;
+    names[count] = malloc(size);
+    if (!names[count])
+      goto fail;
+    snprintf(names[count++], size, "%s/%s", path, entry->d_name);
+  }
+  closedir(dir);
+
+  qsort(names, count, sizeof(char *), compare_names);
+
+  int result = 0;
+  for (size_t i = 0; i < count; ++i) {
+    if (result == 0) {
+      if (is_walkable(names[i]))
+        result = walk_directory(names[i], fn, data);
+      else if (is_tja(names[i]))
+        result = fn(names[i], data);
+    }
+  }
+  free_names(names, count);
+  return result;
+
+fail:
+  // a partial listing would silently skip files
+  closedir(dir);
+  free_names(names, count);
+  return -1;
+}
+
+int expand_glob(const char *pattern, walk_fn *fn, void *data) {
+  glob_t g;
+  int err = glob(pattern, 0, NULL, &g);
+  if (err == GLOB_NOMATCH)
+    return 0;
+  if (err != 0)
+    return -1;
+
+  int result = 0;
+  for (size_t i = 0; i < g.gl_pathc && result == 0; ++i) {
+    if (is_directory(g.gl_pathv[i]))
+      result = walk_directory(g.gl_pathv[i], fn, data);
+    else
+      result = fn(g.gl_pathv[i], data);
+  }
+  globfree(&g);
+  return result;
+}
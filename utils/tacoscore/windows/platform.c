@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: BSD-2-Clause
+#define WIN32_LEAN_AND_MEAN
+
+#include "platform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+
+int is_directory(const char *path) {
+  DWORD attrs = GetFileAttributesA(path);
+  return attrs != INVALID_FILE_ATTRIBUTES &&
+         (attrs & FILE_ATTRIBUTE_DIRECTORY);
+}
+
+static int compare_names(const void *a, const void *b) {
+  return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static int is_tja(const char *name) {
+  size_t len = strlen(name);
+  return len > 4 && _stricmp(name + len - 4, ".tja") == 0;
+}
+
+// Gets whether a path is a directory and not a junction or link to one,
+// which could lead back to a directory being walked.
+static int is_walkable(const char *path) {
+  DWORD attrs = GetFileAttributesA(path);
+  return attrs != INVALID_FILE_ATTRIBUTES &&
+         (attrs & FILE_ATTRIBUTE_DIRECTORY) &&
+         !(attrs & FILE_ATTRIBUTE_REPARSE_POINT);
+}
+
+static void free_names(char **names, size_t count) {
+  for (size_t i = 0; i < count; ++i)
+    free(names[i]);
+  free(names);
+}
+
+// Lists entries matching a pattern, prefixed with dir, sorted by name.
+// Returns -1 if the listing could not be completed.
+static int list(const char *dir, const char *pattern, char ***out,
+                size_t *count) {
+  WIN32_FIND_DATAA found;
+  HANDLE h = FindFirstFileA(pattern, &found);
+  *out = NULL;
+  *count = 0;
+  if (h == INVALID_HANDLE_VALUE)
+    return 0;
+
+  char **names = NULL;
+  size_t capacity = 0;
+  do {
+    if (found.cFileName[0] == '.')
+      continue;
+
+    if (*count == capacity) {
+      capacity = capacity ? capacity * 2 : 16;
+      char **n = realloc(names, capacity * sizeof(char *));
+      if (!n)
+        goto fail;
+      names = n;
+    }
+
+    size_t size = strlen(dir) + strlen(found.cFileName) + 2;
+    names[*count] = malloc(size);
+    if (!names[*count])
+      goto fail;
+    if (*dir)
+      snprintf(names[(*count)++], size, "%s\\%s", dir, found.cFileName);
+    else
+      snprintf(names[(*count)++], size, "%s", found.cFileName);
+  } while (FindNextFileA(h, &found));
+  FindClose(h);
+
+  qsort(names, *count, sizeof(char *), compare_names);
+  *out = names;
+  return 0;
+
+fail:
+  // a partial listing would silently skip files
+  FindClose(h);
+  free_names(names, *count);
+  *count = 0;
+  return -1;
+}
+
+static int visit(char **names, size_t count, int tja_only, walk_fn *fn,
+                 void *data) {
+  int result = 0;
+  for (size_t i = 0; i < count && result == 0; ++i) {
+    // links are followed only where named by the user
+    int dir = tja_only ? is_walkable(names[i]) : is_directory(names[i]);
+    if (dir)
+      result = walk_directory(names[i], fn, data);
+    else if (!tja_only || is_tja(names[i]))
+      result = fn(names[i], data);
+  }
+  free_names(names, count);
+  return result;
+}
+
+int walk_directory(const char *path, walk_fn *fn, void *data) {
+  size_t size = strlen(path) + 3;
+  char *pattern = malloc(size);
+  if (!pattern)
+    return -1;
+  snprintf(pattern, size, "%s\\*", path);
+
+  char **names;
+  size_t count;
+  int result = list(path, pattern, &names, &count);
+  free(pattern);
+  return result == 0 ? visit(names, count, 1, fn, data) : -1;
+}
+
+int expand_glob(const char *pattern, walk_fn *fn, void *data) {
+  // wildcards are only supported in the last component
+  const char *sep = strrchr(pattern, '\\');
+  const char *slash = strrchr(pattern, '/');
+  if (!sep || (slash && slash > sep))
+    sep = slash;
+
+  size_t len = sep ? (size_t)(sep - pattern) : 0;
+  char *dir = malloc(len + 1);
+  if (!dir)
+    return -1;
+  memcpy(dir, pattern, len);
+  dir[len] = '\0';
+
+  char **names;
+  size_t count;
+  int result = list(dir, pattern, &names, &count);
+  free(dir);
+  return result == 0 ? visit(names, count, 0, fn, data) : -1;
+}